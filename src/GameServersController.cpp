@@ -8,62 +8,341 @@
 
 #include "GameServersController.hpp"
 
+#include "toolkit/cpu_pinning.hpp"
+
+#include <Poco/Exception.h>
 #include <Poco/Observer.h>
 
+#include <algorithm>
+
+
+namespace
+{
+        // a server which does not tick yet will soon, a fresh match costs about that much of a core
+    const uint32_t PENDING_COST = 50;
+}
+
+
+GameServersController::Configuration GameServersController::_config = { 2, 1931 };
 
-GameServersController::GameServersController()
+
+GameServersController::GameServersController(MatchSink matchSink)
 : _logger("GameServersController", NamedLogger::Mode::STDIO),
+  _matchSink(std::move(matchSink)),
   _workers("GameServerWorker"),
-  _taskManager(_workers)
+  _taskManager(_workers),
+  _lobbies(_workers.available()),
+  _warming(true),
+  _warmer("GameServerWarmer")
 {
-    _logger.Debug() << "GameServerController is up, number of workers: " << _workers.available();
-
-    for(auto idx = 1931; idx < 1931 + _workers.available(); ++idx)
-        _availablePorts.push_back(idx);
+    LOG_DEBUG(_logger) << "GameServerController is up, number of workers: " << _workers.available()
+                       << ", ports from " << _config.BasePort << ", warm servers: " << _config.WarmServers;
 
     using namespace Poco;
     _taskManager.addObserver(Observer<GameServersController, TaskStartedNotification>(*this,
                                                                                       &GameServersController::onStarted));
+    _taskManager.addObserver(Observer<GameServersController, TaskCustomNotification<GameServer::LobbyEvent>>(*this,
+                                                                                                           &GameServersController::onLobbyEvent));
+    _taskManager.addObserver(Observer<GameServersController, TaskCustomNotification<DBQuery::MatchRecord>>(*this,
+                                                                                                         &GameServersController::onMatchFinished));
     _taskManager.addObserver(Observer<GameServersController, TaskFinishedNotification>(*this,
                                                                                        &GameServersController::onFinished));
+
+    _warmer.start(*this);
 }
 
 GameServersController::~GameServersController()
 {
-    _logger.Info() << "Waiting for all workers to end";
+    {
+        std::lock_guard<std::mutex> l(_warmMutex);
+        _warming = false;
+
+            // standby servers would wait forever, games in progress are left to end
+        for(auto& server : _warm)
+            server->cancel();
+    }
+    _warmWakeup.notify_all();
+    _warmer.join();
+
+        // servers still running must not notify a destroyed controller
+    using namespace Poco;
+    _taskManager.removeObserver(Observer<GameServersController, TaskStartedNotification>(*this,
+                                                                                         &GameServersController::onStarted));
+    _taskManager.removeObserver(Observer<GameServersController, TaskCustomNotification<GameServer::LobbyEvent>>(*this,
+                                                                                                              &GameServersController::onLobbyEvent));
+    _taskManager.removeObserver(Observer<GameServersController, TaskCustomNotification<DBQuery::MatchRecord>>(*this,
+                                                                                                            &GameServersController::onMatchFinished));
+    _taskManager.removeObserver(Observer<GameServersController, TaskFinishedNotification>(*this,
+                                                                                          &GameServersController::onFinished));
+
+    LOG_INFO(_logger) << "Waiting for all workers to end";
     _workers.collect();
-    _logger.Info() << "Shutdown";
+    LOG_INFO(_logger) << "Shutdown";
 }
 
-    // TODO: should return future<uint16_t>, and callee wait in queue for available server.
+
+std::experimental::optional<uint16_t>
+GameServersController::TakeFreedSeat()
+{
+    if(auto slot = _lobbies.TakeSeat())
+        return static_cast<uint16_t>(_config.BasePort + *slot);
+
+    std::lock_guard<std::mutex> lock(_publishMutex);
+    while(_lobbies.Publish())
+    {
+        if(auto slot = _lobbies.TakeSeat())
+            return static_cast<uint16_t>(_config.BasePort + *slot);
+    }
+
+    return {};
+}
+
+
 std::experimental::optional<uint16_t>
-GameServersController::GetServerAddress()
+GameServersController::StartLobby(uint16_t players)
 {
-    std::experimental::optional<uint16_t> result;
-    auto list = _taskManager.taskList();
-    for(auto task : list)
+    auto loads = CoreLoads();
+
+    Poco::AutoPtr<GameServer> server;
     {
-	GameServer * server = dynamic_cast<GameServer*>(task.get());
-	if (server->GetState() == GameServer::State::LOBBY_FORMING)
-	    return server->GetConfig().Port;
+            // oldest of the ones on the least loaded core
+        std::lock_guard<std::mutex> l(_warmMutex);
+        auto best = std::min_element(_warm.begin(),
+                                     _warm.end(),
+                                     [&](const Poco::AutoPtr<GameServer>& a, const Poco::AutoPtr<GameServer>& b)
+                                     {
+                                         return CoreLoad(loads, SlotOf(a.get())) < CoreLoad(loads, SlotOf(b.get()));
+                                     });
+        if(best != _warm.end())
+        {
+            server = *best;
+            _warm.erase(best);
+        }
     }
+    _warmWakeup.notify_one();
 
-        // If no servers available - start new one and return its address
-    if(!result && _workers.available())
+    if(!server)
     {
-        GameServer::Configuration config;
-        config.Players = 1;
-        config.RandomSeed = 0;
+        _logger.Warning() << "No warm servers left, starting one on demand";
+
+        auto slot = ReserveSlot();
+        if(slot)
+            server = StartServer(*slot);
+        if(!server)
+            return {};
+    }
+
+    server->Activate(players, 0);
+    return static_cast<uint16_t>(server->GetPort());
+}
+
+
+GameServersController::Stats
+GameServersController::GetStats()
+{
+    Stats stats {};
+    stats.Workers = _workers.capacity();
+    stats.WorkersUsed = _workers.used();
+
+    for(auto& task : _taskManager.taskList())
+    {
+        auto server = dynamic_cast<GameServer*>(task.get());
+        if(!server)
+            continue;
+
+        auto serverStats = server->GetStats();
+        switch(serverStats.ServerState)
+        {
+        case GameServer::State::STANDBY:
+            ++stats.Warm;
+            break;
+        case GameServer::State::LOBBY_FORMING:
+            ++stats.Lobbies;
+            break;
+        case GameServer::State::HERO_PICK:
+        case GameServer::State::GENERATING_WORLD:
+        case GameServer::State::RUNNING_GAME:
+            ++stats.Games;
+            break;
+        case GameServer::State::FINISHED:
+            break;
+        }
+
+        stats.Players += serverStats.Players;
+        stats.Utilization += serverStats.Utilization;
+        stats.Overruns = std::max(stats.Overruns, serverStats.Overruns);
+        stats.Servers.push_back(serverStats);
+    }
+
+    return stats;
+}
+
 
+void
+GameServersController::run()
+{
+    std::unique_lock<std::mutex> l(_warmMutex);
+    while(_warming)
+    {
+        if(_warm.size() >= _config.WarmServers)
         {
-            std::lock_guard<std::mutex> lock(_availablePortsMutex);
-            config.Port = _availablePorts.back();
-            _availablePorts.pop_back();
+            _warmWakeup.wait(l);
+            continue;
         }
-        _taskManager.start(new GameServer(config));
 
-        result = config.Port;
+        l.unlock();
+        auto slot = ReserveSlot();
+        Poco::AutoPtr<GameServer> server;
+        if(slot)
+            server = StartServer(*slot);
+        l.lock();
+
+        if(server)
+            _warm.push_back(server);
+        else
+            _warmWakeup.wait_for(l, std::chrono::seconds(1)); // every server is busy, retry once one finishes
+    }
+}
+
+
+Poco::AutoPtr<GameServer>
+GameServersController::StartServer(size_t slot)
+{
+    GameServer::Configuration config;
+    config.Players = 1;
+    config.RandomSeed = 0;
+    config.Port = static_cast<uint32_t>(_config.BasePort + slot);
+    config.Worker = static_cast<uint32_t>(slot);
+
+    Poco::AutoPtr<GameServer> server(new GameServer(config));
+    try
+    {
+            // TaskManager keeps its own reference
+        _taskManager.start(server.duplicate());
+    }
+    catch(const Poco::Exception& e)
+    {
+            // finished task still holds its worker thread for a moment
+        _logger.Warning() << "Failed to start server on port " << config.Port << ": " << e.displayText();
+        _lobbies.Release(slot);
+        return {};
+    }
+
+    return server;
+}
+
+
+std::vector<uint32_t>
+GameServersController::CoreLoads()
+{
+    auto& pinning = CpuPinning::Instance();
+
+    std::vector<uint32_t> loads(_lobbies.Capacity(), 0);
+    for(auto& task : _taskManager.taskList())
+    {
+        auto server = dynamic_cast<GameServer*>(task.get());
+        if(!server)
+            continue;
+
+        auto core = pinning.GameCore(SlotOf(server));
+        if(core >= loads.size())
+            loads.resize(core + 1, 0);
+
+        auto stats = server->GetStats();
+        switch(stats.ServerState)
+        {
+        case GameServer::State::STANDBY:
+        case GameServer::State::LOBBY_FORMING:
+        case GameServer::State::HERO_PICK:
+        case GameServer::State::GENERATING_WORLD:
+            loads[core] += PENDING_COST;
+            break;
+        case GameServer::State::RUNNING_GAME:
+            loads[core] += stats.Utilization;
+            break;
+        case GameServer::State::FINISHED:
+            break;
+        }
+    }
+
+    return loads;
+}
+
+
+uint32_t
+GameServersController::CoreLoad(const std::vector<uint32_t>& loads, size_t slot)
+{
+    auto core = CpuPinning::Instance().GameCore(slot);
+    return core < loads.size() ? loads[core] : 0;
+}
+
+
+std::experimental::optional<size_t>
+GameServersController::ReserveSlot()
+{
+    auto loads = CoreLoads();
+
+    std::vector<size_t> free;
+    for(size_t slot = 0; slot < _lobbies.Capacity(); ++slot)
+    {
+        if(_lobbies.GetState(slot) == LobbyRegistry::State::FREE)
+            free.push_back(slot);
+    }
+
+    std::stable_sort(free.begin(),
+                     free.end(),
+                     [&](size_t a, size_t b)
+                     {
+                         return CoreLoad(loads, a) < CoreLoad(loads, b);
+                     });
+
+        // a slot may be taken meanwhile, the next one is tried then
+    for(auto slot : free)
+    {
+        if(_lobbies.Reserve(slot))
+            return slot;
+    }
+
+    return {};
+}
+
+
+void
+GameServersController::Recycle(Poco::Task * task)
+{
+    {
+        std::lock_guard<std::mutex> l(_warmMutex);
+        if(_warming && _warm.size() < _config.WarmServers)
+        {
+            _lobbies.Reopen(SlotOf(task));
+            _warm.push_back(Poco::AutoPtr<GameServer>(dynamic_cast<GameServer*>(task), true));
+            return;
+        }
+    }
+
+        // pool is full, server ends and its slot is released in onFinished
+    LOG_DEBUG(_logger) << task->name() << " is not needed in the pool";
+    task->cancel();
+}
+
+
+void
+GameServersController::onFinished(Poco::TaskFinishedNotification* pNf)
+{
+    _lobbies.Release(SlotOf(pNf->task()));
+
+    {
+        std::lock_guard<std::mutex> l(_warmMutex);
+        _warm.erase(std::remove_if(_warm.begin(),
+                                   _warm.end(),
+                                   [pNf](const Poco::AutoPtr<GameServer>& server)
+                                   {
+                                       return server.get() == pNf->task();
+                                   }),
+                    _warm.end());
     }
+    _warmWakeup.notify_one();
 
-    return result;
+    LOG_DEBUG(_logger) << pNf->task()->name() << " finished.";
+    pNf->release();
 }
@@ -10,49 +10,143 @@
 #define GameServersController_hpp
 
 #include "gameserver/gameserver.hpp"
+#include "lobby_registry.hpp"
+#include "services/storage_backend.hpp"
 #include "toolkit/named_logger.hpp"
 #include "toolkit/optional.hpp"
 
+#include <Poco/AutoPtr.h>
+#include <Poco/Runnable.h>
 #include <Poco/TaskManager.h>
 #include <Poco/TaskNotification.h>
+#include <Poco/Thread.h>
 #include <Poco/ThreadPool.h>
 
+#include <condition_variable>
 #include <deque>
+#include <functional>
 #include <mutex>
+#include <vector>
 
 
-class GameServersController
+/*
+ * Owner of game server instances.
+ * A few servers are kept warm: constructed, bound and running in standby, so a formed match
+ * gets its server without waiting for thread start and socket setup. Servers return to standby
+ * after a match and are reused, background thread (run()) starts new ones only to make up the pool.
+ * Servers can share a core (see CpuPinning::GameCore), so matches and new servers go to the core
+ * with the least load.
+ */
+class GameServersController : public Poco::Runnable
 {
 public:
-    GameServersController();
+    struct Configuration
+    {
+        size_t      WarmServers;
+        uint16_t    BasePort;       // servers take ports BasePort, BasePort + 1...
+    };
+
+        // receives results of every played match, called from game server threads
+    using MatchSink = std::function<void(const DBQuery::MatchRecord&)>;
+
+    struct Stats
+    {
+        size_t                          Workers;
+        size_t                          WorkersUsed;
+        size_t                          Warm;       // standby servers
+        size_t                          Lobbies;    // waiting for players
+        size_t                          Games;      // hero pick, world generation or running
+        size_t                          Players;
+        uint32_t                        Utilization;    // sum of servers' one, permille of a core
+        uint16_t                        Overruns;       // of the worst server
+        std::vector<GameServer::Stats>  Servers;
+    };
+
+public:
+    /*
+     * Has to be called before the controller is created.
+     */
+    static void Configure(const Configuration& config)
+    { _config = config; }
+
+    GameServersController(MatchSink matchSink);
     ~GameServersController();
 
-    std::experimental::optional<uint16_t> GetServerAddress();
+    /*
+     * Seat left by a disconnected player in a forming lobby, empty if there is none.
+     * Lock-free while such lobby is published.
+     */
+    std::experimental::optional<uint16_t> TakeFreedSeat();
+
+    /*
+     * Hands out a server for a complete match, empty if every server is busy.
+     */
+    std::experimental::optional<uint16_t> StartLobby(uint16_t players);
+
+    Stats GetStats();
+
+    virtual void run() override;
 
 private:
+    size_t SlotOf(Poco::Task * task) const
+    { return dynamic_cast<GameServer*>(task)->GetPort() - _config.BasePort; }
+
+        // standby server on a reserved slot, empty on failure
+    Poco::AutoPtr<GameServer> StartServer(size_t slot);
+
+        // permille of a core used by servers on it, indexed by CpuPinning::GameCore
+    std::vector<uint32_t> CoreLoads();
+    static uint32_t CoreLoad(const std::vector<uint32_t>& loads, size_t slot);
+
+        // free slot on the least loaded core
+    std::experimental::optional<size_t> ReserveSlot();
+
     void onStarted(Poco::TaskStartedNotification* pNf)
     {
-        _logger.Debug() << pNf->task()->name() << " started.";
+        LOG_DEBUG(_logger) << pNf->task()->name() << " started.";
         pNf->release();
     }
 
-    void onFinished(Poco::TaskFinishedNotification* pNf)
+    void onLobbyEvent(Poco::TaskCustomNotification<GameServer::LobbyEvent>* pNf)
     {
-        std::lock_guard<std::mutex> l(_availablePortsMutex);
-        _availablePorts.push_back(dynamic_cast<GameServer*>(pNf->task())->GetConfig().Port);
+        auto& event = pNf->custom();
+        if(event.PlayersLeft)
+            _lobbies.ReturnSeats(SlotOf(pNf->task()), event.PlayersLeft);
+        if(event.Closed)
+            _lobbies.Close(SlotOf(pNf->task()));
+        if(event.Recycled)
+            Recycle(pNf->task());
+        pNf->release();
+    }
 
-        _logger.Debug() << pNf->task()->name() << " finished.";
+        // finished match server goes back to the warm pool
+    void Recycle(Poco::Task * task);
+
+    void onMatchFinished(Poco::TaskCustomNotification<DBQuery::MatchRecord>* pNf)
+    {
+        _matchSink(pNf->custom());
         pNf->release();
     }
+
+    void onFinished(Poco::TaskFinishedNotification* pNf);
     
 private:
-    NamedLogger             _logger;
+    static Configuration                        _config;
+
+    NamedLogger                                 _logger;
+    MatchSink                                   _matchSink;
+
+    Poco::ThreadPool                            _workers;
+    Poco::TaskManager                           _taskManager;
 
-    std::mutex              _availablePortsMutex;
-    std::deque<uint16_t>    _availablePorts;
+    LobbyRegistry                               _lobbies;
+    std::mutex                                  _publishMutex;  // see LobbyRegistry::Publish
 
-    Poco::TaskManager       _taskManager;
-    Poco::ThreadPool        _workers;
+    std::mutex                                  _warmMutex;
+    std::condition_variable                     _warmWakeup;    // server handed out or finished
+    std::deque<Poco::AutoPtr<GameServer>>       _warm;
+    bool                                        _warming;
+    Poco::Thread                                _warmer;
 };
 
 #endif /* GameServersController_hpp */
@@ -0,0 +1,791 @@
+// automatically generated by the FlatBuffers compiler, do not modify
+
+
+#ifndef FLATBUFFERS_GENERATED_HOSTMESSAGE_HOSTMESSAGE_H_
+#define FLATBUFFERS_GENERATED_HOSTMESSAGE_HOSTMESSAGE_H_
+
+#include "flatbuffers/flatbuffers.h"
+
+namespace HostMessage {
+
+struct HostHeartbeat;
+
+struct HostRegistered;
+
+struct StartLobby;
+
+struct LobbyStarted;
+
+struct MatchPlayer;
+
+struct MatchFinished;
+
+struct MatchRecorded;
+
+struct Message;
+
+enum Messages {
+  Messages_NONE = 0,
+  Messages_HostHeartbeat = 1,
+  Messages_HostRegistered = 2,
+  Messages_StartLobby = 3,
+  Messages_LobbyStarted = 4,
+  Messages_MatchFinished = 5,
+  Messages_MatchRecorded = 6,
+  Messages_MIN = Messages_NONE,
+  Messages_MAX = Messages_MatchRecorded
+};
+
+inline const char **EnumNamesMessages() {
+  static const char *names[] = {
+    "NONE",
+    "HostHeartbeat",
+    "HostRegistered",
+    "StartLobby",
+    "LobbyStarted",
+    "MatchFinished",
+    "MatchRecorded",
+    nullptr
+  };
+  return names;
+}
+
+inline const char *EnumNameMessages(Messages e) {
+  const size_t index = static_cast<int>(e);
+  return EnumNamesMessages()[index];
+}
+
+template<typename T> struct MessagesTraits {
+  static const Messages enum_value = Messages_NONE;
+};
+
+template<> struct MessagesTraits<HostHeartbeat> {
+  static const Messages enum_value = Messages_HostHeartbeat;
+};
+
+template<> struct MessagesTraits<HostRegistered> {
+  static const Messages enum_value = Messages_HostRegistered;
+};
+
+template<> struct MessagesTraits<StartLobby> {
+  static const Messages enum_value = Messages_StartLobby;
+};
+
+template<> struct MessagesTraits<LobbyStarted> {
+  static const Messages enum_value = Messages_LobbyStarted;
+};
+
+template<> struct MessagesTraits<MatchFinished> {
+  static const Messages enum_value = Messages_MatchFinished;
+};
+
+template<> struct MessagesTraits<MatchRecorded> {
+  static const Messages enum_value = Messages_MatchRecorded;
+};
+
+bool VerifyMessages(flatbuffers::Verifier &verifier, const void *obj, Messages type);
+bool VerifyMessagesVector(flatbuffers::Verifier &verifier, const flatbuffers::Vector<flatbuffers::Offset<void>> *values, const flatbuffers::Vector<uint8_t> *types);
+
+struct HostHeartbeat FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum {
+    VT_HOST_ID = 4,
+    VT_PUBLIC_HOST = 6,
+    VT_CAPACITY = 8,
+    VT_STANDBY = 10,
+    VT_LOBBIES = 12,
+    VT_GAMES = 14,
+    VT_CORES = 16,
+    VT_PLAYERS = 18,
+    VT_UTILIZATION = 20,
+    VT_OVERRUNS = 22,
+    VT_KEY = 24
+  };
+  uint32_t host_id() const {
+    return GetField<uint32_t>(VT_HOST_ID, 0);
+  }
+  const flatbuffers::String *public_host() const {
+    return GetPointer<const flatbuffers::String *>(VT_PUBLIC_HOST);
+  }
+  uint16_t capacity() const {
+    return GetField<uint16_t>(VT_CAPACITY, 0);
+  }
+  uint16_t standby() const {
+    return GetField<uint16_t>(VT_STANDBY, 0);
+  }
+  uint16_t lobbies() const {
+    return GetField<uint16_t>(VT_LOBBIES, 0);
+  }
+  uint16_t games() const {
+    return GetField<uint16_t>(VT_GAMES, 0);
+  }
+  uint16_t cores() const {
+    return GetField<uint16_t>(VT_CORES, 0);
+  }
+  uint16_t players() const {
+    return GetField<uint16_t>(VT_PLAYERS, 0);
+  }
+  uint32_t utilization() const {
+    return GetField<uint32_t>(VT_UTILIZATION, 0);
+  }
+  uint16_t overruns() const {
+    return GetField<uint16_t>(VT_OVERRUNS, 0);
+  }
+  uint32_t key() const {
+    return GetField<uint32_t>(VT_KEY, 0);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<uint32_t>(verifier, VT_HOST_ID) &&
+           VerifyField<flatbuffers::uoffset_t>(verifier, VT_PUBLIC_HOST) &&
+           verifier.Verify(public_host()) &&
+           VerifyField<uint16_t>(verifier, VT_CAPACITY) &&
+           VerifyField<uint16_t>(verifier, VT_STANDBY) &&
+           VerifyField<uint16_t>(verifier, VT_LOBBIES) &&
+           VerifyField<uint16_t>(verifier, VT_GAMES) &&
+           VerifyField<uint16_t>(verifier, VT_CORES) &&
+           VerifyField<uint16_t>(verifier, VT_PLAYERS) &&
+           VerifyField<uint32_t>(verifier, VT_UTILIZATION) &&
+           VerifyField<uint16_t>(verifier, VT_OVERRUNS) &&
+           VerifyField<uint32_t>(verifier, VT_KEY) &&
+           verifier.EndTable();
+  }
+};
+
+struct HostHeartbeatBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_host_id(uint32_t host_id) {
+    fbb_.AddElement<uint32_t>(HostHeartbeat::VT_HOST_ID, host_id, 0);
+  }
+  void add_public_host(flatbuffers::Offset<flatbuffers::String> public_host) {
+    fbb_.AddOffset(HostHeartbeat::VT_PUBLIC_HOST, public_host);
+  }
+  void add_capacity(uint16_t capacity) {
+    fbb_.AddElement<uint16_t>(HostHeartbeat::VT_CAPACITY, capacity, 0);
+  }
+  void add_standby(uint16_t standby) {
+    fbb_.AddElement<uint16_t>(HostHeartbeat::VT_STANDBY, standby, 0);
+  }
+  void add_lobbies(uint16_t lobbies) {
+    fbb_.AddElement<uint16_t>(HostHeartbeat::VT_LOBBIES, lobbies, 0);
+  }
+  void add_games(uint16_t games) {
+    fbb_.AddElement<uint16_t>(HostHeartbeat::VT_GAMES, games, 0);
+  }
+  void add_cores(uint16_t cores) {
+    fbb_.AddElement<uint16_t>(HostHeartbeat::VT_CORES, cores, 0);
+  }
+  void add_players(uint16_t players) {
+    fbb_.AddElement<uint16_t>(HostHeartbeat::VT_PLAYERS, players, 0);
+  }
+  void add_utilization(uint32_t utilization) {
+    fbb_.AddElement<uint32_t>(HostHeartbeat::VT_UTILIZATION, utilization, 0);
+  }
+  void add_overruns(uint16_t overruns) {
+    fbb_.AddElement<uint16_t>(HostHeartbeat::VT_OVERRUNS, overruns, 0);
+  }
+  void add_key(uint32_t key) {
+    fbb_.AddElement<uint32_t>(HostHeartbeat::VT_KEY, key, 0);
+  }
+  HostHeartbeatBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  HostHeartbeatBuilder &operator=(const HostHeartbeatBuilder &);
+  flatbuffers::Offset<HostHeartbeat> Finish() {
+    const auto end = fbb_.EndTable(start_, 11);
+    auto o = flatbuffers::Offset<HostHeartbeat>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<HostHeartbeat> CreateHostHeartbeat(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    uint32_t host_id = 0,
+    flatbuffers::Offset<flatbuffers::String> public_host = 0,
+    uint16_t capacity = 0,
+    uint16_t standby = 0,
+    uint16_t lobbies = 0,
+    uint16_t games = 0,
+    uint16_t cores = 0,
+    uint16_t players = 0,
+    uint32_t utilization = 0,
+    uint16_t overruns = 0,
+    uint32_t key = 0) {
+  HostHeartbeatBuilder builder_(_fbb);
+  builder_.add_key(key);
+  builder_.add_utilization(utilization);
+  builder_.add_public_host(public_host);
+  builder_.add_host_id(host_id);
+  builder_.add_overruns(overruns);
+  builder_.add_players(players);
+  builder_.add_cores(cores);
+  builder_.add_games(games);
+  builder_.add_lobbies(lobbies);
+  builder_.add_standby(standby);
+  builder_.add_capacity(capacity);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<HostHeartbeat> CreateHostHeartbeatDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    uint32_t host_id = 0,
+    const char *public_host = nullptr,
+    uint16_t capacity = 0,
+    uint16_t standby = 0,
+    uint16_t lobbies = 0,
+    uint16_t games = 0,
+    uint16_t cores = 0,
+    uint16_t players = 0,
+    uint32_t utilization = 0,
+    uint16_t overruns = 0,
+    uint32_t key = 0) {
+  return CreateHostHeartbeat(
+      _fbb,
+      host_id,
+      public_host ? _fbb.CreateString(public_host) : 0,
+      capacity,
+      standby,
+      lobbies,
+      games,
+      cores,
+      players,
+      utilization,
+      overruns,
+      key);
+}
+
+struct HostRegistered FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum {
+    VT_HOST_ID = 4
+  };
+  uint32_t host_id() const {
+    return GetField<uint32_t>(VT_HOST_ID, 0);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<uint32_t>(verifier, VT_HOST_ID) &&
+           verifier.EndTable();
+  }
+};
+
+struct HostRegisteredBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_host_id(uint32_t host_id) {
+    fbb_.AddElement<uint32_t>(HostRegistered::VT_HOST_ID, host_id, 0);
+  }
+  HostRegisteredBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  HostRegisteredBuilder &operator=(const HostRegisteredBuilder &);
+  flatbuffers::Offset<HostRegistered> Finish() {
+    const auto end = fbb_.EndTable(start_, 1);
+    auto o = flatbuffers::Offset<HostRegistered>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<HostRegistered> CreateHostRegistered(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    uint32_t host_id = 0) {
+  HostRegisteredBuilder builder_(_fbb);
+  builder_.add_host_id(host_id);
+  return builder_.Finish();
+}
+
+struct StartLobby FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum {
+    VT_REQUEST_ID = 4,
+    VT_PLAYERS = 6,
+    VT_RANDOM_SEED = 8
+  };
+  uint32_t request_id() const {
+    return GetField<uint32_t>(VT_REQUEST_ID, 0);
+  }
+  uint16_t players() const {
+    return GetField<uint16_t>(VT_PLAYERS, 0);
+  }
+  uint32_t random_seed() const {
+    return GetField<uint32_t>(VT_RANDOM_SEED, 0);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<uint32_t>(verifier, VT_REQUEST_ID) &&
+           VerifyField<uint16_t>(verifier, VT_PLAYERS) &&
+           VerifyField<uint32_t>(verifier, VT_RANDOM_SEED) &&
+           verifier.EndTable();
+  }
+};
+
+struct StartLobbyBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_request_id(uint32_t request_id) {
+    fbb_.AddElement<uint32_t>(StartLobby::VT_REQUEST_ID, request_id, 0);
+  }
+  void add_players(uint16_t players) {
+    fbb_.AddElement<uint16_t>(StartLobby::VT_PLAYERS, players, 0);
+  }
+  void add_random_seed(uint32_t random_seed) {
+    fbb_.AddElement<uint32_t>(StartLobby::VT_RANDOM_SEED, random_seed, 0);
+  }
+  StartLobbyBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  StartLobbyBuilder &operator=(const StartLobbyBuilder &);
+  flatbuffers::Offset<StartLobby> Finish() {
+    const auto end = fbb_.EndTable(start_, 3);
+    auto o = flatbuffers::Offset<StartLobby>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<StartLobby> CreateStartLobby(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    uint32_t request_id = 0,
+    uint16_t players = 0,
+    uint32_t random_seed = 0) {
+  StartLobbyBuilder builder_(_fbb);
+  builder_.add_random_seed(random_seed);
+  builder_.add_request_id(request_id);
+  builder_.add_players(players);
+  return builder_.Finish();
+}
+
+struct LobbyStarted FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum {
+    VT_REQUEST_ID = 4,
+    VT_PORT = 6
+  };
+  uint32_t request_id() const {
+    return GetField<uint32_t>(VT_REQUEST_ID, 0);
+  }
+  uint16_t port() const {
+    return GetField<uint16_t>(VT_PORT, 0);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<uint32_t>(verifier, VT_REQUEST_ID) &&
+           VerifyField<uint16_t>(verifier, VT_PORT) &&
+           verifier.EndTable();
+  }
+};
+
+struct LobbyStartedBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_request_id(uint32_t request_id) {
+    fbb_.AddElement<uint32_t>(LobbyStarted::VT_REQUEST_ID, request_id, 0);
+  }
+  void add_port(uint16_t port) {
+    fbb_.AddElement<uint16_t>(LobbyStarted::VT_PORT, port, 0);
+  }
+  LobbyStartedBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  LobbyStartedBuilder &operator=(const LobbyStartedBuilder &);
+  flatbuffers::Offset<LobbyStarted> Finish() {
+    const auto end = fbb_.EndTable(start_, 2);
+    auto o = flatbuffers::Offset<LobbyStarted>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<LobbyStarted> CreateLobbyStarted(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    uint32_t request_id = 0,
+    uint16_t port = 0) {
+  LobbyStartedBuilder builder_(_fbb);
+  builder_.add_request_id(request_id);
+  builder_.add_port(port);
+  return builder_.Finish();
+}
+
+struct MatchPlayer FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum {
+    VT_NAME = 4,
+    VT_HERO = 6,
+    VT_KILLS = 8,
+    VT_DEATHS = 10,
+    VT_WINNER = 12
+  };
+  const flatbuffers::String *name() const {
+    return GetPointer<const flatbuffers::String *>(VT_NAME);
+  }
+  uint32_t hero() const {
+    return GetField<uint32_t>(VT_HERO, 0);
+  }
+  uint32_t kills() const {
+    return GetField<uint32_t>(VT_KILLS, 0);
+  }
+  uint32_t deaths() const {
+    return GetField<uint32_t>(VT_DEATHS, 0);
+  }
+  bool winner() const {
+    return GetField<uint8_t>(VT_WINNER, 0) != 0;
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<flatbuffers::uoffset_t>(verifier, VT_NAME) &&
+           verifier.Verify(name()) &&
+           VerifyField<uint32_t>(verifier, VT_HERO) &&
+           VerifyField<uint32_t>(verifier, VT_KILLS) &&
+           VerifyField<uint32_t>(verifier, VT_DEATHS) &&
+           VerifyField<uint8_t>(verifier, VT_WINNER) &&
+           verifier.EndTable();
+  }
+};
+
+struct MatchPlayerBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_name(flatbuffers::Offset<flatbuffers::String> name) {
+    fbb_.AddOffset(MatchPlayer::VT_NAME, name);
+  }
+  void add_hero(uint32_t hero) {
+    fbb_.AddElement<uint32_t>(MatchPlayer::VT_HERO, hero, 0);
+  }
+  void add_kills(uint32_t kills) {
+    fbb_.AddElement<uint32_t>(MatchPlayer::VT_KILLS, kills, 0);
+  }
+  void add_deaths(uint32_t deaths) {
+    fbb_.AddElement<uint32_t>(MatchPlayer::VT_DEATHS, deaths, 0);
+  }
+  void add_winner(bool winner) {
+    fbb_.AddElement<uint8_t>(MatchPlayer::VT_WINNER, static_cast<uint8_t>(winner), 0);
+  }
+  MatchPlayerBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  MatchPlayerBuilder &operator=(const MatchPlayerBuilder &);
+  flatbuffers::Offset<MatchPlayer> Finish() {
+    const auto end = fbb_.EndTable(start_, 5);
+    auto o = flatbuffers::Offset<MatchPlayer>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<MatchPlayer> CreateMatchPlayer(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::String> name = 0,
+    uint32_t hero = 0,
+    uint32_t kills = 0,
+    uint32_t deaths = 0,
+    bool winner = false) {
+  MatchPlayerBuilder builder_(_fbb);
+  builder_.add_deaths(deaths);
+  builder_.add_kills(kills);
+  builder_.add_hero(hero);
+  builder_.add_name(name);
+  builder_.add_winner(winner);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<MatchPlayer> CreateMatchPlayerDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const char *name = nullptr,
+    uint32_t hero = 0,
+    uint32_t kills = 0,
+    uint32_t deaths = 0,
+    bool winner = false) {
+  return CreateMatchPlayer(
+      _fbb,
+      name ? _fbb.CreateString(name) : 0,
+      hero,
+      kills,
+      deaths,
+      winner);
+}
+
+struct MatchFinished FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum {
+    VT_RECORD_ID = 4,
+    VT_HOST_ID = 6,
+    VT_SERVER = 8,
+    VT_RANDOM_SEED = 10,
+    VT_STARTED_AT = 12,
+    VT_DURATION_MS = 14,
+    VT_FINISHED = 16,
+    VT_PLAYERS = 18
+  };
+  uint32_t record_id() const {
+    return GetField<uint32_t>(VT_RECORD_ID, 0);
+  }
+  uint32_t host_id() const {
+    return GetField<uint32_t>(VT_HOST_ID, 0);
+  }
+  uint32_t server() const {
+    return GetField<uint32_t>(VT_SERVER, 0);
+  }
+  uint32_t random_seed() const {
+    return GetField<uint32_t>(VT_RANDOM_SEED, 0);
+  }
+  int64_t started_at() const {
+    return GetField<int64_t>(VT_STARTED_AT, 0);
+  }
+  uint32_t duration_ms() const {
+    return GetField<uint32_t>(VT_DURATION_MS, 0);
+  }
+  bool finished() const {
+    return GetField<uint8_t>(VT_FINISHED, 0) != 0;
+  }
+  const flatbuffers::Vector<flatbuffers::Offset<MatchPlayer>> *players() const {
+    return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<MatchPlayer>> *>(VT_PLAYERS);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<uint32_t>(verifier, VT_RECORD_ID) &&
+           VerifyField<uint32_t>(verifier, VT_HOST_ID) &&
+           VerifyField<uint32_t>(verifier, VT_SERVER) &&
+           VerifyField<uint32_t>(verifier, VT_RANDOM_SEED) &&
+           VerifyField<int64_t>(verifier, VT_STARTED_AT) &&
+           VerifyField<uint32_t>(verifier, VT_DURATION_MS) &&
+           VerifyField<uint8_t>(verifier, VT_FINISHED) &&
+           VerifyField<flatbuffers::uoffset_t>(verifier, VT_PLAYERS) &&
+           verifier.Verify(players()) &&
+           verifier.VerifyVectorOfTables(players()) &&
+           verifier.EndTable();
+  }
+};
+
+struct MatchFinishedBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_record_id(uint32_t record_id) {
+    fbb_.AddElement<uint32_t>(MatchFinished::VT_RECORD_ID, record_id, 0);
+  }
+  void add_host_id(uint32_t host_id) {
+    fbb_.AddElement<uint32_t>(MatchFinished::VT_HOST_ID, host_id, 0);
+  }
+  void add_server(uint32_t server) {
+    fbb_.AddElement<uint32_t>(MatchFinished::VT_SERVER, server, 0);
+  }
+  void add_random_seed(uint32_t random_seed) {
+    fbb_.AddElement<uint32_t>(MatchFinished::VT_RANDOM_SEED, random_seed, 0);
+  }
+  void add_started_at(int64_t started_at) {
+    fbb_.AddElement<int64_t>(MatchFinished::VT_STARTED_AT, started_at, 0);
+  }
+  void add_duration_ms(uint32_t duration_ms) {
+    fbb_.AddElement<uint32_t>(MatchFinished::VT_DURATION_MS, duration_ms, 0);
+  }
+  void add_finished(bool finished) {
+    fbb_.AddElement<uint8_t>(MatchFinished::VT_FINISHED, static_cast<uint8_t>(finished), 0);
+  }
+  void add_players(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<MatchPlayer>>> players) {
+    fbb_.AddOffset(MatchFinished::VT_PLAYERS, players);
+  }
+  MatchFinishedBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  MatchFinishedBuilder &operator=(const MatchFinishedBuilder &);
+  flatbuffers::Offset<MatchFinished> Finish() {
+    const auto end = fbb_.EndTable(start_, 8);
+    auto o = flatbuffers::Offset<MatchFinished>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<MatchFinished> CreateMatchFinished(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    uint32_t record_id = 0,
+    uint32_t host_id = 0,
+    uint32_t server = 0,
+    uint32_t random_seed = 0,
+    int64_t started_at = 0,
+    uint32_t duration_ms = 0,
+    bool finished = false,
+    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<MatchPlayer>>> players = 0) {
+  MatchFinishedBuilder builder_(_fbb);
+  builder_.add_started_at(started_at);
+  builder_.add_players(players);
+  builder_.add_duration_ms(duration_ms);
+  builder_.add_random_seed(random_seed);
+  builder_.add_server(server);
+  builder_.add_host_id(host_id);
+  builder_.add_record_id(record_id);
+  builder_.add_finished(finished);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<MatchFinished> CreateMatchFinishedDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    uint32_t record_id = 0,
+    uint32_t host_id = 0,
+    uint32_t server = 0,
+    uint32_t random_seed = 0,
+    int64_t started_at = 0,
+    uint32_t duration_ms = 0,
+    bool finished = false,
+    const std::vector<flatbuffers::Offset<MatchPlayer>> *players = nullptr) {
+  return CreateMatchFinished(
+      _fbb,
+      record_id,
+      host_id,
+      server,
+      random_seed,
+      started_at,
+      duration_ms,
+      finished,
+      players ? _fbb.CreateVector<flatbuffers::Offset<MatchPlayer>>(*players) : 0);
+}
+
+struct MatchRecorded FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum {
+    VT_RECORD_ID = 4
+  };
+  uint32_t record_id() const {
+    return GetField<uint32_t>(VT_RECORD_ID, 0);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<uint32_t>(verifier, VT_RECORD_ID) &&
+           verifier.EndTable();
+  }
+};
+
+struct MatchRecordedBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_record_id(uint32_t record_id) {
+    fbb_.AddElement<uint32_t>(MatchRecorded::VT_RECORD_ID, record_id, 0);
+  }
+  MatchRecordedBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  MatchRecordedBuilder &operator=(const MatchRecordedBuilder &);
+  flatbuffers::Offset<MatchRecorded> Finish() {
+    const auto end = fbb_.EndTable(start_, 1);
+    auto o = flatbuffers::Offset<MatchRecorded>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<MatchRecorded> CreateMatchRecorded(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    uint32_t record_id = 0) {
+  MatchRecordedBuilder builder_(_fbb);
+  builder_.add_record_id(record_id);
+  return builder_.Finish();
+}
+
+struct Message FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum {
+    VT_PAYLOAD_TYPE = 4,
+    VT_PAYLOAD = 6
+  };
+  Messages payload_type() const {
+    return static_cast<Messages>(GetField<uint8_t>(VT_PAYLOAD_TYPE, 0));
+  }
+  const void *payload() const {
+    return GetPointer<const void *>(VT_PAYLOAD);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<uint8_t>(verifier, VT_PAYLOAD_TYPE) &&
+           VerifyField<flatbuffers::uoffset_t>(verifier, VT_PAYLOAD) &&
+           VerifyMessages(verifier, payload(), payload_type()) &&
+           verifier.EndTable();
+  }
+};
+
+struct MessageBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_payload_type(Messages payload_type) {
+    fbb_.AddElement<uint8_t>(Message::VT_PAYLOAD_TYPE, static_cast<uint8_t>(payload_type), 0);
+  }
+  void add_payload(flatbuffers::Offset<void> payload) {
+    fbb_.AddOffset(Message::VT_PAYLOAD, payload);
+  }
+  MessageBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  MessageBuilder &operator=(const MessageBuilder &);
+  flatbuffers::Offset<Message> Finish() {
+    const auto end = fbb_.EndTable(start_, 2);
+    auto o = flatbuffers::Offset<Message>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<Message> CreateMessage(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    Messages payload_type = Messages_NONE,
+    flatbuffers::Offset<void> payload = 0) {
+  MessageBuilder builder_(_fbb);
+  builder_.add_payload(payload);
+  builder_.add_payload_type(payload_type);
+  return builder_.Finish();
+}
+
+inline bool VerifyMessages(flatbuffers::Verifier &verifier, const void *obj, Messages type) {
+  switch (type) {
+    case Messages_NONE: {
+      return true;
+    }
+    case Messages_HostHeartbeat: {
+      auto ptr = reinterpret_cast<const HostHeartbeat *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case Messages_HostRegistered: {
+      auto ptr = reinterpret_cast<const HostRegistered *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case Messages_StartLobby: {
+      auto ptr = reinterpret_cast<const StartLobby *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case Messages_LobbyStarted: {
+      auto ptr = reinterpret_cast<const LobbyStarted *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case Messages_MatchFinished: {
+      auto ptr = reinterpret_cast<const MatchFinished *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case Messages_MatchRecorded: {
+      auto ptr = reinterpret_cast<const MatchRecorded *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    default: return false;
+  }
+}
+
+inline bool VerifyMessagesVector(flatbuffers::Verifier &verifier, const flatbuffers::Vector<flatbuffers::Offset<void>> *values, const flatbuffers::Vector<uint8_t> *types) {
+  if (values->size() != types->size()) return false;
+  for (flatbuffers::uoffset_t i = 0; i < values->size(); ++i) {
+    if (!VerifyMessages(
+        verifier,  values->Get(i), types->GetEnum<Messages>(i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+inline const HostMessage::Message *GetMessage(const void *buf) {
+  return flatbuffers::GetRoot<HostMessage::Message>(buf);
+}
+
+inline bool VerifyMessageBuffer(
+    flatbuffers::Verifier &verifier) {
+  return verifier.VerifyBuffer<HostMessage::Message>(nullptr);
+}
+
+inline void FinishMessageBuffer(
+    flatbuffers::FlatBufferBuilder &fbb,
+    flatbuffers::Offset<HostMessage::Message> root) {
+  fbb.Finish(root);
+}
+
+}  // namespace HostMessage
+
+#endif  // FLATBUFFERS_GENERATED_HOSTMESSAGE_HOSTMESSAGE_H_
@@ -34,6 +34,12 @@ struct CL_ADM_Shutdown;
 
 struct SV_ADM_Shutdown;
 
+struct CLLeaderboard;
+
+struct LeaderboardEntry;
+
+struct SVLeaderboard;
+
 struct Message;
 
 enum RegistrationStatus {
@@ -114,8 +120,10 @@ enum Messages {
   Messages_SV_ADM_Stats = 11,
   Messages_CL_ADM_Shutdown = 12,
   Messages_SV_ADM_Shutdown = 13,
+  Messages_CLLeaderboard = 14,
+  Messages_SVLeaderboard = 15,
   Messages_MIN = Messages_NONE,
-  Messages_MAX = Messages_SV_ADM_Shutdown
+  Messages_MAX = Messages_SVLeaderboard
 };
 
 inline const char **EnumNamesMessages() {
@@ -134,6 +142,8 @@ inline const char **EnumNamesMessages() {
     "SV_ADM_Stats",
     "CL_ADM_Shutdown",
     "SV_ADM_Shutdown",
+    "CLLeaderboard",
+    "SVLeaderboard",
     nullptr
   };
   return names;
@@ -200,6 +210,14 @@ template<> struct MessagesTraits<SV_ADM_Shutdown> {
   static const Messages enum_value = Messages_SV_ADM_Shutdown;
 };
 
+template<> struct MessagesTraits<CLLeaderboard> {
+  static const Messages enum_value = Messages_CLLeaderboard;
+};
+
+template<> struct MessagesTraits<SVLeaderboard> {
+  static const Messages enum_value = Messages_SVLeaderboard;
+};
+
 bool VerifyMessages(flatbuffers::Verifier &verifier, const void *obj, Messages type);
 bool VerifyMessagesVector(flatbuffers::Verifier &verifier, const flatbuffers::Vector<flatbuffers::Offset<void>> *values, const flatbuffers::Vector<uint8_t> *types);
 
@@ -468,7 +486,9 @@ struct CLFindGame FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
     VT_PLAYER_UID = 4,
     VT_CL_VERSION_MAJOR = 6,
     VT_CL_VERSION_MINOR = 8,
-    VT_CL_VERSION_BUILD = 10
+    VT_CL_VERSION_BUILD = 10,
+    VT_LOBBY_SIZE = 12,
+    VT_RTT = 14
   };
   uint32_t player_uid() const {
     return GetField<uint32_t>(VT_PLAYER_UID, 0);
@@ -482,12 +502,20 @@ struct CLFindGame FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   int8_t cl_version_build() const {
     return GetField<int8_t>(VT_CL_VERSION_BUILD, 0);
   }
+  uint8_t lobby_size() const {
+    return GetField<uint8_t>(VT_LOBBY_SIZE, 0);
+  }
+  uint16_t rtt() const {
+    return GetField<uint16_t>(VT_RTT, 0);
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyField<uint32_t>(verifier, VT_PLAYER_UID) &&
            VerifyField<int8_t>(verifier, VT_CL_VERSION_MAJOR) &&
            VerifyField<int8_t>(verifier, VT_CL_VERSION_MINOR) &&
            VerifyField<int8_t>(verifier, VT_CL_VERSION_BUILD) &&
+           VerifyField<uint8_t>(verifier, VT_LOBBY_SIZE) &&
+           VerifyField<uint16_t>(verifier, VT_RTT) &&
            verifier.EndTable();
   }
 };
@@ -507,13 +535,19 @@ struct CLFindGameBuilder {
   void add_cl_version_build(int8_t cl_version_build) {
     fbb_.AddElement<int8_t>(CLFindGame::VT_CL_VERSION_BUILD, cl_version_build, 0);
   }
+  void add_lobby_size(uint8_t lobby_size) {
+    fbb_.AddElement<uint8_t>(CLFindGame::VT_LOBBY_SIZE, lobby_size, 0);
+  }
+  void add_rtt(uint16_t rtt) {
+    fbb_.AddElement<uint16_t>(CLFindGame::VT_RTT, rtt, 0);
+  }
   CLFindGameBuilder(flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
   }
   CLFindGameBuilder &operator=(const CLFindGameBuilder &);
   flatbuffers::Offset<CLFindGame> Finish() {
-    const auto end = fbb_.EndTable(start_, 4);
+    const auto end = fbb_.EndTable(start_, 6);
     auto o = flatbuffers::Offset<CLFindGame>(end);
     return o;
   }
@@ -524,9 +558,13 @@ inline flatbuffers::Offset<CLFindGame> CreateCLFindGame(
     uint32_t player_uid = 0,
     int8_t cl_version_major = 0,
     int8_t cl_version_minor = 0,
-    int8_t cl_version_build = 0) {
+    int8_t cl_version_build = 0,
+    uint8_t lobby_size = 0,
+    uint16_t rtt = 0) {
   CLFindGameBuilder builder_(_fbb);
   builder_.add_player_uid(player_uid);
+  builder_.add_rtt(rtt);
+  builder_.add_lobby_size(lobby_size);
   builder_.add_cl_version_build(cl_version_build);
   builder_.add_cl_version_minor(cl_version_minor);
   builder_.add_cl_version_major(cl_version_major);
@@ -585,14 +623,20 @@ inline flatbuffers::Offset<SVFindGame> CreateSVFindGame(
 
 struct SVGameFound FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   enum {
-    VT_GS_PORT = 4
+    VT_GS_PORT = 4,
+    VT_GS_HOST = 6
   };
   uint32_t gs_port() const {
     return GetField<uint32_t>(VT_GS_PORT, 0);
   }
+  const flatbuffers::String *gs_host() const {
+    return GetPointer<const flatbuffers::String *>(VT_GS_HOST);
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyField<uint32_t>(verifier, VT_GS_PORT) &&
+           VerifyField<flatbuffers::uoffset_t>(verifier, VT_GS_HOST) &&
+           verifier.Verify(gs_host()) &&
            verifier.EndTable();
   }
 };
@@ -603,13 +647,16 @@ struct SVGameFoundBuilder {
   void add_gs_port(uint32_t gs_port) {
     fbb_.AddElement<uint32_t>(SVGameFound::VT_GS_PORT, gs_port, 0);
   }
+  void add_gs_host(flatbuffers::Offset<flatbuffers::String> gs_host) {
+    fbb_.AddOffset(SVGameFound::VT_GS_HOST, gs_host);
+  }
   SVGameFoundBuilder(flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
   }
   SVGameFoundBuilder &operator=(const SVGameFoundBuilder &);
   flatbuffers::Offset<SVGameFound> Finish() {
-    const auto end = fbb_.EndTable(start_, 1);
+    const auto end = fbb_.EndTable(start_, 2);
     auto o = flatbuffers::Offset<SVGameFound>(end);
     return o;
   }
@@ -617,12 +664,24 @@ struct SVGameFoundBuilder {
 
 inline flatbuffers::Offset<SVGameFound> CreateSVGameFound(
     flatbuffers::FlatBufferBuilder &_fbb,
-    uint32_t gs_port = 0) {
+    uint32_t gs_port = 0,
+    flatbuffers::Offset<flatbuffers::String> gs_host = 0) {
   SVGameFoundBuilder builder_(_fbb);
+  builder_.add_gs_host(gs_host);
   builder_.add_gs_port(gs_port);
   return builder_.Finish();
 }
 
+inline flatbuffers::Offset<SVGameFound> CreateSVGameFoundDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    uint32_t gs_port = 0,
+    const char *gs_host = nullptr) {
+  return CreateSVGameFound(
+      _fbb,
+      gs_port,
+      gs_host ? _fbb.CreateString(gs_host) : 0);
+}
+
 struct CL_ADM_Stats FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   enum {
     VT_ADM_KEY = 4
@@ -801,6 +860,226 @@ inline flatbuffers::Offset<SV_ADM_Shutdown> CreateSV_ADM_ShutdownDirect(
       response ? _fbb.CreateString(response) : 0);
 }
 
+struct CLLeaderboard FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum {
+    VT_NAME = 4
+  };
+  const flatbuffers::String *name() const {
+    return GetPointer<const flatbuffers::String *>(VT_NAME);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<flatbuffers::uoffset_t>(verifier, VT_NAME) &&
+           verifier.Verify(name()) &&
+           verifier.EndTable();
+  }
+};
+
+struct CLLeaderboardBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_name(flatbuffers::Offset<flatbuffers::String> name) {
+    fbb_.AddOffset(CLLeaderboard::VT_NAME, name);
+  }
+  CLLeaderboardBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  CLLeaderboardBuilder &operator=(const CLLeaderboardBuilder &);
+  flatbuffers::Offset<CLLeaderboard> Finish() {
+    const auto end = fbb_.EndTable(start_, 1);
+    auto o = flatbuffers::Offset<CLLeaderboard>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<CLLeaderboard> CreateCLLeaderboard(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::String> name = 0) {
+  CLLeaderboardBuilder builder_(_fbb);
+  builder_.add_name(name);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<CLLeaderboard> CreateCLLeaderboardDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const char *name = nullptr) {
+  return CreateCLLeaderboard(
+      _fbb,
+      name ? _fbb.CreateString(name) : 0);
+}
+
+struct LeaderboardEntry FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum {
+    VT_NAME = 4,
+    VT_POINTS = 6,
+    VT_WINS = 8,
+    VT_KILLS = 10,
+    VT_DEATHS = 12
+  };
+  const flatbuffers::String *name() const {
+    return GetPointer<const flatbuffers::String *>(VT_NAME);
+  }
+  uint32_t points() const {
+    return GetField<uint32_t>(VT_POINTS, 0);
+  }
+  uint32_t wins() const {
+    return GetField<uint32_t>(VT_WINS, 0);
+  }
+  uint32_t kills() const {
+    return GetField<uint32_t>(VT_KILLS, 0);
+  }
+  uint32_t deaths() const {
+    return GetField<uint32_t>(VT_DEATHS, 0);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<flatbuffers::uoffset_t>(verifier, VT_NAME) &&
+           verifier.Verify(name()) &&
+           VerifyField<uint32_t>(verifier, VT_POINTS) &&
+           VerifyField<uint32_t>(verifier, VT_WINS) &&
+           VerifyField<uint32_t>(verifier, VT_KILLS) &&
+           VerifyField<uint32_t>(verifier, VT_DEATHS) &&
+           verifier.EndTable();
+  }
+};
+
+struct LeaderboardEntryBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_name(flatbuffers::Offset<flatbuffers::String> name) {
+    fbb_.AddOffset(LeaderboardEntry::VT_NAME, name);
+  }
+  void add_points(uint32_t points) {
+    fbb_.AddElement<uint32_t>(LeaderboardEntry::VT_POINTS, points, 0);
+  }
+  void add_wins(uint32_t wins) {
+    fbb_.AddElement<uint32_t>(LeaderboardEntry::VT_WINS, wins, 0);
+  }
+  void add_kills(uint32_t kills) {
+    fbb_.AddElement<uint32_t>(LeaderboardEntry::VT_KILLS, kills, 0);
+  }
+  void add_deaths(uint32_t deaths) {
+    fbb_.AddElement<uint32_t>(LeaderboardEntry::VT_DEATHS, deaths, 0);
+  }
+  LeaderboardEntryBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  LeaderboardEntryBuilder &operator=(const LeaderboardEntryBuilder &);
+  flatbuffers::Offset<LeaderboardEntry> Finish() {
+    const auto end = fbb_.EndTable(start_, 5);
+    auto o = flatbuffers::Offset<LeaderboardEntry>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<LeaderboardEntry> CreateLeaderboardEntry(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::String> name = 0,
+    uint32_t points = 0,
+    uint32_t wins = 0,
+    uint32_t kills = 0,
+    uint32_t deaths = 0) {
+  LeaderboardEntryBuilder builder_(_fbb);
+  builder_.add_deaths(deaths);
+  builder_.add_kills(kills);
+  builder_.add_wins(wins);
+  builder_.add_points(points);
+  builder_.add_name(name);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<LeaderboardEntry> CreateLeaderboardEntryDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const char *name = nullptr,
+    uint32_t points = 0,
+    uint32_t wins = 0,
+    uint32_t kills = 0,
+    uint32_t deaths = 0) {
+  return CreateLeaderboardEntry(
+      _fbb,
+      name ? _fbb.CreateString(name) : 0,
+      points,
+      wins,
+      kills,
+      deaths);
+}
+
+struct SVLeaderboard FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum {
+    VT_TOP = 4,
+    VT_RANK = 6,
+    VT_POINTS = 8
+  };
+  const flatbuffers::Vector<flatbuffers::Offset<LeaderboardEntry>> *top() const {
+    return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<LeaderboardEntry>> *>(VT_TOP);
+  }
+  uint32_t rank() const {
+    return GetField<uint32_t>(VT_RANK, 0);
+  }
+  uint32_t points() const {
+    return GetField<uint32_t>(VT_POINTS, 0);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<flatbuffers::uoffset_t>(verifier, VT_TOP) &&
+           verifier.Verify(top()) &&
+           verifier.VerifyVectorOfTables(top()) &&
+           VerifyField<uint32_t>(verifier, VT_RANK) &&
+           VerifyField<uint32_t>(verifier, VT_POINTS) &&
+           verifier.EndTable();
+  }
+};
+
+struct SVLeaderboardBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_top(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<LeaderboardEntry>>> top) {
+    fbb_.AddOffset(SVLeaderboard::VT_TOP, top);
+  }
+  void add_rank(uint32_t rank) {
+    fbb_.AddElement<uint32_t>(SVLeaderboard::VT_RANK, rank, 0);
+  }
+  void add_points(uint32_t points) {
+    fbb_.AddElement<uint32_t>(SVLeaderboard::VT_POINTS, points, 0);
+  }
+  SVLeaderboardBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  SVLeaderboardBuilder &operator=(const SVLeaderboardBuilder &);
+  flatbuffers::Offset<SVLeaderboard> Finish() {
+    const auto end = fbb_.EndTable(start_, 3);
+    auto o = flatbuffers::Offset<SVLeaderboard>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<SVLeaderboard> CreateSVLeaderboard(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<LeaderboardEntry>>> top = 0,
+    uint32_t rank = 0,
+    uint32_t points = 0) {
+  SVLeaderboardBuilder builder_(_fbb);
+  builder_.add_points(points);
+  builder_.add_rank(rank);
+  builder_.add_top(top);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<SVLeaderboard> CreateSVLeaderboardDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<flatbuffers::Offset<LeaderboardEntry>> *top = nullptr,
+    uint32_t rank = 0,
+    uint32_t points = 0) {
+  return CreateSVLeaderboard(
+      _fbb,
+      top ? _fbb.CreateVector<flatbuffers::Offset<LeaderboardEntry>>(*top) : 0,
+      rank,
+      points);
+}
+
 struct Message FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   enum {
     VT_SENDER_ID = 4,
@@ -932,6 +1211,14 @@ inline bool VerifyMessages(flatbuffers::Verifier &verifier, const void *obj, Mes
       auto ptr = reinterpret_cast<const SV_ADM_Shutdown *>(obj);
       return verifier.VerifyTable(ptr);
     }
+    case Messages_CLLeaderboard: {
+      auto ptr = reinterpret_cast<const CLLeaderboard *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case Messages_SVLeaderboard: {
+      auto ptr = reinterpret_cast<const SVLeaderboard *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
     default: return false;
   }
 }
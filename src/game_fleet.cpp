@@ -0,0 +1,435 @@
+//
+//  game_fleet.cpp
+//  labyrinth_server
+//
+
+#include "game_fleet.hpp"
+
+#include "services/leaderboard.hpp"
+#include "services/match_history.hpp"
+#include "toolkit/SafePacketGetter.hpp"
+
+#include <Poco/Environment.h>
+#include <Poco/Timespan.h>
+
+#include <algorithm>
+
+using namespace HostMessage;
+
+
+namespace
+{
+        // lobbies do not tick yet, but will soon, a fresh match costs about that much of a core
+    const double LOBBY_COST = 0.05;
+    const double PLAYER_COST = 0.005;
+        // overruns are jitter players already feel, such host is avoided even with idle cores
+    const double OVERRUN_WEIGHT = 2.0;
+
+        // acknowledged record ids remembered per host, enough to recognize resends after a lost ack
+    const size_t RECORDED_IDS = 256;
+}
+
+
+GameFleet::Configuration GameFleet::_config = { Poco::Net::SocketAddress("127.0.0.1", 1929), true,
+                                                std::chrono::milliseconds(3000), std::chrono::milliseconds(200), 0 };
+
+
+GameFleet::GameFleet()
+: _logger("GameFleet", NamedLogger::Mode::STDIO),
+  _socket(_config.ControlAddress),
+  _dropped(LogHandle(_logger), { "Dropped match results from unregistered senders",
+                                 "Dropped heartbeats with invalid host key",
+                                 "Dropped heartbeats of registered hosts from another address",
+                                 "Dropped lobby answers from unasked senders" }),
+  _lastRequestId(0),
+  _running(true),
+  _receiver("GameFleetControl")
+{
+    if(_config.LocalServers)
+        _local = std::make_unique<GameServersController>(&GameFleet::ReportMatch);
+
+    LOG_INFO(_logger) << "Waiting for game hosts on " << _config.ControlAddress.toString()
+                      << (_local ? ", local servers are on" : ", no local servers");
+    if(_config.HostKey == 0)
+        _logger.Warning() << "Host key is not set, anyone who knows the control address can register a host";
+
+    _receiver.start(*this);
+}
+
+
+GameFleet::~GameFleet()
+{
+    _running = false;
+    _receiver.join();
+
+    _local.reset();
+}
+
+
+std::experimental::optional<GameEndpoint>
+GameFleet::TakeFreedSeat()
+{
+    if(!_local)
+        return {};
+
+    if(auto port = _local->TakeFreedSeat())
+        return GameEndpoint { std::string(), *port };
+
+    return {};
+}
+
+
+std::experimental::optional<GameEndpoint>
+GameFleet::StartLobby(uint16_t players)
+{
+        // host id 0 is the master itself
+    struct Candidate
+    {
+        double                      Score;
+        uint32_t                    HostId;
+        std::string                 PublicHost;
+        Poco::Net::SocketAddress    Control;
+    };
+    std::vector<Candidate> candidates;
+    if(_local)
+        candidates.push_back({ PlacementScore(LocalStats()), 0, std::string(), Poco::Net::SocketAddress() });
+    {
+        std::lock_guard<std::mutex> l(_hostsMutex);
+        for(auto& host : _hosts)
+        {
+            auto& stats = host.second.Stats;
+            if(stats.Capacity > stats.Lobbies + stats.Games)
+                candidates.push_back({ PlacementScore(stats), stats.HostId, stats.PublicHost, host.second.Control });
+        }
+    }
+
+        // the next one is asked only if the better one turns out to be full
+    std::stable_sort(candidates.begin(),
+                     candidates.end(),
+                     [](const Candidate& a, const Candidate& b)
+                     {
+                         return a.Score < b.Score;
+                     });
+
+    for(auto& candidate : candidates)
+    {
+        if(candidate.HostId == 0)
+        {
+            if(auto port = _local->StartLobby(players))
+                return GameEndpoint { std::string(), *port };
+            continue;
+        }
+
+        auto port = RequestLobby(candidate.Control, players);
+        if(!port)
+            continue;
+
+            // counted until the next heartbeat tells otherwise, so matches of one round spread out
+        {
+            std::lock_guard<std::mutex> l(_hostsMutex);
+            auto host = _hosts.find(candidate.HostId);
+            if(host != _hosts.end())
+            {
+                ++host->second.Stats.Lobbies;
+                host->second.Stats.Players += players;
+            }
+        }
+
+        return GameEndpoint { candidate.PublicHost, *port };
+    }
+
+    return {};
+}
+
+
+std::vector<GameFleet::HostStats>
+GameFleet::GetHosts() const
+{
+    std::lock_guard<std::mutex> l(_hostsMutex);
+
+    std::vector<HostStats> hosts;
+    hosts.reserve(_hosts.size());
+    for(auto& host : _hosts)
+        hosts.push_back(host.second.Stats);
+
+    return hosts;
+}
+
+
+void
+GameFleet::run()
+{
+    SafePacketGetter packetGetter(_socket);
+    Packet packet;
+    while(_running)
+    {
+        ExpireHosts(std::chrono::steady_clock::now());
+
+        packetGetter.FlushWarnings();
+        _dropped.Flush();
+        if(!_socket.poll(Poco::Timespan(0, 100000), Poco::Net::Socket::SELECT_READ))
+            continue;
+        if(!packetGetter.Get<HostMessage::Message>(packet))
+            continue;
+
+        auto msg = GetMessage(packet.Data.data());
+        switch(msg->payload_type())
+        {
+        case Messages_HostHeartbeat:
+            OnHeartbeat(packet.Sender,
+                        static_cast<const HostHeartbeat*>(msg->payload()));
+            break;
+
+        case Messages_LobbyStarted:
+            if(!OnLobbyStarted(packet.Sender,
+                               static_cast<const LobbyStarted*>(msg->payload())))
+                _dropped.Report(UNKNOWN_LOBBY_SENDER, packet.Sender);
+            break;
+
+        case Messages_MatchFinished:
+            if(!OnMatchFinished(packet.Sender,
+                                static_cast<const MatchFinished*>(msg->payload())))
+                _dropped.Report(UNKNOWN_MATCH_SENDER, packet.Sender);
+            break;
+
+        default:
+            _logger.Warning() << "Undefined control packet from [" << packet.Sender.toString() << "]";
+            break;
+        }
+    }
+}
+
+
+void
+GameFleet::ReportMatch(const DBQuery::MatchRecord& match)
+{
+    Leaderboard::Instance().Report(match);
+
+        // queued only, the database is written from MatchHistory thread
+    MatchHistory::Instance().Record(match);
+}
+
+
+double
+GameFleet::PlacementScore(const HostStats& stats)
+{
+    auto cores = std::max<uint16_t>(stats.Cores, 1);
+    return (stats.Utilization / 1000.0 + stats.Lobbies * LOBBY_COST + stats.Players * PLAYER_COST) / cores
+           + stats.Overruns / 1000.0 * OVERRUN_WEIGHT;
+}
+
+
+GameFleet::HostStats
+GameFleet::LocalStats() const
+{
+    auto servers = _local->GetStats();
+
+    HostStats stats {};
+    stats.Capacity = static_cast<uint16_t>(servers.Workers);
+    stats.Standby = static_cast<uint16_t>(servers.Warm);
+    stats.Lobbies = static_cast<uint16_t>(servers.Lobbies);
+    stats.Games = static_cast<uint16_t>(servers.Games);
+    stats.Cores = static_cast<uint16_t>(Poco::Environment::processorCount());
+    stats.Players = static_cast<uint16_t>(servers.Players);
+    stats.Utilization = servers.Utilization;
+    stats.Overruns = servers.Overruns;
+    return stats;
+}
+
+
+std::experimental::optional<uint16_t>
+GameFleet::RequestLobby(const Poco::Net::SocketAddress& control,
+                        uint16_t players)
+{
+    uint32_t requestId;
+    {
+        std::lock_guard<std::mutex> l(_requestsMutex);
+        requestId = ++_lastRequestId;
+        _requests[requestId].Control = control;
+    }
+
+    flatbuffers::FlatBufferBuilder builder;
+    auto request = CreateStartLobby(builder,
+                                    requestId,
+                                    players,
+                                    0);
+    builder.Finish(CreateMessage(builder,
+                                 Messages_StartLobby,
+                                 request.Union()));
+    _socket.sendTo(builder.GetBufferPointer(),
+                   builder.GetSize(),
+                   control);
+
+    std::unique_lock<std::mutex> l(_requestsMutex);
+    auto answer = _requests.find(requestId);
+    _answered.wait_for(l,
+                       _config.RequestTimeout,
+                       [&] { return static_cast<bool>(answer->second.Port); });
+
+    auto port = answer->second.Port;
+    _requests.erase(answer);
+
+    if(!port)
+    {
+        _logger.Warning() << "Game host [" << control.toString() << "] did not answer in time";
+        return {};
+    }
+    if(*port == 0)
+        return {};
+
+    return port;
+}
+
+
+void
+GameFleet::OnHeartbeat(const Poco::Net::SocketAddress& sender,
+                       const HostHeartbeat* heartbeat)
+{
+    if(heartbeat->key() != _config.HostKey)
+    {
+        _dropped.Report(INVALID_HOST_KEY, sender);
+        return;
+    }
+
+    bool registered = false;
+    {
+        std::lock_guard<std::mutex> l(_hostsMutex);
+
+        auto found = _hosts.find(heartbeat->host_id());
+        registered = found == _hosts.end();
+        if(registered)
+        {
+                // where matches and players of the host go, fixed until the host times out
+            found = _hosts.emplace(heartbeat->host_id(), Host()).first;
+            found->second.Stats.HostId = heartbeat->host_id();
+            found->second.Stats.Control = sender.toString();
+            found->second.Stats.PublicHost = heartbeat->public_host() ? heartbeat->public_host()->str()
+                                                                      : std::string();
+            found->second.Control = sender;
+        }
+        else if(found->second.Control != sender)
+        {
+            _dropped.Report(MOVED_HOST, sender);
+            return;
+        }
+
+        auto& host = found->second;
+        host.Stats.Capacity = heartbeat->capacity();
+        host.Stats.Standby = heartbeat->standby();
+        host.Stats.Lobbies = heartbeat->lobbies();
+        host.Stats.Games = heartbeat->games();
+        host.Stats.Cores = heartbeat->cores();
+        host.Stats.Players = heartbeat->players();
+        host.Stats.Utilization = heartbeat->utilization();
+        host.Stats.Overruns = heartbeat->overruns();
+        host.LastSeen = std::chrono::steady_clock::now();
+    }
+
+    if(!registered)
+        return;
+
+    LOG_INFO(_logger) << "Game host " << heartbeat->host_id() << " registered from [" << sender.toString()
+                      << "], capacity " << heartbeat->capacity();
+
+    flatbuffers::FlatBufferBuilder builder;
+    builder.Finish(CreateMessage(builder,
+                                 Messages_HostRegistered,
+                                 CreateHostRegistered(builder, heartbeat->host_id()).Union()));
+    _socket.sendTo(builder.GetBufferPointer(),
+                   builder.GetSize(),
+                   sender);
+}
+
+
+bool
+GameFleet::OnLobbyStarted(const Poco::Net::SocketAddress& sender,
+                          const LobbyStarted* started)
+{
+    {
+        std::lock_guard<std::mutex> l(_requestsMutex);
+
+            // late answers of timed out requests are dropped
+        auto request = _requests.find(started->request_id());
+        if(request == _requests.end())
+            return true;
+        if(request->second.Control != sender)
+            return false;
+        request->second.Port = started->port();
+    }
+    _answered.notify_all();
+
+    return true;
+}
+
+
+bool
+GameFleet::OnMatchFinished(const Poco::Net::SocketAddress& sender,
+                           const MatchFinished* finished)
+{
+    bool duplicate;
+    {
+        std::lock_guard<std::mutex> l(_hostsMutex);
+
+            // anyone can send a datagram, results count only from where the host registered
+        auto host = _hosts.find(finished->host_id());
+        if(host == _hosts.end() || host->second.Control != sender)
+            return false;
+
+        auto& recorded = host->second.Recorded;
+        duplicate = !recorded.insert(finished->record_id()).second;
+        if(recorded.size() > RECORDED_IDS)
+            recorded.erase(recorded.begin());
+    }
+
+    if(!duplicate)
+    {
+        DBQuery::MatchRecord match;
+        match.Server = finished->server();
+        match.RandomSeed = finished->random_seed();
+        match.StartedAt = finished->started_at();
+        match.DurationMs = finished->duration_ms();
+        match.Finished = finished->finished();
+        if(finished->players())
+        {
+            for(auto player : *finished->players())
+                match.Players.push_back({ player->name() ? player->name()->str() : std::string(),
+                                          player->hero(),
+                                          player->kills(),
+                                          player->deaths(),
+                                          player->winner() });
+        }
+
+        LOG_DEBUG(_logger) << "Match on host " << finished->host_id() << " port " << match.Server << " finished";
+        ReportMatch(match);
+    }
+
+        // acked again if the first ack was lost
+    flatbuffers::FlatBufferBuilder builder;
+    builder.Finish(CreateMessage(builder,
+                                 Messages_MatchRecorded,
+                                 CreateMatchRecorded(builder, finished->record_id()).Union()));
+    _socket.sendTo(builder.GetBufferPointer(),
+                   builder.GetSize(),
+                   sender);
+
+    return true;
+}
+
+
+void
+GameFleet::ExpireHosts(std::chrono::steady_clock::time_point now)
+{
+    std::lock_guard<std::mutex> l(_hostsMutex);
+    for(auto host = _hosts.begin(); host != _hosts.end();)
+    {
+        if(now - host->second.LastSeen < _config.HostTimeout)
+        {
+            ++host;
+            continue;
+        }
+
+        _logger.Warning() << "Game host " << host->first << " [" << host->second.Stats.Control
+                          << "] missed heartbeats, dropped";
+        host = _hosts.erase(host);
+    }
+}
@@ -0,0 +1,172 @@
+//
+//  game_fleet.hpp
+//  labyrinth_server
+//
+
+#ifndef game_fleet_hpp
+#define game_fleet_hpp
+
+#include "GameServersController.hpp"
+#include "HostMessage.h"
+#include "services/storage_backend.hpp"
+#include "toolkit/named_logger.hpp"
+#include "toolkit/optional.hpp"
+#include "toolkit/rate_limited_log.hpp"
+
+#include <Poco/Net/DatagramSocket.h>
+#include <Poco/Net/SocketAddress.h>
+#include <Poco/Runnable.h>
+#include <Poco/Thread.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+
+    // where players of a match have to connect
+struct GameEndpoint
+{
+    std::string Host;   // empty - the master's own host
+    uint16_t    Port;
+};
+
+
+/*
+ * Game servers of every process known to the master.
+ * Game host processes (see GameHost) register over a UDP control channel with their first heartbeat
+ * and keep reporting free capacity, a host which missed heartbeats for HostTimeout is dropped.
+ * Every match goes to the least loaded process with free capacity (see PlacementScore): live tick
+ * utilization per core, tick overruns and players decide, so busy hosts get no new matches.
+ * Results of matches played on hosts are sent back and recorded here. They are accepted only from
+ * the control address a host registered from, and acknowledged by record id (the host resends until then).
+ * Heartbeats have to carry the fleet's HostKey. A registered host keeps its control address and public
+ * host until it times out, heartbeats of the same host id from elsewhere are dropped.
+ */
+class GameFleet : public Poco::Runnable
+{
+public:
+    struct Configuration
+    {
+        Poco::Net::SocketAddress    ControlAddress;
+        bool                        LocalServers;   // false - the master only coordinates hosts
+        std::chrono::milliseconds   HostTimeout;
+        std::chrono::milliseconds   RequestTimeout; // StartLobby answer from a host
+        uint32_t                    HostKey;        // shared with game hosts, 0 - not set
+    };
+
+    struct HostStats
+    {
+        uint32_t    HostId;
+        std::string Control;
+        std::string PublicHost;
+        uint16_t    Capacity;
+        uint16_t    Standby;
+        uint16_t    Lobbies;
+        uint16_t    Games;
+        uint16_t    Cores;
+        uint16_t    Players;
+        uint32_t    Utilization;    // see GameServersController::Stats
+        uint16_t    Overruns;
+    };
+
+public:
+    /*
+     * Has to be called before the fleet is created.
+     */
+    static void Configure(const Configuration& config)
+    { _config = config; }
+
+    GameFleet();
+    ~GameFleet();
+
+    /*
+     * Backfill works with the master's own servers only, empty if there are none.
+     */
+    std::experimental::optional<GameEndpoint> TakeFreedSeat();
+
+    /*
+     * Empty if every process is busy. Blocks for at most RequestTimeout per asked host.
+     */
+    std::experimental::optional<GameEndpoint> StartLobby(uint16_t players);
+
+    std::vector<HostStats> GetHosts() const;
+
+        // nullptr if the master does not run game servers
+    GameServersController * GetLocalServers()
+    { return _local.get(); }
+
+        // control channel receive loop
+    virtual void run() override;
+
+private:
+        // reasons of dropped control packets
+    enum DroppedPacket
+    {
+        UNKNOWN_MATCH_SENDER,
+        INVALID_HOST_KEY,
+        MOVED_HOST,
+        UNKNOWN_LOBBY_SENDER
+    };
+
+    struct Host
+    {
+        HostStats                               Stats;
+        Poco::Net::SocketAddress                Control;
+        std::chrono::steady_clock::time_point   LastSeen;
+        std::set<uint32_t>                      Recorded;   // latest record ids, resends are acked only
+    };
+
+    struct LobbyRequest
+    {
+        Poco::Net::SocketAddress                Control;    // only this host may answer
+        std::experimental::optional<uint16_t>   Port;       // empty until answered
+    };
+
+    static void ReportMatch(const DBQuery::MatchRecord& match);
+
+        // lower is better, 1.0 is a process whose cores are busy with ticks all the time
+    static double PlacementScore(const HostStats& stats);
+    HostStats LocalStats() const;
+
+    std::experimental::optional<uint16_t> RequestLobby(const Poco::Net::SocketAddress& control,
+                                                       uint16_t players);
+
+    void OnHeartbeat(const Poco::Net::SocketAddress& sender,
+                     const HostMessage::HostHeartbeat* heartbeat);
+        // false if the sender is not the host the request went to
+    bool OnLobbyStarted(const Poco::Net::SocketAddress& sender,
+                        const HostMessage::LobbyStarted* started);
+        // false if the sender is not a registered host
+    bool OnMatchFinished(const Poco::Net::SocketAddress& sender,
+                         const HostMessage::MatchFinished* finished);
+    void ExpireHosts(std::chrono::steady_clock::time_point now);
+
+private:
+    static Configuration                        _config;
+
+    NamedLogger                                 _logger;
+    Poco::Net::DatagramSocket                   _socket;
+    RateLimitedLog                              _dropped;       // receive thread only
+
+    std::unique_ptr<GameServersController>      _local;
+
+    mutable std::mutex                          _hostsMutex;
+    std::map<uint32_t, Host>                    _hosts;     // by host id
+
+        // StartLobby requests waiting for LobbyStarted
+    std::mutex                                  _requestsMutex;
+    std::condition_variable                     _answered;
+    std::map<uint32_t, LobbyRequest>            _requests;
+    uint32_t                                    _lastRequestId;
+
+    std::atomic<bool>                           _running;
+    Poco::Thread                                _receiver;
+};
+
+#endif /* game_fleet_hpp */
@@ -0,0 +1,226 @@
+//
+//  gamehost.cpp
+//  labyrinth_server
+//
+
+#include "gamehost.hpp"
+
+#include <Poco/Environment.h>
+#include <Poco/Timespan.h>
+
+#include <random>
+
+using namespace HostMessage;
+
+
+GameHost::Configuration GameHost::_config = { Poco::Net::SocketAddress("127.0.0.1", 1929), std::string(),
+                                              std::chrono::milliseconds(1000), 0 };
+
+
+GameHost::GameHost()
+: _logger("GameHost", NamedLogger::Mode::STDIO),
+  _hostId(0),
+  _registered(false),
+  _running(true),
+  _lastRecordId(0)
+{
+    std::random_device random;
+    while(_hostId == 0)
+        _hostId = random();
+
+    _socket.bind(Poco::Net::SocketAddress(Poco::Net::IPAddress(), 0));
+    _servers = std::make_unique<GameServersController>([this](const DBQuery::MatchRecord& match)
+                                                       {
+                                                           SendMatch(match);
+                                                       });
+
+    LOG_INFO(_logger) << "Game host " << _hostId << " reports to " << _config.Master.toString();
+}
+
+
+GameHost::~GameHost()
+{
+    _servers.reset();
+}
+
+
+void
+GameHost::run()
+{
+    SafePacketGetter packetGetter(_socket);
+    Packet packet;
+    auto nextHeartbeat = std::chrono::steady_clock::now();
+    while(_running)
+    {
+        auto now = std::chrono::steady_clock::now();
+        if(now >= nextHeartbeat)
+        {
+            SendHeartbeat();
+            ResendMatches();
+            nextHeartbeat = now + _config.HeartbeatInterval;
+        }
+
+        packetGetter.FlushWarnings();
+        Receive(packetGetter, packet);
+    }
+
+    LOG_INFO(_logger) << "Stopping game servers";
+    _servers.reset();
+
+        // results sent while servers were stopping are waited for as well
+    ResendMatches();
+    auto deadline = std::chrono::steady_clock::now() + _config.HeartbeatInterval;
+    while(Unacknowledged() && std::chrono::steady_clock::now() < deadline)
+        Receive(packetGetter, packet);
+
+    if(auto lost = Unacknowledged())
+        _logger.Warning() << lost << " match results were not acknowledged by the master and are lost";
+
+    LOG_INFO(_logger) << "Game host " << _hostId << " stopped";
+}
+
+
+void
+GameHost::Receive(SafePacketGetter& packetGetter, Packet& packet)
+{
+    if(!_socket.poll(Poco::Timespan(0, 100000), Poco::Net::Socket::SELECT_READ))
+        return;
+    if(!packetGetter.Get<HostMessage::Message>(packet))
+        return;
+
+        // control channel is trusted, but only the master may use it
+    if(packet.Sender != _config.Master)
+        return;
+
+    auto msg = GetMessage(packet.Data.data());
+    switch(msg->payload_type())
+    {
+    case Messages_HostRegistered:
+        if(!_registered)
+            LOG_INFO(_logger) << "Registered with the master";
+        _registered = true;
+        break;
+
+    case Messages_StartLobby:
+        StartLobby(static_cast<const HostMessage::StartLobby*>(msg->payload()));
+        break;
+
+    case Messages_MatchRecorded:
+    {
+        std::lock_guard<std::mutex> l(_matchesMutex);
+        _unacked.erase(static_cast<const MatchRecorded*>(msg->payload())->record_id());
+        break;
+    }
+
+    default:
+        _logger.Warning() << "Undefined control packet from the master";
+        break;
+    }
+}
+
+
+void
+GameHost::SendHeartbeat()
+{
+    auto stats = _servers->GetStats();
+
+    flatbuffers::FlatBufferBuilder builder;
+    auto heartbeat = CreateHostHeartbeat(builder,
+                                         _hostId,
+                                         builder.CreateString(_config.PublicHost),
+                                         static_cast<uint16_t>(stats.Workers),
+                                         static_cast<uint16_t>(stats.Warm),
+                                         static_cast<uint16_t>(stats.Lobbies),
+                                         static_cast<uint16_t>(stats.Games),
+                                         static_cast<uint16_t>(Poco::Environment::processorCount()),
+                                         static_cast<uint16_t>(stats.Players),
+                                         stats.Utilization,
+                                         stats.Overruns,
+                                         _config.HostKey);
+    builder.Finish(CreateMessage(builder,
+                                 Messages_HostHeartbeat,
+                                 heartbeat.Union()));
+    _socket.sendTo(builder.GetBufferPointer(),
+                   builder.GetSize(),
+                   _config.Master);
+}
+
+
+void
+GameHost::StartLobby(const HostMessage::StartLobby* request)
+{
+        // servers are gone while the host stops
+    auto port = _servers ? _servers->StartLobby(request->players()) : std::experimental::optional<uint16_t>();
+    if(!port)
+        _logger.Warning() << "Master asked for a lobby, but every server is busy";
+
+    flatbuffers::FlatBufferBuilder builder;
+    auto started = CreateLobbyStarted(builder,
+                                      request->request_id(),
+                                      port ? *port : 0);
+    builder.Finish(CreateMessage(builder,
+                                 Messages_LobbyStarted,
+                                 started.Union()));
+    _socket.sendTo(builder.GetBufferPointer(),
+                   builder.GetSize(),
+                   _config.Master);
+}
+
+
+void
+GameHost::SendMatch(const DBQuery::MatchRecord& match)
+{
+    std::lock_guard<std::mutex> l(_matchesMutex);
+
+    flatbuffers::FlatBufferBuilder builder;
+
+    std::vector<flatbuffers::Offset<MatchPlayer>> players;
+    players.reserve(match.Players.size());
+    for(auto& player : match.Players)
+        players.push_back(CreateMatchPlayer(builder,
+                                            builder.CreateString(player.Name),
+                                            player.Hero,
+                                            player.Kills,
+                                            player.Deaths,
+                                            player.Winner));
+
+    auto recordId = ++_lastRecordId;
+    auto finished = CreateMatchFinished(builder,
+                                        recordId,
+                                        _hostId,
+                                        match.Server,
+                                        match.RandomSeed,
+                                        match.StartedAt,
+                                        match.DurationMs,
+                                        match.Finished,
+                                        builder.CreateVector(players));
+    builder.Finish(CreateMessage(builder,
+                                 Messages_MatchFinished,
+                                 finished.Union()));
+
+        // kept until the master acks it, sendto is safe from several threads
+    auto& packet = _unacked[recordId];
+    packet.assign(builder.GetBufferPointer(), builder.GetBufferPointer() + builder.GetSize());
+    _socket.sendTo(packet.data(),
+                   packet.size(),
+                   _config.Master);
+}
+
+
+void
+GameHost::ResendMatches()
+{
+    std::lock_guard<std::mutex> l(_matchesMutex);
+    for(auto& match : _unacked)
+        _socket.sendTo(match.second.data(),
+                       match.second.size(),
+                       _config.Master);
+}
+
+
+size_t
+GameHost::Unacknowledged()
+{
+    std::lock_guard<std::mutex> l(_matchesMutex);
+    return _unacked.size();
+}
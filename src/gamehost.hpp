@@ -0,0 +1,91 @@
+//
+//  gamehost.hpp
+//  labyrinth_server
+//
+
+#ifndef gamehost_hpp
+#define gamehost_hpp
+
+#include "GameServersController.hpp"
+#include "HostMessage.h"
+#include "services/storage_backend.hpp"
+#include "toolkit/SafePacketGetter.hpp"
+#include "toolkit/named_logger.hpp"
+
+#include <Poco/Net/DatagramSocket.h>
+#include <Poco/Net/SocketAddress.h>
+#include <Poco/Runnable.h>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+/*
+ * Game host process: runs game servers for a master which lives in another process or node.
+ * Registers with the master by heartbeats over the control channel (see GameFleet), starts lobbies
+ * on its request and sends results of played matches back, the host itself has no database.
+ * A result is resent every heartbeat interval until the master acknowledges its record id.
+ */
+class GameHost : public Poco::Runnable
+{
+public:
+    struct Configuration
+    {
+        Poco::Net::SocketAddress    Master;             // control address of the master
+        std::string                 PublicHost;         // empty - players use the master's host
+        std::chrono::milliseconds   HeartbeatInterval;
+        uint32_t                    HostKey;            // has to match the master's one
+    };
+
+public:
+    /*
+     * Has to be called before the host is created.
+     */
+    static void Configure(const Configuration& config)
+    { _config = config; }
+
+    GameHost();
+    ~GameHost();
+
+    virtual void run() override;
+
+    /*
+     * Makes run() return: game servers are torn down, results the master has not acknowledged yet
+     * get one more heartbeat interval. Only sets a flag, safe to call from a signal handler.
+     */
+    void Stop()
+    { _running = false; }
+
+private:
+    void Receive(SafePacketGetter& packetGetter, Packet& packet);
+    void SendHeartbeat();
+    void StartLobby(const HostMessage::StartLobby* request);
+
+        // called from game server threads
+    void SendMatch(const DBQuery::MatchRecord& match);
+    void ResendMatches();
+    size_t Unacknowledged();
+
+private:
+    static Configuration                        _config;
+
+    NamedLogger                                 _logger;
+    uint32_t                                    _hostId;
+    bool                                        _registered;
+    std::atomic<bool>                           _running;
+    Poco::Net::DatagramSocket                   _socket;
+
+        // encoded MatchFinished by record id, until MatchRecorded comes
+    std::mutex                                  _matchesMutex;
+    std::map<uint32_t, std::vector<uint8_t>>    _unacked;
+    uint32_t                                    _lastRecordId;
+
+    std::unique_ptr<GameServersController>      _servers;
+};
+
+#endif /* gamehost_hpp */
@@ -86,6 +86,8 @@ struct CLPing;
 
 struct SVPing;
 
+struct SVUnitVisibility;
+
 struct Message;
 
 enum ConnectionStatus {
@@ -327,8 +329,9 @@ enum Messages {
     Messages_SVGameEnd = 29,
     Messages_CLPing = 30,
     Messages_SVPing = 31,
+    Messages_SVUnitVisibility = 32,
     Messages_MIN = Messages_NONE,
-    Messages_MAX = Messages_SVPing
+    Messages_MAX = Messages_SVUnitVisibility
 };
 
 inline const char **EnumNamesMessages() {
@@ -365,6 +368,7 @@ inline const char **EnumNamesMessages() {
         "SVGameEnd",
         "CLPing",
         "SVPing",
+        "SVUnitVisibility",
         nullptr
     };
     return names;
@@ -503,6 +507,10 @@ template<> struct MessagesTraits<SVPing> {
     static const Messages enum_value = Messages_SVPing;
 };
 
+template<> struct MessagesTraits<SVUnitVisibility> {
+    static const Messages enum_value = Messages_SVUnitVisibility;
+};
+
 bool VerifyMessages(flatbuffers::Verifier &verifier, const void *obj, Messages type);
 bool VerifyMessagesVector(flatbuffers::Verifier &verifier, const flatbuffers::Vector<flatbuffers::Offset<void>> *values, const flatbuffers::Vector<uint8_t> *types);
 
@@ -2521,6 +2529,96 @@ inline flatbuffers::Offset<SVPing> CreateSVPing(
     return builder_.Finish();
 }
 
+struct SVUnitVisibility FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+    enum {
+        VT_TARGET_UID = 4,
+        VT_VISIBLE = 6,
+        VT_X = 8,
+        VT_Y = 10,
+        VT_HP = 12,
+        VT_MAX_HP = 14
+    };
+    uint32_t target_uid() const {
+        return GetField<uint32_t>(VT_TARGET_UID, 0);
+    }
+    bool visible() const {
+        return GetField<uint8_t>(VT_VISIBLE, 0) != 0;
+    }
+    uint16_t x() const {
+        return GetField<uint16_t>(VT_X, 0);
+    }
+    uint16_t y() const {
+        return GetField<uint16_t>(VT_Y, 0);
+    }
+    uint16_t hp() const {
+        return GetField<uint16_t>(VT_HP, 0);
+    }
+    uint16_t max_hp() const {
+        return GetField<uint16_t>(VT_MAX_HP, 0);
+    }
+    bool Verify(flatbuffers::Verifier &verifier) const {
+        return VerifyTableStart(verifier) &&
+        VerifyField<uint32_t>(verifier, VT_TARGET_UID) &&
+        VerifyField<uint8_t>(verifier, VT_VISIBLE) &&
+        VerifyField<uint16_t>(verifier, VT_X) &&
+        VerifyField<uint16_t>(verifier, VT_Y) &&
+        VerifyField<uint16_t>(verifier, VT_HP) &&
+        VerifyField<uint16_t>(verifier, VT_MAX_HP) &&
+        verifier.EndTable();
+    }
+};
+
+struct SVUnitVisibilityBuilder {
+    flatbuffers::FlatBufferBuilder &fbb_;
+    flatbuffers::uoffset_t start_;
+    void add_target_uid(uint32_t target_uid) {
+        fbb_.AddElement<uint32_t>(SVUnitVisibility::VT_TARGET_UID, target_uid, 0);
+    }
+    void add_visible(bool visible) {
+        fbb_.AddElement<uint8_t>(SVUnitVisibility::VT_VISIBLE, static_cast<uint8_t>(visible), 0);
+    }
+    void add_x(uint16_t x) {
+        fbb_.AddElement<uint16_t>(SVUnitVisibility::VT_X, x, 0);
+    }
+    void add_y(uint16_t y) {
+        fbb_.AddElement<uint16_t>(SVUnitVisibility::VT_Y, y, 0);
+    }
+    void add_hp(uint16_t hp) {
+        fbb_.AddElement<uint16_t>(SVUnitVisibility::VT_HP, hp, 0);
+    }
+    void add_max_hp(uint16_t max_hp) {
+        fbb_.AddElement<uint16_t>(SVUnitVisibility::VT_MAX_HP, max_hp, 0);
+    }
+    SVUnitVisibilityBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+    : fbb_(_fbb) {
+        start_ = fbb_.StartTable();
+    }
+    SVUnitVisibilityBuilder &operator=(const SVUnitVisibilityBuilder &);
+    flatbuffers::Offset<SVUnitVisibility> Finish() {
+        const auto end = fbb_.EndTable(start_, 6);
+        auto o = flatbuffers::Offset<SVUnitVisibility>(end);
+        return o;
+    }
+};
+
+inline flatbuffers::Offset<SVUnitVisibility> CreateSVUnitVisibility(
+                                                                flatbuffers::FlatBufferBuilder &_fbb,
+                                                                uint32_t target_uid = 0,
+                                                                bool visible = false,
+                                                                uint16_t x = 0,
+                                                                uint16_t y = 0,
+                                                                uint16_t hp = 0,
+                                                                uint16_t max_hp = 0) {
+    SVUnitVisibilityBuilder builder_(_fbb);
+    builder_.add_target_uid(target_uid);
+    builder_.add_max_hp(max_hp);
+    builder_.add_hp(hp);
+    builder_.add_y(y);
+    builder_.add_x(x);
+    builder_.add_visible(visible);
+    return builder_.Finish();
+}
+
 struct Message FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
     enum {
         VT_SENDER_UID = 4,
@@ -2772,6 +2870,10 @@ inline bool VerifyMessages(flatbuffers::Verifier &verifier, const void *obj, Mes
             auto ptr = reinterpret_cast<const SVPing *>(obj);
             return verifier.VerifyTable(ptr);
         }
+        case Messages_SVUnitVisibility: {
+            auto ptr = reinterpret_cast<const SVUnitVisibility *>(obj);
+            return verifier.VerifyTable(ptr);
+        }
         default: return false;
     }
 }
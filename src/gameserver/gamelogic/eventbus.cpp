@@ -0,0 +1,346 @@
+//
+//  eventbus.cpp
+//  labyrinth_server
+//
+
+#include "eventbus.hpp"
+
+using namespace GameMessage;
+
+
+WorldEvent
+WorldEvent::SpawnItem(uint32_t uid, ItemType type, uint16_t x, uint16_t y)
+{
+    WorldEvent event {};
+    event.EventType = Type::SPAWN_ITEM;
+    event.Spawn = { uid, static_cast<uint8_t>(type), x, y };
+    return event;
+}
+
+
+WorldEvent
+WorldEvent::SpawnConstr(uint32_t uid, ConstrType type, uint16_t x, uint16_t y)
+{
+    WorldEvent event {};
+    event.EventType = Type::SPAWN_CONSTR;
+    event.Spawn = { uid, static_cast<uint8_t>(type), x, y };
+    return event;
+}
+
+
+WorldEvent
+WorldEvent::SpawnPlayer(uint32_t uid, uint16_t x, uint16_t y)
+{
+    WorldEvent event {};
+    event.EventType = Type::SPAWN_PLAYER;
+    event.Spawn = { uid, 0, x, y };
+    return event;
+}
+
+
+WorldEvent
+WorldEvent::RespawnPlayer(uint32_t uid, uint16_t x, uint16_t y)
+{
+    WorldEvent event {};
+    event.EventType = Type::RESPAWN_PLAYER;
+    event.Spawn = { uid, 0, x, y };
+    return event;
+}
+
+
+WorldEvent
+WorldEvent::SpawnMonster(uint32_t uid, uint16_t x, uint16_t y)
+{
+    WorldEvent event {};
+    event.EventType = Type::SPAWN_MONSTER;
+    event.Spawn = { uid, 0, x, y };
+    return event;
+}
+
+
+WorldEvent
+WorldEvent::ActionMove(uint32_t uid, int8_t direction, uint16_t x, uint16_t y)
+{
+    WorldEvent event {};
+    event.EventType = Type::ACTION_MOVE;
+    event.Move = { uid, direction, x, y };
+    return event;
+}
+
+
+WorldEvent
+WorldEvent::ActionItem(uint32_t playerUid, uint16_t itemUid, ActionItemType action)
+{
+    WorldEvent event {};
+    event.EventType = Type::ACTION_ITEM;
+    event.Item = { playerUid, itemUid, action };
+    return event;
+}
+
+
+WorldEvent
+WorldEvent::ActionDuel(uint32_t firstUid, uint32_t secondUid, ActionDuelType action)
+{
+    WorldEvent event {};
+    event.EventType = Type::ACTION_DUEL;
+    event.Duel = { firstUid, secondUid, action };
+    return event;
+}
+
+
+WorldEvent
+WorldEvent::ActionDeath(uint32_t uid, uint32_t killerUid)
+{
+    WorldEvent event {};
+    event.EventType = Type::ACTION_DEATH;
+    event.Death = { uid, killerUid };
+    return event;
+}
+
+
+WorldEvent
+WorldEvent::ActionSpell(uint32_t casterUid, uint16_t spellId)
+{
+    WorldEvent event {};
+    event.EventType = Type::ACTION_SPELL;
+    event.Spell = { casterUid, spellId, Spells_NONE, 0, 0, 0, 0 };
+    return event;
+}
+
+
+WorldEvent
+WorldEvent::SpellOnTarget(uint32_t casterUid, uint16_t spellId, Spells spell, uint32_t targetUid, uint16_t damage)
+{
+    WorldEvent event {};
+    event.EventType = Type::ACTION_SPELL;
+    event.Spell = { casterUid, spellId, spell, targetUid, damage, 0, 0 };
+    return event;
+}
+
+
+WorldEvent
+WorldEvent::SpellOnPoint(uint32_t casterUid, uint16_t spellId, Spells spell, uint16_t x, uint16_t y)
+{
+    WorldEvent event {};
+    event.EventType = Type::ACTION_SPELL;
+    event.Spell = { casterUid, spellId, spell, 0, 0, x, y };
+    return event;
+}
+
+
+WorldEvent
+WorldEvent::GameEnd(uint32_t winnerUid)
+{
+    WorldEvent event {};
+    event.EventType = Type::GAME_END;
+    event.End = { winnerUid };
+    return event;
+}
+
+
+WorldEvent
+WorldEvent::UnitVisibility(uint32_t recipientUid, const VisibilityData& state)
+{
+    WorldEvent event {};
+    event.EventType = Type::UNIT_VISIBILITY;
+    event.Origin.EventScope = OriginData::Scope::DIRECT;
+    event.Origin.Uid = state.Uid;
+    event.Origin.X = state.X;
+    event.Origin.Y = state.Y;
+    event.Origin.Recipient = recipientUid;
+    event.Visibility = state;
+    return event;
+}
+
+
+EventBus::EventBus(size_t reservedEvents)
+: _builder(512)
+{
+    _events.reserve(reservedEvents);
+    _packetsIndex.reserve(reservedEvents);
+    _packetsData.reserve(reservedEvents * 64);
+}
+
+
+void
+EventBus::Serialize()
+{
+    for(auto& event : _events)
+    {
+        _builder.Clear();
+        Encode(event);
+
+        PacketInfo info;
+        info.Offset = _packetsData.size();
+        info.Size = _builder.GetSize();
+        info.Origin = event.Origin;
+        info.RelatedUid = 0;
+        if(event.EventType == WorldEvent::Type::ACTION_SPELL)
+            info.RelatedUid = event.Spell.TargetUid;
+        else if(event.EventType == WorldEvent::Type::ACTION_DUEL)
+            info.RelatedUid = event.Duel.SecondUid;
+        _packetsIndex.push_back(info);
+
+        _packetsData.insert(_packetsData.end(),
+                            _builder.GetBufferPointer(),
+                            _builder.GetBufferPointer() + _builder.GetSize());
+    }
+
+    _events.clear();
+}
+
+
+void
+EventBus::Encode(const WorldEvent& event)
+{
+    Messages type = Messages_NONE;
+    flatbuffers::Offset<void> payload;
+
+    switch(event.EventType)
+    {
+    case WorldEvent::Type::SPAWN_ITEM:
+        type = Messages_SVSpawnItem;
+        payload = CreateSVSpawnItem(_builder,
+                                    event.Spawn.Uid,
+                                    static_cast<ItemType>(event.Spawn.Subtype),
+                                    event.Spawn.X,
+                                    event.Spawn.Y).Union();
+        break;
+
+    case WorldEvent::Type::SPAWN_CONSTR:
+        type = Messages_SVSpawnConstr;
+        payload = CreateSVSpawnConstr(_builder,
+                                      event.Spawn.Uid,
+                                      static_cast<ConstrType>(event.Spawn.Subtype),
+                                      event.Spawn.X,
+                                      event.Spawn.Y).Union();
+        break;
+
+    case WorldEvent::Type::SPAWN_PLAYER:
+        type = Messages_SVSpawnPlayer;
+        payload = CreateSVSpawnPlayer(_builder,
+                                      event.Spawn.Uid,
+                                      event.Spawn.X,
+                                      event.Spawn.Y).Union();
+        break;
+
+    case WorldEvent::Type::RESPAWN_PLAYER:
+        type = Messages_SVRespawnPlayer;
+        payload = CreateSVRespawnPlayer(_builder,
+                                        event.Spawn.Uid,
+                                        event.Spawn.X,
+                                        event.Spawn.Y).Union();
+        break;
+
+    case WorldEvent::Type::SPAWN_MONSTER:
+        type = Messages_SVSpawnMonster;
+        payload = CreateSVSpawnMonster(_builder,
+                                       event.Spawn.Uid,
+                                       event.Spawn.X,
+                                       event.Spawn.Y).Union();
+        break;
+
+    case WorldEvent::Type::ACTION_MOVE:
+        type = Messages_SVActionMove;
+        payload = CreateSVActionMove(_builder,
+                                     event.Move.Uid,
+                                     event.Move.Direction,
+                                     event.Move.X,
+                                     event.Move.Y).Union();
+        break;
+
+    case WorldEvent::Type::ACTION_ITEM:
+        type = Messages_SVActionItem;
+        payload = CreateSVActionItem(_builder,
+                                     event.Item.PlayerUid,
+                                     event.Item.ItemUid,
+                                     event.Item.Action).Union();
+        break;
+
+    case WorldEvent::Type::ACTION_DUEL:
+        type = Messages_SVActionDuel;
+        payload = CreateSVActionDuel(_builder,
+                                     event.Duel.FirstUid,
+                                     event.Duel.SecondUid,
+                                     event.Duel.Action).Union();
+        break;
+
+    case WorldEvent::Type::ACTION_DEATH:
+        type = Messages_SVActionDeath;
+        payload = CreateSVActionDeath(_builder,
+                                      event.Death.Uid,
+                                      event.Death.KillerUid).Union();
+        break;
+
+    case WorldEvent::Type::ACTION_SPELL:
+    {
+        flatbuffers::Offset<Spell> spellInfo;
+        flatbuffers::Offset<void> spellPayload;
+
+        switch(event.Spell.Spell)
+        {
+        case Spells_MageAttack:
+            spellPayload = CreateMageAttack(_builder,
+                                            event.Spell.TargetUid,
+                                            event.Spell.Damage).Union();
+            break;
+        case Spells_MageTeleport:
+            spellPayload = CreateMageTeleport(_builder,
+                                              event.Spell.X,
+                                              event.Spell.Y).Union();
+            break;
+        case Spells_MageFreeze:
+            spellPayload = CreateMageFreeze(_builder,
+                                            event.Spell.TargetUid).Union();
+            break;
+        case Spells_WarriorAttack:
+            spellPayload = CreateWarriorAttack(_builder,
+                                               event.Spell.TargetUid,
+                                               event.Spell.Damage).Union();
+            break;
+        case Spells_MonsterAttack:
+            spellPayload = CreateMonsterAttack(_builder,
+                                               event.Spell.TargetUid,
+                                               event.Spell.Damage).Union();
+            break;
+        default:
+            break;
+        }
+
+        if(event.Spell.Spell != Spells_NONE)
+            spellInfo = CreateSpell(_builder,
+                                    event.Spell.Spell,
+                                    spellPayload);
+
+        type = Messages_SVActionSpell;
+        payload = CreateSVActionSpell(_builder,
+                                      event.Spell.CasterUid,
+                                      event.Spell.SpellId,
+                                      spellInfo).Union();
+        break;
+    }
+
+    case WorldEvent::Type::GAME_END:
+        type = Messages_SVGameEnd;
+        payload = CreateSVGameEnd(_builder,
+                                  event.End.WinnerUid).Union();
+        break;
+
+    case WorldEvent::Type::UNIT_VISIBILITY:
+        type = Messages_SVUnitVisibility;
+        payload = CreateSVUnitVisibility(_builder,
+                                         event.Visibility.Uid,
+                                         event.Visibility.Visible,
+                                         event.Visibility.X,
+                                         event.Visibility.Y,
+                                         event.Visibility.Hp,
+                                         event.Visibility.MaxHp).Union();
+        break;
+    }
+
+    auto msg = CreateMessage(_builder,
+                             0,
+                             type,
+                             payload);
+    _builder.Finish(msg);
+}
@@ -0,0 +1,222 @@
+//
+//  eventbus.hpp
+//  labyrinth_server
+//
+
+#ifndef eventbus_hpp
+#define eventbus_hpp
+
+#include "../GameMessage.h"
+
+#include <cstdint>
+#include <vector>
+
+
+/*
+ * Small POD description of a world event. Gameplay code fills it in place,
+ * actual flatbuffers encoding is deferred until EventBus::Serialize().
+ */
+struct WorldEvent
+{
+    enum class Type : uint8_t
+    {
+        SPAWN_ITEM,
+        SPAWN_CONSTR,
+        SPAWN_PLAYER,
+        RESPAWN_PLAYER,
+        SPAWN_MONSTER,
+        ACTION_MOVE,
+        ACTION_ITEM,
+        ACTION_DUEL,
+        ACTION_DEATH,
+        ACTION_SPELL,
+        GAME_END,
+        UNIT_VISIBILITY
+    };
+
+    struct SpawnData
+    {
+        uint32_t    Uid;
+        uint8_t     Subtype; // ItemType or ConstrType, unused for units
+        uint16_t    X;
+        uint16_t    Y;
+    };
+
+    struct MoveData
+    {
+        uint32_t    Uid;
+        int8_t      Direction;
+        uint16_t    X;
+        uint16_t    Y;
+    };
+
+    struct ItemData
+    {
+        uint32_t                        PlayerUid;
+        uint16_t                        ItemUid;
+        GameMessage::ActionItemType     Action;
+    };
+
+    struct DuelData
+    {
+        uint32_t                        FirstUid;
+        uint32_t                        SecondUid;
+        GameMessage::ActionDuelType     Action;
+    };
+
+    struct DeathData
+    {
+        uint32_t    Uid;
+        uint32_t    KillerUid;
+    };
+
+    struct SpellData
+    {
+        uint32_t                CasterUid;
+        uint16_t                SpellId;
+        GameMessage::Spells     Spell;      // Spells_NONE means no spell_info
+        uint32_t                TargetUid;
+        uint16_t                Damage;
+        uint16_t                X;
+        uint16_t                Y;
+    };
+
+    struct GameEndData
+    {
+        uint32_t    WinnerUid;
+    };
+
+    struct VisibilityData
+    {
+        uint32_t    Uid;
+        bool        Visible;    // entered the area of interest, the rest is its current state
+        uint16_t    X;
+        uint16_t    Y;
+        uint16_t    Hp;
+        uint16_t    MaxHp;
+    };
+
+        // Who produced the event, used to pick recipients
+    struct OriginData
+    {
+        enum class Scope : uint8_t
+        {
+            GLOBAL, // everyone has to know (spawns, deaths, game end)
+            LOCAL,  // only players who can perceive the source
+            DIRECT  // only Recipient
+        };
+
+        Scope       EventScope;
+        bool        Visible;
+        uint32_t    Uid;
+        uint16_t    X;
+        uint16_t    Y;
+        uint32_t    Recipient;
+    };
+
+public:
+    static WorldEvent SpawnItem(uint32_t uid, GameMessage::ItemType type, uint16_t x, uint16_t y);
+    static WorldEvent SpawnConstr(uint32_t uid, GameMessage::ConstrType type, uint16_t x, uint16_t y);
+    static WorldEvent SpawnPlayer(uint32_t uid, uint16_t x, uint16_t y);
+    static WorldEvent RespawnPlayer(uint32_t uid, uint16_t x, uint16_t y);
+    static WorldEvent SpawnMonster(uint32_t uid, uint16_t x, uint16_t y);
+    static WorldEvent ActionMove(uint32_t uid, int8_t direction, uint16_t x, uint16_t y);
+    static WorldEvent ActionItem(uint32_t playerUid, uint16_t itemUid, GameMessage::ActionItemType action);
+    static WorldEvent ActionDuel(uint32_t firstUid, uint32_t secondUid, GameMessage::ActionDuelType action);
+    static WorldEvent ActionDeath(uint32_t uid, uint32_t killerUid = 0);
+    static WorldEvent ActionSpell(uint32_t casterUid, uint16_t spellId);
+    static WorldEvent SpellOnTarget(uint32_t casterUid, uint16_t spellId, GameMessage::Spells spell, uint32_t targetUid, uint16_t damage = 0);
+    static WorldEvent SpellOnPoint(uint32_t casterUid, uint16_t spellId, GameMessage::Spells spell, uint16_t x, uint16_t y);
+    static WorldEvent GameEnd(uint32_t winnerUid);
+    static WorldEvent UnitVisibility(uint32_t recipientUid, const VisibilityData& state);
+
+public:
+    WorldEvent::Type    EventType;
+    OriginData          Origin;
+    union
+    {
+        SpawnData       Spawn;
+        MoveData        Move;
+        ItemData        Item;
+        DuelData        Duel;
+        DeathData       Death;
+        SpellData       Spell;
+        GameEndData     End;
+        VisibilityData  Visibility;
+    };
+};
+
+
+/*
+ * Per-tick buffer of world events.
+ * Gameplay code Push()-es events during GameWorld::update, world serializes them once at the end of a tick
+ * with single reused builder into one flat byte buffer. Storage capacity is kept between ticks, so
+ * in a steady state there are no allocations at all.
+ */
+class EventBus
+{
+public:
+    struct Packet
+    {
+        const uint8_t*          Data;
+        size_t                  Size;
+        WorldEvent::OriginData  Origin;
+        uint32_t                RelatedUid; // second participant (spell or duel target), 0 if none
+    };
+
+public:
+    EventBus(size_t reservedEvents = 256);
+
+    void Push(const WorldEvent& event)
+    { _events.push_back(event); }
+
+    /*
+     * Encodes all pushed events into packets buffer and clears events list.
+     */
+    void Serialize();
+
+    size_t PacketsCount() const
+    { return _packetsIndex.size(); }
+
+    Packet GetPacket(size_t idx) const
+    {
+        auto& info = _packetsIndex[idx];
+        return { _packetsData.data() + info.Offset, info.Size, info.Origin, info.RelatedUid };
+    }
+
+    /*
+     * Call after packets were sent, keeps capacity.
+     */
+    void ClearPackets()
+    {
+        _packetsData.clear();
+        _packetsIndex.clear();
+    }
+
+        // drops unsent events too, world is being reset
+    void Clear()
+    {
+        _events.clear();
+        ClearPackets();
+    }
+
+private:
+    struct PacketInfo
+    {
+        size_t                  Offset;
+        size_t                  Size;
+        WorldEvent::OriginData  Origin;
+        uint32_t                RelatedUid;
+    };
+
+    void Encode(const WorldEvent& event);
+
+private:
+    std::vector<WorldEvent>                         _events;
+
+    flatbuffers::FlatBufferBuilder                  _builder;
+    std::vector<uint8_t>                            _packetsData;
+    std::vector<PacketInfo>                         _packetsIndex;
+};
+
+#endif /* eventbus_hpp */
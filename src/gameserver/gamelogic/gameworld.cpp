@@ -22,13 +22,46 @@ GameWorld::GameWorld(const GameMapGenerator::Configuration& conf,
                      std::vector<PlayerInfo>& players)
 : _mapConf(conf),
   _state(State::RUNNING),
-  _objectsStorage(*this),
+  _arena(std::make_shared<RecyclingArena>()),
+  _objectsStorage(*this, _arena),
   _respawner(*this),
   _monsterSpawner(*this),
+  _visibility(conf.MapSize * conf.RoomSize + 2, conf.MapSize * conf.RoomSize + 2),
+  _interest(_visibility),
   _randGen(0, 1000, 0),
   _logger("World", NamedLogger::Mode::STDIO)
 {
-    auto map = GameMapGenerator::GenerateMap(conf);
+    Build(players);
+}
+
+
+void
+GameWorld::Reset(const GameMapGenerator::Configuration& conf,
+                 std::vector<PlayerInfo>& players)
+{
+    _state = State::RUNNING;
+    _mapConf = conf;
+
+    _respawner.Clear();
+    _monsterSpawner.Reset();
+    _objectsStorage.Clear();
+
+    std::queue<std::vector<uint8_t>>().swap(_inputMessages);
+    _eventBus.Clear();
+    _visibility.Reset(conf.MapSize * conf.RoomSize + 2, conf.MapSize * conf.RoomSize + 2);
+    _interest.Clear();
+    _scores.clear();
+    _randGen = RandomGenerator<std::mt19937, std::uniform_int_distribution<>>(0, 1000, 0);
+
+    Build(players);
+    LOG_DEBUG(_logger) << "World reused, blocks taken from heap so far: " << _arena->Allocated();
+}
+
+
+void
+GameWorld::Build(std::vector<PlayerInfo>& players)
+{
+    auto map = GameMapGenerator::GenerateMap(_mapConf);
 
         // create floor
     for(int i = map.size()-1; i >= 0; --i)
@@ -44,6 +77,8 @@ GameWorld::GameWorld(const GameMapGenerator::Configuration& conf,
     {
         for(int j = map.size()-1; j >= 0; --j)
         {
+            _visibility.SetWall(i, j, map[i][j] != GameMapGenerator::MapBlockType::NOBLOCK);
+
             if(map[i][j] == GameMapGenerator::MapBlockType::WALL)
             {
                 auto block = _objectsStorage.Create<WallBlock>();
@@ -59,6 +94,8 @@ GameWorld::GameWorld(const GameMapGenerator::Configuration& conf,
 
     for(auto& player : players)
     {
+        _scores.push_back({ player, 0, 0, false });
+
         switch(player.Hero)
         {
         case Hero::Type::WARRIOR:
@@ -83,6 +120,19 @@ GameWorld::GameWorld(const GameMapGenerator::Configuration& conf,
 }
 
 
+void
+GameWorld::CountDeath(uint32_t victimUid, const std::string& killerName)
+{
+    for(auto& score : _scores)
+    {
+        if(score.Player.LocalUid == victimUid)
+            ++score.Deaths;
+        if(score.Player.Name == killerName)
+            ++score.Kills;
+    }
+}
+
+
 void
 GameWorld::InitialSpawn()
 {
@@ -96,21 +146,12 @@ GameWorld::InitialSpawn()
         key->Spawn(GetRandomPosition());
         
             // Log key spawn event
-        _logger.Info() << "Key spawned at " << key->GetPosition();
-
-        flatbuffers::FlatBufferBuilder builder;
-        auto key_spawn = CreateSVSpawnItem(builder,
-                                           key->GetUID(),
-                                           ItemType_KEY,
-                                           key->GetPosition().x,
-                                           key->GetPosition().y);
-        auto msg = CreateMessage(builder,
-                                 0,
-                                 Messages_SVSpawnItem,
-                                 key_spawn.Union());
-        builder.Finish(msg);
-        _outputEvents.emplace(builder.GetCurrentBufferPointer(),
-                              builder.GetBufferPointer() + builder.GetSize());
+        LOG_INFO(_logger) << "Key spawned at " << key->GetPosition();
+
+        _eventBus.Push(WorldEvent::SpawnItem(key->GetUID(),
+                                             ItemType_KEY,
+                                             key->GetPosition().x,
+                                             key->GetPosition().y));
     }
     
         // spawn door
@@ -119,21 +160,12 @@ GameWorld::InitialSpawn()
         door->Spawn(GetRandomPosition());
         
             // Log key spawn event
-        _logger.Info() << "Door spawned at " << door->GetPosition();
-
-        flatbuffers::FlatBufferBuilder builder;
-        auto door_spawn = CreateSVSpawnConstr(builder,
-                                              door->GetUID(),
-                                              ConstrType_DOOR,
-                                              door->GetPosition().x,
-                                              door->GetPosition().y);
-        auto msg = CreateMessage(builder,
-                                 0,
-                                 Messages_SVSpawnConstr,
-                                 door_spawn.Union());
-        builder.Finish(msg);
-        _outputEvents.emplace(builder.GetCurrentBufferPointer(),
-                              builder.GetBufferPointer() + builder.GetSize());
+        LOG_INFO(_logger) << "Door spawned at " << door->GetPosition();
+
+        _eventBus.Push(WorldEvent::SpawnConstr(door->GetUID(),
+                                               ConstrType_DOOR,
+                                               door->GetPosition().x,
+                                               door->GetPosition().y));
     }
     
         // spawn graveyard
@@ -142,21 +174,12 @@ GameWorld::InitialSpawn()
         grave->Spawn(GetRandomPosition());
 
             // Log key spawn event
-        _logger.Info() << "Graveyard spawned at " << grave->GetPosition();
+        LOG_INFO(_logger) << "Graveyard spawned at " << grave->GetPosition();
 
-        flatbuffers::FlatBufferBuilder builder;
-        auto grave_spawn = CreateSVSpawnConstr(builder,
-                                               grave->GetUID(),
+        _eventBus.Push(WorldEvent::SpawnConstr(grave->GetUID(),
                                                ConstrType_GRAVEYARD,
                                                grave->GetPosition().x,
-                                               grave->GetPosition().y);
-        auto msg = CreateMessage(builder,
-                                 0,
-                                 Messages_SVSpawnConstr,
-                                 grave_spawn.Union());
-        builder.Finish(msg);
-        _outputEvents.emplace(builder.GetCurrentBufferPointer(),
-                              builder.GetBufferPointer() + builder.GetSize());
+                                               grave->GetPosition().y));
     }
 
         // spawn graveyard
@@ -165,24 +188,15 @@ GameWorld::InitialSpawn()
         fountain->Spawn(GetRandomPosition());
 
         // Log key spawn event
-        _logger.Info() << "Fountain spawned at " << fountain->GetPosition();
+        LOG_INFO(_logger) << "Fountain spawned at " << fountain->GetPosition();
 
-        flatbuffers::FlatBufferBuilder builder;
-        auto fount_spawn = CreateSVSpawnConstr(builder,
-                                               fountain->GetUID(),
+        _eventBus.Push(WorldEvent::SpawnConstr(fountain->GetUID(),
                                                ConstrType_FOUNTAIN,
                                                fountain->GetPosition().x,
-                                               fountain->GetPosition().y);
-        auto msg = CreateMessage(builder,
-                                 0,
-                                 Messages_SVSpawnConstr,
-                                 fount_spawn.Union());
-        builder.Finish(msg);
-        _outputEvents.emplace(builder.GetCurrentBufferPointer(),
-                              builder.GetBufferPointer() + builder.GetSize());
+                                               fountain->GetPosition().y));
     }
 
-    _logger.Info() << "Initial spawn done, total number of GameObjects: " << _objectsStorage.Size();
+    LOG_INFO(_logger) << "Initial spawn done, total number of GameObjects: " << _objectsStorage.Size();
 }
 
 void
@@ -327,22 +341,46 @@ GameWorld::update(std::chrono::microseconds delta)
         if(has_key && doors[0]->GetPosition() == unit->GetPosition())
         {
             // GAME ENDS
-            flatbuffers::FlatBufferBuilder builder;
-            auto game_end = CreateSVGameEnd(builder,
-                                            unit->GetUID());
-            auto msg = CreateMessage(builder,
-                                     0,
-                                     Messages_SVGameEnd,
-                                     game_end.Union());
-            builder.Finish(msg);
-            _outputEvents.emplace(builder.GetCurrentBufferPointer(),
-                                  builder.GetBufferPointer() + builder.GetSize());
-
-            _logger.Info() << "Player with name '" << unit->GetName() << "' won! Escaped from LABYRINTH!";
+            _eventBus.Push(WorldEvent::GameEnd(unit->GetUID()));
+            for(auto& score : _scores)
+                score.Winner = (score.Player.LocalUid == unit->GetUID());
+
+            LOG_INFO(_logger) << "Player with name '" << unit->GetName() << "' won! Escaped from LABYRINTH!";
 
             _state = State::FINISHED;
         }
     }
+
+    UpdateVisibility(units);
+    _interest.Update(units, _eventBus);
+
+        // Encode everything emitted during this tick at once
+    _eventBus.Serialize();
+}
+
+
+void
+GameWorld::UpdateVisibility(const std::vector<UnitPtr>& units)
+{
+    for(auto& unit : units)
+    {
+        auto radius = unit->GetType() == Unit::Type::MONSTER ? Monster::SIGHT_RADIUS : _interest.GetRadius();
+        _visibility.UpdateViewer(unit->GetUID(), unit->GetPosition(), radius);
+    }
+    _visibility.RemoveStaleViewers();
+}
+
+
+void
+GameWorld::EmitLocal(const GameObject& source, WorldEvent event)
+{
+    event.Origin.EventScope = WorldEvent::OriginData::Scope::LOCAL;
+    event.Origin.Visible = source.GetAttributes() & GameObject::Attributes::VISIBLE;
+    event.Origin.Uid = source.GetUID();
+    event.Origin.X = source.GetPosition().x;
+    event.Origin.Y = source.GetPosition().y;
+
+    _eventBus.Push(event);
 }
 
 
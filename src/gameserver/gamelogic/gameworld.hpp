@@ -10,7 +10,10 @@
 #define gameworld_hpp
 
 #include "construction.hpp"
+#include "eventbus.hpp"
 #include "gamemap.hpp"
+#include "interest.hpp"
+#include "visibility.hpp"
 #include "gameobject.hpp"
 #include "units/hero.hpp"
 #include "units/mage.hpp"
@@ -20,6 +23,7 @@
 #include "../../toolkit/named_logger.hpp"
 #include "../../toolkit/Random.hpp"
 #include "../../toolkit/elapsed_time.hpp"
+#include "../../toolkit/recycling_arena.hpp"
 
 #include <chrono>
 #include <list>
@@ -36,18 +40,20 @@ class GameWorld
 private:
     class ObjectsStorage
     {
-        using Storage = std::list<GameObjectPtr>;
+        using Storage = std::list<GameObjectPtr, ArenaAllocator<GameObjectPtr>>;
 
     public:
-        ObjectsStorage(GameWorld& world)
+        ObjectsStorage(GameWorld& world, const std::shared_ptr<RecyclingArena>& arena)
         : _world(world),
-          _uidSeq()
+          _arena(arena),
+          _uidSeq(),
+          _storage(ArenaAllocator<GameObjectPtr>(arena))
         { }
 
         template<typename T, typename... Args>
         std::shared_ptr<T> Create(Args&&... args)
         {
-            auto object = std::make_shared<T>(_world, _uidSeq++, std::forward<Args>(args)...);
+            auto object = std::allocate_shared<T>(ArenaAllocator<T>(_arena), _world, _uidSeq++, std::forward<Args>(args)...);
             _storage.push_back(object);
 
             return object;
@@ -66,7 +72,7 @@ private:
                                        });
             assert(is_copy == false);
 #endif
-            auto object = std::make_shared<T>(_world, uid, std::forward<Args>(args)...);
+            auto object = std::allocate_shared<T>(ArenaAllocator<T>(_arena), _world, uid, std::forward<Args>(args)...);
             _storage.push_back(object);
 
             return object;
@@ -82,6 +88,13 @@ private:
         void DeleteObject(const GameObjectPtr& obj)
         { _storage.remove(obj); }
 
+            // objects memory goes back to the arena
+        void Clear()
+        {
+            _storage.clear();
+            _uidSeq = 0;
+        }
+
         template<typename T = GameObject>
         std::vector<std::shared_ptr<T>> Subset()
         {
@@ -119,9 +132,10 @@ private:
         { return _storage.size(); }
         
     private:
-        GameWorld&                  _world;
-        uint32_t                    _uidSeq;
-        std::list<GameObjectPtr>    _storage;
+        GameWorld&                          _world;
+        std::shared_ptr<RecyclingArena>     _arena;
+        uint32_t                            _uidSeq;
+        Storage                             _storage;
     };
 
     class Respawner
@@ -162,6 +176,9 @@ private:
         void Enqueue(const UnitPtr& unit, std::chrono::microseconds respawnTime = 5s)
         { _queue.push_back(std::make_pair(respawnTime, unit)); }
 
+        void Clear()
+        { _queue.clear(); }
+
     private:
         GameWorld&                  _world;
         std::deque<QueueElement>    _queue;
@@ -185,6 +202,9 @@ private:
             }
         }
 
+        void Reset()
+        { _time.Reset(); }
+
     private:
         GameWorld&                  _world;
         ElapsedTime                 _time;
@@ -206,39 +226,75 @@ public:
         Hero::Type Hero;
     };
 
+    struct PlayerScore
+    {
+        PlayerInfo  Player;
+        uint32_t    Kills;      // heroes and monsters
+        uint32_t    Deaths;
+        bool        Winner;
+    };
+
 public:
     GameWorld(const GameMapGenerator::Configuration& conf,
               std::vector<PlayerInfo>& players);
 
+    /*
+     * Next match in the same world: everything is rebuilt, but objects memory and buffers are reused.
+     */
+    void Reset(const GameMapGenerator::Configuration& conf,
+               std::vector<PlayerInfo>& players);
+
     GameWorld::State GetState() const
     { return _state; }
 
     virtual void update(std::chrono::microseconds);
 
-    std::queue<std::vector<uint8_t>>& GetOutgoingEvents()
-    { return _outputEvents; }
+    EventBus& GetOutgoingEvents()
+    { return _eventBus; }
+
+    const InterestManager& GetInterestManager() const
+    { return _interest; }
+
+    const std::vector<PlayerScore>& GetScores() const
+    { return _scores; }
     
     void PushMessage(const std::vector<uint8_t>& message)
     { _inputMessages.push(message); }
 
 protected:
+    void Build(std::vector<PlayerInfo>& players);
+
     void ApplyInputEvents();
 
     Point<> GetRandomPosition();
+
+    /*
+     * Event that should be delivered only to players who can perceive the source object.
+     */
+    void EmitLocal(const GameObject& source, WorldEvent event);
     
     void InitialSpawn();
 
+    void UpdateVisibility(const std::vector<UnitPtr>& units);
+
+        // called by dying units, killer is known only by name
+    void CountDeath(uint32_t victimUid, const std::string& killerName);
+
 private:
     NamedLogger                         _logger;
     GameWorld::State                    _state;
     GameMapGenerator::Configuration     _mapConf;
+    std::shared_ptr<RecyclingArena>     _arena;         // objects and storage nodes, kept between matches
     ObjectsStorage                      _objectsStorage;
     Respawner                           _respawner;
     MonsterSpawner                      _monsterSpawner;
 
-    // contains outgoing events
     std::queue<std::vector<uint8_t>>    _inputMessages;
-    std::queue<std::vector<uint8_t>>    _outputEvents;
+    // contains outgoing events
+    EventBus                            _eventBus;
+    VisibilityMap                       _visibility;
+    InterestManager                     _interest;
+    std::vector<PlayerScore>            _scores;
 
     RandomGenerator<std::mt19937, std::uniform_int_distribution<>> _randGen;
 
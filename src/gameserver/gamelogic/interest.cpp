@@ -0,0 +1,116 @@
+//
+//  interest.cpp
+//  labyrinth_server
+//
+
+#include "interest.hpp"
+
+#include <algorithm>
+
+
+InterestManager::InterestManager(const VisibilityMap& visibility, float radius)
+: _visibility(visibility),
+  _radius(radius)
+{ }
+
+
+void
+InterestManager::Update(const std::vector<UnitPtr>& units, EventBus& events)
+{
+    auto state = [](const Unit& unit, bool visible)
+    {
+        auto health = unit.GetHealth();
+        return WorldEvent::VisibilityData { unit.GetUID(),
+                                            visible,
+                                            static_cast<uint16_t>(unit.GetPosition().x),
+                                            static_cast<uint16_t>(unit.GetPosition().y),
+                                            static_cast<uint16_t>(std::max<int16_t>(health, 0)),
+                                            static_cast<uint16_t>(std::max<int16_t>(health.Max(), 0)) };
+    };
+
+    for(auto& observer : _observers)
+        observer.second.Alive = false;
+
+    for(auto& unit : units)
+    {
+        if(unit->GetType() != Unit::Type::HERO)
+            continue;
+
+        auto uid = unit->GetUID();
+        auto& observer = _observers[uid];
+        observer.Alive = true;
+        observer.Position = unit->GetPosition();
+
+            // both vectors keep their capacity, only contents are swapped
+        _previous.swap(observer.Relevant);
+        observer.Relevant.clear();
+
+        for(auto& other : units)
+        {
+            auto otherUid = other->GetUID();
+            if(otherUid != uid
+               && !((other->GetAttributes() & GameObject::Attributes::VISIBLE)
+                    && other->GetPosition().Distance(observer.Position) <= _radius
+                    && _visibility.IsVisible(uid, other->GetPosition())))
+                continue;
+
+            observer.Relevant.push_back(otherUid);
+            if(otherUid != uid && !std::binary_search(_previous.begin(), _previous.end(), otherUid))
+                events.Push(WorldEvent::UnitVisibility(uid, state(*other, true)));
+        }
+        std::sort(observer.Relevant.begin(), observer.Relevant.end());
+
+            // left the set: out of sight, invisible or gone from the world
+        for(auto otherUid : _previous)
+        {
+            if(otherUid != uid && !std::binary_search(observer.Relevant.begin(), observer.Relevant.end(), otherUid))
+                events.Push(WorldEvent::UnitVisibility(uid, { otherUid, false, 0, 0, 0, 0 }));
+        }
+    }
+
+        // dead heroes watch everything until respawn, then start with an empty set again
+    for(auto iter = _observers.begin(); iter != _observers.end();)
+    {
+        if(iter->second.Alive)
+            ++iter;
+        else
+            iter = _observers.erase(iter);
+    }
+}
+
+
+bool
+InterestManager::IsInterested(uint32_t playerUid, const EventBus::Packet& packet) const
+{
+    if(packet.Origin.EventScope == WorldEvent::OriginData::Scope::GLOBAL)
+        return true;
+    if(packet.Origin.EventScope == WorldEvent::OriginData::Scope::DIRECT)
+        return packet.Origin.Recipient == playerUid;
+
+        // participants always know what happens to them
+    if(packet.Origin.Uid == playerUid || packet.RelatedUid == playerUid)
+        return true;
+
+    if(!packet.Origin.Visible)
+        return false;
+
+    auto observer = FindObserver(playerUid);
+    if(!observer) // dead heroes are not in the world, let them watch everything
+        return true;
+
+    if(std::binary_search(observer->Relevant.begin(),
+                          observer->Relevant.end(),
+                          packet.Origin.Uid))
+        return true;
+
+        // source could have changed visibility or left the world during this tick
+    return _visibility.IsVisible(playerUid, Point<>(packet.Origin.X, packet.Origin.Y));
+}
+
+
+const InterestManager::Observer*
+InterestManager::FindObserver(uint32_t uid) const
+{
+    auto iter = _observers.find(uid);
+    return iter != _observers.end() ? &iter->second : nullptr;
+}
@@ -0,0 +1,61 @@
+//
+//  interest.hpp
+//  labyrinth_server
+//
+
+#ifndef interest_hpp
+#define interest_hpp
+
+#include "eventbus.hpp"
+#include "visibility.hpp"
+#include "units/unit.hpp"
+#include "../../toolkit/Point.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+
+/*
+ * Area-of-interest filter for outgoing world events.
+ * Once per tick world calls Update() with all units, manager rebuilds relevant set (visible units inside
+ * the radius and in line of sight) for every hero. GameServer asks IsInterested() for every packet/player pair before sending.
+ * Changes of the set are events too: a unit which entered is sent to the hero with its current state,
+ * one which left is hidden, so clients keep neither stale positions nor ghosts.
+ */
+class InterestManager
+{
+public:
+    InterestManager(const VisibilityMap& visibility, float radius = 10.0);
+
+    /*
+     * Pushes UNIT_VISIBILITY events for units which entered or left relevant sets.
+     */
+    void Update(const std::vector<UnitPtr>& units, EventBus& events);
+
+    void Clear()
+    { _observers.clear(); }
+
+    bool IsInterested(uint32_t playerUid, const EventBus::Packet& packet) const;
+
+    float GetRadius() const
+    { return _radius; }
+
+private:
+    struct Observer
+    {
+        Point<>                 Position;
+        std::vector<uint32_t>   Relevant; // sorted
+        bool                    Alive;    // hero was found during the last Update
+    };
+
+    const Observer* FindObserver(uint32_t uid) const;
+
+private:
+    const VisibilityMap&                    _visibility;
+    float                                   _radius;
+    std::unordered_map<uint32_t, Observer>  _observers; // by hero uid, entries keep their capacity
+    std::vector<uint32_t>                   _previous;  // relevant set of the last tick, scratch
+};
+
+#endif /* interest_hpp */
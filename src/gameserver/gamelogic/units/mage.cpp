@@ -51,26 +51,12 @@ Mage::SpellCast(const GameMessage::CLActionSpell* spell)
         while(this->GetPosition().Distance(new_pos = _world.GetRandomPosition()) > 10.0)
         {
         }
-        
-        flatbuffers::FlatBufferBuilder builder;
-        auto spell_info = GameMessage::CreateMageTeleport(builder,
-                                                          new_pos.x,
-                                                          new_pos.y);
-        auto spell = GameMessage::CreateSpell(builder,
-                                              GameMessage::Spells_MageTeleport,
-                                              spell_info.Union());
-        auto spell1 = GameMessage::CreateSVActionSpell(builder,
-                                                       this->GetUID(),
-                                                       0,
-                                                       spell);
-        auto event = GameMessage::CreateMessage(builder,
-                                                0,
-                                                GameMessage::Messages_SVActionSpell,
-                                                spell1.Union());
-        builder.Finish(event);
-        
-        _world._outputEvents.emplace(builder.GetBufferPointer(),
-                                     builder.GetBufferPointer() + builder.GetSize());
+
+        _world.EmitLocal(*this, WorldEvent::SpellOnPoint(this->GetUID(),
+                                                         0,
+                                                         GameMessage::Spells_MageTeleport,
+                                                         new_pos.x,
+                                                         new_pos.y));
         
         SetPosition(new_pos);
     }
@@ -79,30 +65,16 @@ Mage::SpellCast(const GameMessage::CLActionSpell* spell)
             enemy && spell->spell_id() == 1 && _cdManager.SpellReady(1))
     {
             // Log damage event
-        _logger.Info() << "Attack " << enemy->GetName() << " for " << _damage;
+        BLOG_INFO(_logger, "Attack {} for {}", enemy->GetName(), _damage);
         
             // set up CD
         _cdManager.Restart(1);
-        
-        flatbuffers::FlatBufferBuilder builder;
-        auto spell_info = GameMessage::CreateMageAttack(builder,
-                                                        enemy->GetUID(),
-                                                        _damage);
-        auto spell = GameMessage::CreateSpell(builder,
-                                              GameMessage::Spells_MageAttack,
-                                              spell_info.Union());
-        auto spell1 = GameMessage::CreateSVActionSpell(builder,
-                                                       this->GetUID(),
-                                                       1,
-                                                       spell);
-        auto event = GameMessage::CreateMessage(builder,
-                                                0,
-                                                GameMessage::Messages_SVActionSpell,
-                                                spell1.Union());
-        builder.Finish(event);
 
-        _world._outputEvents.emplace(builder.GetBufferPointer(),
-                                     builder.GetBufferPointer() + builder.GetSize());
+        _world.EmitLocal(*this, WorldEvent::SpellOnTarget(this->GetUID(),
+                                                          1,
+                                                          GameMessage::Spells_MageAttack,
+                                                          enemy->GetUID(),
+                                                          _damage));
         
             // deal MAGIC damage
         DamageDescriptor dmgDescr;
@@ -116,29 +88,15 @@ Mage::SpellCast(const GameMessage::CLActionSpell* spell)
             enemy && spell->spell_id() == 2 && _cdManager.SpellReady(2))
     {
             // Log frostbolt casted
-        _logger.Info() << "Casted frostbolt on " << enemy->GetName();
+        BLOG_INFO(_logger, "Casted frostbolt on {}", enemy->GetName());
 
             // set up CD
         _cdManager.Restart(2);
-        
-        flatbuffers::FlatBufferBuilder builder;
-        auto spell1 = GameMessage::CreateMageFreeze(builder,
-                                                    enemy->GetUID());
-        auto spell = GameMessage::CreateSpell(builder,
-                                              GameMessage::Spells_MageFreeze,
-                                              spell1.Union());
-        auto cl_spell = GameMessage::CreateSVActionSpell(builder,
-                                                         this->GetUID(),
-                                                         2,
-                                                         spell);
-        auto event = GameMessage::CreateMessage(builder,
-                                                0,
-                                                GameMessage::Messages_SVActionSpell,
-                                                cl_spell.Union());
-        builder.Finish(event);
-        
-        _world._outputEvents.emplace(builder.GetBufferPointer(),
-                                     builder.GetBufferPointer() + builder.GetSize());
+
+        _world.EmitLocal(*this, WorldEvent::SpellOnTarget(this->GetUID(),
+                                                          2,
+                                                          GameMessage::Spells_MageFreeze,
+                                                          enemy->GetUID()));
         
             // apply freeze effect
         auto mageFreeze = std::make_shared<MageFreeze>(3s);
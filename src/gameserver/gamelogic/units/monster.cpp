@@ -16,6 +16,9 @@
 using namespace std::chrono_literals;
 
 
+const uint16_t Monster::SIGHT_RADIUS;
+
+
 Monster::Monster(GameWorld& world, uint32_t uid)
 : Unit(world, uid)
 {
@@ -69,9 +72,10 @@ Monster::update(std::chrono::microseconds delta)
                 if(unit->GetUID() != this->GetUID() &&
                    unit->GetType() != Unit::Type::MONSTER &&
                    unit->GetState() == Unit::State::WALKING &&
-                   unit->GetPosition().Distance(this->GetPosition()) <= 6.0)
+                   unit->GetPosition().Distance(this->GetPosition()) <= SIGHT_RADIUS &&
+                   _world._visibility.IsVisible(this->GetUID(), unit->GetPosition()))
                 {
-                    _logger.Info() << "Begin chasing " << unit->GetName();
+                    BLOG_INFO(_logger, "Begin chasing {}", unit->GetName());
                     _chasingUnit = unit;
                     targetFound = true;
                     break;
@@ -84,10 +88,10 @@ Monster::update(std::chrono::microseconds delta)
         }
 
         // check path
-        if ((*_chasingUnit)->GetPosition().Distance(this->GetPosition()) > 6.0 ||
+        if ((*_chasingUnit)->GetPosition().Distance(this->GetPosition()) > SIGHT_RADIUS ||
             (*_chasingUnit)->GetState() != Unit::State::WALKING)
         {
-            _logger.Info() << "End chasing " << (*_chasingUnit)->GetName();
+            BLOG_INFO(_logger, "End chasing {}", (*_chasingUnit)->GetName());
             _chasingUnit.reset();
             _pathToUnit.reset();
             break;
@@ -117,16 +121,19 @@ Monster::update(std::chrono::microseconds delta)
             auto path = AStar(binary_world, this->GetPosition(), (*_chasingUnit)->GetPosition());
             if (path) // path found!
             {
-                std::ostringstream path_str;
-                for(auto& pt : *path)
-                    path_str << pt;
+                if(NamedLogger::IsEnabled(NamedLogger::Level::DBG))
+                {
+                    std::ostringstream path_str;
+                    for(auto& pt : *path)
+                        path_str << pt;
 
-                _logger.Debug() << "Path found: " << path_str.str();
+                    _logger.Debug() << "Path found: " << path_str.str();
+                }
 
                 _pathToUnit = path;
             }
             else
-                _logger.Debug() << "Failed to find path";
+                BLOG_DEBUG(_logger, "Failed to find path");
         }
 
         if ((*_chasingUnit)->GetPosition().Distance(this->GetPosition()) == 1.0
@@ -168,30 +175,16 @@ Monster::update(std::chrono::microseconds delta)
                 enemy && _castSequence[0].sequence.empty())
             {
                     // Log damage event
-                _logger.Info() << "Attack " << enemy->GetName() << " for " << _damage << " physical damage";
+                BLOG_INFO(_logger, "Attack {} for {} physical damage", enemy->GetName(), _damage);
                 
                     // set up CD
                 _cdManager.Restart(0);
-                
-                flatbuffers::FlatBufferBuilder builder;
-                auto spell_info = GameMessage::CreateMonsterAttack(builder,
-                                                                   enemy->GetUID(),
-                                                                   _damage);
-                auto spell = GameMessage::CreateSpell(builder,
-                                                      GameMessage::Spells_MonsterAttack,
-                                                      spell_info.Union());
-                auto spell1 = GameMessage::CreateSVActionSpell(builder,
-                                                               this->GetUID(),
-                                                               0,
-                                                               spell);
-                auto event = GameMessage::CreateMessage(builder,
-                                                        0,
-                                                        GameMessage::Messages_SVActionSpell,
-                                                        spell1.Union());
-                builder.Finish(event);
-                
-                _world._outputEvents.emplace(builder.GetBufferPointer(),
-                                             builder.GetBufferPointer() + builder.GetSize());
+
+                _world.EmitLocal(*this, WorldEvent::SpellOnTarget(this->GetUID(),
+                                                                  0,
+                                                                  GameMessage::Spells_MonsterAttack,
+                                                                  enemy->GetUID(),
+                                                                  _damage));
                 
                     // deal PHYSICAL damage
                 auto dmgDescr = Unit::DamageDescriptor();
@@ -216,26 +209,17 @@ Monster::update(std::chrono::microseconds delta)
 void
 Monster::Spawn(const Point<>& pos)
 {
-    _logger.Info() << "Spawned at " << pos;
+    BLOG_INFO(_logger, "Spawned at {}", pos);
 
     _state = Unit::State::WALKING;
     _objAttributes = GameObject::Attributes::MOVABLE | GameObject::Attributes::VISIBLE | GameObject::Attributes::DAMAGABLE;
     _unitAttributes = Unit::Attributes::INPUT | Unit::Attributes::ATTACK | Unit::Attributes::DUELABLE;
     _health = _health.Max();
     _pos = pos;
-    
-    flatbuffers::FlatBufferBuilder builder;
-    auto spawn = GameMessage::CreateSVSpawnMonster(builder,
-                                                   this->GetUID(),
+
+    _world._eventBus.Push(WorldEvent::SpawnMonster(this->GetUID(),
                                                    pos.x,
-                                                   pos.y);
-    auto msg = GameMessage::CreateMessage(builder,
-                                          0,
-                                          GameMessage::Messages_SVSpawnMonster,
-                                          spawn.Union());
-    builder.Finish(msg);
-    _world._outputEvents.emplace(builder.GetBufferPointer(),
-                                 builder.GetBufferPointer() + builder.GetSize());
+                                                   pos.y));
 }
 
 
@@ -243,7 +227,7 @@ void
 Monster::Die(const std::string& killerName)
 {
         // Log death event
-    _logger.Info() << "Killed by " << killerName << " at " << _pos;
+    BLOG_INFO(_logger, "Killed by {} at {}", killerName, _pos);
     
     // drop items
     auto items = _inventory;
@@ -256,18 +240,9 @@ Monster::Die(const std::string& killerName)
         enemy->EndDuel();
         EndDuel();
     }
-    
-    flatbuffers::FlatBufferBuilder builder;
-    auto move = GameMessage::CreateSVActionDeath(builder,
-                                               this->GetUID(),
-                                               0);
-    auto msg = GameMessage::CreateMessage(builder,
-                                          0,
-                                          GameMessage::Messages_SVActionDeath,
-                                          move.Union());
-    builder.Finish(msg);
-    _world._outputEvents.emplace(builder.GetBufferPointer(),
-                                 builder.GetBufferPointer() + builder.GetSize());
+
+    _world._eventBus.Push(WorldEvent::ActionDeath(this->GetUID()));
+    _world.CountDeath(this->GetUID(), killerName);
     
     _state = Unit::State::DEAD;
     _objAttributes = GameObject::Attributes::PASSABLE;
@@ -50,6 +50,9 @@ struct InputSequence
 class Monster
     : public Unit
 {
+public:
+    static const uint16_t SIGHT_RADIUS = 6;
+
 public:
     Monster(GameWorld& world, uint32_t uid);
     
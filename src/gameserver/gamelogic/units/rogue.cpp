@@ -48,19 +48,9 @@ Rogue::SpellCast(const GameMessage::CLActionSpell* spell)
         auto invis = std::make_shared<RogueInvisibility>(5s);
         invis->SetTargetUnit(std::static_pointer_cast<Unit>(shared_from_this()));
         this->ApplyEffect(invis);
-        
-        flatbuffers::FlatBufferBuilder builder;
-        auto spell1 = GameMessage::CreateSVActionSpell(builder,
-                                                     this->GetUID(),
-                                                     0);
-        auto event = GameMessage::CreateMessage(builder,
-                                              0,
-                                              GameMessage::Messages_SVActionSpell,
-                                              spell1.Union());
-        builder.Finish(event);
-        
-//        _world._outputEvents.emplace(builder.GetBufferPointer(),
-//                                     builder.GetBufferPointer() + builder.GetSize());
+
+//        _world.EmitLocal(*this, WorldEvent::ActionSpell(this->GetUID(),
+//                                                        0));
     }
         // missing knife cast (1 spell)
     else if(spell->spell_id() == 1)
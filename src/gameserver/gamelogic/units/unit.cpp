@@ -16,9 +16,17 @@
 using namespace std::chrono_literals;
 
 
+NamedLogger&
+Unit::LogChannel()
+{
+    static NamedLogger& channel = NamedLogger::Channel("Unit");
+    return channel;
+}
+
+
 Unit::Unit(GameWorld& world, uint32_t uid)
 : GameObject(world, uid),
-  _logger(("Unit" + std::to_string(uid)), NamedLogger::Mode::STDIO),
+  _logger(LogChannel(), uid),
   _unitType(Unit::Type::UNDEFINED),
   _state(Unit::State::UNDEFINED),
   _orientation(Unit::Orientation::DOWN),
@@ -39,7 +47,7 @@ void
 Unit::ApplyEffect(std::shared_ptr<Effect> effect)
 {
         // Log item drop event
-    _logger.Info() << effect->GetName() << " effect is applied";
+    BLOG_INFO(_logger, "{} effect is applied", effect->GetName());
     _effectsManager.AddEffect(effect);
 }
 
@@ -56,21 +64,12 @@ void
 Unit::TakeItem(std::shared_ptr<Item> item)
 {
         // Log item drop event
-    _logger.Info() << "Took item " << item->GetName();
+    BLOG_INFO(_logger, "Took item {}", item->GetName());
     _inventory.push_back(item);
-    
-    flatbuffers::FlatBufferBuilder builder;
-    auto take = GameMessage::CreateSVActionItem(builder,
-                                                this->GetUID(),
-                                                item->GetUID(),
-                                                GameMessage::ActionItemType_TAKE);
-    auto msg = GameMessage::CreateMessage(builder,
-                                          0,
-                                          GameMessage::Messages_SVActionItem,
-                                          take.Union());
-    builder.Finish(msg);
-    _world._outputEvents.emplace(builder.GetBufferPointer(),
-                                 builder.GetBufferPointer() + builder.GetSize());
+
+    _world.EmitLocal(*this, WorldEvent::ActionItem(this->GetUID(),
+                                                   item->GetUID(),
+                                                   GameMessage::ActionItemType_TAKE));
 }
 
 
@@ -78,7 +77,7 @@ void
 Unit::Spawn(const Point<>& pos)
 {
         // Log spawn event
-    _logger.Info() << "Spawned at " << pos;
+    BLOG_INFO(_logger, "Spawned at {}", pos);
     
     _state = Unit::State::WALKING;
     _objAttributes = GameObject::Attributes::MOVABLE | GameObject::Attributes::VISIBLE | GameObject::Attributes::DAMAGABLE;
@@ -86,19 +85,10 @@ Unit::Spawn(const Point<>& pos)
     _health = _health.Max();
     
     _pos = pos;
-    
-    flatbuffers::FlatBufferBuilder builder;
-    auto spawn = GameMessage::CreateSVSpawnPlayer(builder,
-                                                  this->GetUID(),
+
+    _world._eventBus.Push(WorldEvent::SpawnPlayer(this->GetUID(),
                                                   pos.x,
-                                                  pos.y);
-    auto msg = GameMessage::CreateMessage(builder,
-                                          0,
-                                          GameMessage::Messages_SVSpawnPlayer,
-                                          spawn.Union());
-    builder.Finish(msg);
-    _world._outputEvents.emplace(builder.GetBufferPointer(),
-                                 builder.GetBufferPointer() + builder.GetSize());
+                                                  pos.y));
 }
 
 
@@ -106,7 +96,7 @@ void
 Unit::Respawn(const Point<>& pos)
 {
         // Log respawn event
-    _logger.Info() << "Respawned at " << pos;
+    BLOG_INFO(_logger, "Respawned at {}", pos);
     
     _state = Unit::State::WALKING;
     _objAttributes = GameObject::Attributes::MOVABLE | GameObject::Attributes::VISIBLE | GameObject::Attributes::DAMAGABLE;
@@ -118,19 +108,10 @@ Unit::Respawn(const Point<>& pos)
     auto respBuff = std::make_shared<RespawnInvulnerability>(5s);
     respBuff->SetTargetUnit(std::static_pointer_cast<Unit>(shared_from_this()));
     this->ApplyEffect(respBuff);
-    
-    flatbuffers::FlatBufferBuilder builder;
-    auto resp = GameMessage::CreateSVRespawnPlayer(builder,
-                                                   this->GetUID(),
-                                                   pos.x,
-                                                   pos.y);
-    auto msg = GameMessage::CreateMessage(builder,
-                                          0,
-                                          GameMessage::Messages_SVRespawnPlayer,
-                                          resp.Union());
-    builder.Finish(msg);
-    _world._outputEvents.emplace(builder.GetBufferPointer(),
-                                 builder.GetBufferPointer() + builder.GetSize());
+
+    _world._eventBus.Push(WorldEvent::RespawnPlayer(this->GetUID(),
+                                                    pos.x,
+                                                    pos.y));
 }
 
 
@@ -151,7 +132,7 @@ Unit::DropItem(int32_t uid)
     }
     
         // Log item drop event
-    _logger.Info() << "Drop item " << (*item)->GetName();
+    BLOG_INFO(_logger, "Drop item {}", (*item)->GetName());
     (*item)->SetPosition(_pos);
     _world._objectsStorage.PushObject(*item);
 
@@ -165,7 +146,7 @@ void
 Unit::Die(const std::string& killerName)
 {
         // Log death event
-    _logger.Info() << "Killed by " << killerName << " at " << _pos;
+    BLOG_INFO(_logger, "Killed by {} at {}", killerName, _pos);
     
         // drop items
     auto items = _inventory;
@@ -177,18 +158,9 @@ Unit::Die(const std::string& killerName)
         enemy->EndDuel();
         EndDuel();
     }
-    
-    flatbuffers::FlatBufferBuilder builder;
-    auto move = GameMessage::CreateSVActionDeath(builder,
-                                               this->GetUID(),
-                                               0);
-    auto msg = GameMessage::CreateMessage(builder,
-                                        0,
-                                        GameMessage::Messages_SVActionDeath,
-                                        move.Union());
-    builder.Finish(msg);
-    _world._outputEvents.emplace(builder.GetBufferPointer(),
-                                 builder.GetBufferPointer() + builder.GetSize());
+
+    _world._eventBus.Push(WorldEvent::ActionDeath(this->GetUID()));
+    _world.CountDeath(this->GetUID(), killerName);
     
     _state = Unit::State::DEAD;
     _objAttributes = GameObject::Attributes::PASSABLE;
@@ -221,23 +193,14 @@ Unit::Move(MoveDirection dir)
     }
 
         // Log move event
-    _logger.Debug() << "Move to " << new_coord;
+    BLOG_DEBUG(_logger, "Move to {}", new_coord);
 
     GameObject::Move(new_coord);
-    
-    flatbuffers::FlatBufferBuilder builder;
-    auto move = GameMessage::CreateSVActionMove(builder,
-                                                this->GetUID(),
-                                                (char)dir,
-                                                new_coord.x,
-                                                new_coord.y);
-    auto msg = GameMessage::CreateMessage(builder,
-                                          0,
-                                          GameMessage::Messages_SVActionMove,
-                                          move.Union());
-    builder.Finish(msg);
-    _world._outputEvents.emplace(builder.GetBufferPointer(),
-                                 builder.GetBufferPointer() + builder.GetSize());
+
+    _world.EmitLocal(*this, WorldEvent::ActionMove(this->GetUID(),
+                                                   (char)dir,
+                                                   new_coord.x,
+                                                   new_coord.y));
 }
 
 
@@ -254,7 +217,7 @@ Unit::TakeDamage(const DamageDescriptor& dmg)
     _health -= damage_taken;
     
         // Log damage take event
-    _logger.Info() << "HP: " << _health + damage_taken << " -> " << _health << " (reason: attack for " << damage_taken << " from " << dmg.DealerName << ")";
+    BLOG_INFO(_logger, "HP: {} -> {} (reason: attack for {} from {})", _health + damage_taken, _health, damage_taken, dmg.DealerName);
     
     if(_health == _health.Min())
         Die(dmg.DealerName);
@@ -267,33 +230,23 @@ Unit::StartDuel(std::shared_ptr<Unit> enemy)
     enemy->AcceptDuel(std::dynamic_pointer_cast<Unit>(shared_from_this()));
 
         // Log duel start event
-    _logger.Info() << "Initiates duel with " << enemy->GetName();
+    BLOG_INFO(_logger, "Initiates duel with {}", enemy->GetName());
     
     _state = Unit::State::DUEL;
     _unitAttributes &= ~Unit::Attributes::DUELABLE;
     
     _duelTarget = enemy;
-    
-    flatbuffers::FlatBufferBuilder builder;
-    auto duel = GameMessage::CreateSVActionDuel(builder,
-                                                this->GetUID(),
-                                                enemy->GetUID(),
-                                                GameMessage::ActionDuelType_STARTED);
-    auto msg = GameMessage::CreateMessage(builder,
-                                          0,
-                                          GameMessage::Messages_SVActionDuel,
-                                          duel.Union());
-    builder.Finish(msg);
-    
-    _world._outputEvents.emplace(builder.GetBufferPointer(),
-                                 builder.GetBufferPointer() + builder.GetSize());
+
+    _world.EmitLocal(*this, WorldEvent::ActionDuel(this->GetUID(),
+                                                   enemy->GetUID(),
+                                                   GameMessage::ActionDuelType_STARTED));
 }
 
 void
 Unit::AcceptDuel(std::shared_ptr<Unit> enemy)
 {
     // Log duel start event
-    _logger.Info() << "Accept duel from " << enemy->GetName();
+    BLOG_INFO(_logger, "Accept duel from {}", enemy->GetName());
 
     _state = Unit::State::DUEL;
     _unitAttributes &= ~Unit::Attributes::DUELABLE;
@@ -306,7 +259,7 @@ void
 Unit::EndDuel()
 {
         // Log duel-end event
-    _logger.Info() << "Duel with " << _duelTarget.lock()->GetName() << " ended";
+    BLOG_INFO(_logger, "Duel with {} ended", _duelTarget.lock()->GetName());
     
     _state = Unit::State::WALKING;
     _unitAttributes |= Unit::Attributes::INPUT | Unit::Attributes::ATTACK | Unit::Attributes::DUELABLE;
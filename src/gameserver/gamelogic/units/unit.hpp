@@ -214,8 +214,11 @@ protected:
 
     virtual void update(std::chrono::microseconds) override;
 
+        // shared by all units, uid is appended at format time
+    static NamedLogger& LogChannel();
+
 protected:
-    NamedLogger             _logger;
+    LogHandle               _logger;
     Unit::Type              _unitType;
     Unit::State             _state;
     Unit::Orientation       _orientation;
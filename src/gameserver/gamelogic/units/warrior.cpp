@@ -46,19 +46,9 @@ Warrior::SpellCast(const GameMessage::CLActionSpell* spell)
     {
             // set up CD
         _cdManager.Restart(0);
-        
-        flatbuffers::FlatBufferBuilder builder;
-        auto spell1 = GameMessage::CreateSVActionSpell(builder,
-                                                       this->GetUID(),
-                                                       0);
-        auto event = GameMessage::CreateMessage(builder,
-                                                0,
-                                                GameMessage::Messages_SVActionSpell,
-                                                spell1.Union());
-        builder.Finish(event);
-        
-        _world._outputEvents.emplace(builder.GetBufferPointer(),
-                                     builder.GetBufferPointer() + builder.GetSize());
+
+        _world.EmitLocal(*this, WorldEvent::ActionSpell(this->GetUID(),
+                                                        0));
 
         auto warDash = std::make_shared<WarriorDash>(3s, 5.5);
         warDash->SetTargetUnit(std::static_pointer_cast<Unit>(shared_from_this()));
@@ -68,30 +58,16 @@ Warrior::SpellCast(const GameMessage::CLActionSpell* spell)
             enemy && spell->spell_id() == 1 && _cdManager.SpellReady(1)) // warrior attack (2 spell)
     {
             // Log damage event
-        _logger.Info() << "Attack " << enemy->GetName() << " for " << _damage;
+        BLOG_INFO(_logger, "Attack {} for {}", enemy->GetName(), _damage);
         
             // set up CD
         _cdManager.Restart(1);
-        
-        flatbuffers::FlatBufferBuilder builder;
-        auto spell_info = GameMessage::CreateWarriorAttack(builder,
-                                                           enemy->GetUID(),
-                                                           _damage);
-        auto spell = GameMessage::CreateSpell(builder,
-                                              GameMessage::Spells_WarriorAttack,
-                                              spell_info.Union());
-        auto spell1 = GameMessage::CreateSVActionSpell(builder,
-                                                       this->GetUID(),
-                                                       1,
-                                                       spell);
-        auto event = GameMessage::CreateMessage(builder,
-                                                0,
-                                                GameMessage::Messages_SVActionSpell,
-                                                spell1.Union());
-        builder.Finish(event);
-        
-        _world._outputEvents.emplace(builder.GetBufferPointer(),
-                                     builder.GetBufferPointer() + builder.GetSize());
+
+        _world.EmitLocal(*this, WorldEvent::SpellOnTarget(this->GetUID(),
+                                                          1,
+                                                          GameMessage::Spells_WarriorAttack,
+                                                          enemy->GetUID(),
+                                                          _damage));
         
             // deal PHYSICAL damage
         DamageDescriptor dmgDescr;
@@ -106,19 +82,9 @@ Warrior::SpellCast(const GameMessage::CLActionSpell* spell)
     {
             // set up CD
         _cdManager.Restart(2);
-        
-        flatbuffers::FlatBufferBuilder builder;
-        auto spell1 = GameMessage::CreateSVActionSpell(builder,
-                                                       this->GetUID(),
-                                                       2);
-        auto event = GameMessage::CreateMessage(builder,
-                                                0,
-                                                GameMessage::Messages_SVActionSpell,
-                                                spell1.Union());
-        builder.Finish(event);
-        
-        _world._outputEvents.emplace(builder.GetBufferPointer(),
-                                     builder.GetBufferPointer() + builder.GetSize());
+
+        _world.EmitLocal(*this, WorldEvent::ActionSpell(this->GetUID(),
+                                                        2));
 
         auto armorUp = std::make_shared<WarriorArmorUp>(5s, 4);
         armorUp->SetTargetUnit(std::static_pointer_cast<Unit>(shared_from_this()));
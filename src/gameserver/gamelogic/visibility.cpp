@@ -0,0 +1,196 @@
+//
+//  visibility.cpp
+//  labyrinth_server
+//
+
+#include "visibility.hpp"
+
+#include <cmath>
+
+
+namespace
+{
+        // octant transforms for shadowcasting
+    const int OCTANTS[4][8] =
+    {
+        { 1,  0,  0, -1, -1,  0,  0,  1 },
+        { 0,  1, -1,  0,  0, -1,  1,  0 },
+        { 0,  1,  1,  0,  0, -1, -1,  0 },
+        { 1,  0,  0,  1, -1,  0,  0, -1 }
+    };
+}
+
+
+VisibilityMap::VisibilityMap(uint16_t width, uint16_t height)
+: _walls(width, height)
+{ }
+
+
+void
+VisibilityMap::Reset(uint16_t width, uint16_t height)
+{
+    if(_walls.Width() != width || _walls.Height() != height)
+    {
+        _walls = BitGrid(width, height);
+        _viewers.clear();
+        return;
+    }
+
+    _walls.Clear();
+    for(auto& viewer : _viewers)
+    {
+        viewer.second.X = -1; // never a real tile, forces Compute()
+        viewer.second.Touched = false;
+    }
+}
+
+
+void
+VisibilityMap::SetWall(int x, int y, bool wall)
+{
+    if(!_walls.Inside(x, y))
+        return;
+
+    if(wall)
+        _walls.Set(x, y);
+    else
+        _walls.Reset(x, y);
+}
+
+
+void
+VisibilityMap::UpdateViewer(uint32_t uid, const Point<>& pos, uint16_t radius)
+{
+    int x = std::lround(pos.x);
+    int y = std::lround(pos.y);
+
+    auto iter = _viewers.find(uid);
+    if(iter == _viewers.end())
+    {
+        Viewer viewer { x, y, radius, true, BitGrid(_walls.Width(), _walls.Height()) };
+        Compute(viewer);
+        _viewers.emplace(uid, std::move(viewer));
+        return;
+    }
+
+    auto& viewer = iter->second;
+    viewer.Touched = true;
+    if(viewer.X == x && viewer.Y == y && viewer.Radius == radius)
+        return;
+
+    viewer.X = x;
+    viewer.Y = y;
+    viewer.Radius = radius;
+    Compute(viewer);
+}
+
+
+void
+VisibilityMap::RemoveStaleViewers()
+{
+    for(auto iter = _viewers.begin(); iter != _viewers.end();)
+    {
+        if(!iter->second.Touched)
+            iter = _viewers.erase(iter);
+        else
+        {
+            iter->second.Touched = false;
+            ++iter;
+        }
+    }
+}
+
+
+bool
+VisibilityMap::IsVisible(uint32_t viewerUid, const Point<>& pos) const
+{
+    auto tiles = GetVisibleTiles(viewerUid);
+    if(!tiles)
+        return false;
+
+    int x = std::lround(pos.x);
+    int y = std::lround(pos.y);
+    return tiles->Inside(x, y) && tiles->Get(x, y);
+}
+
+
+const BitGrid*
+VisibilityMap::GetVisibleTiles(uint32_t viewerUid) const
+{
+    auto iter = _viewers.find(viewerUid);
+    return iter != _viewers.end() ? &iter->second.Tiles : nullptr;
+}
+
+
+void
+VisibilityMap::Compute(Viewer& viewer) const
+{
+    viewer.Tiles.Clear();
+    if(!viewer.Tiles.Inside(viewer.X, viewer.Y))
+        return;
+
+    viewer.Tiles.Set(viewer.X, viewer.Y);
+    for(auto oct = 0; oct < 8; ++oct)
+        CastLight(viewer, 1, 1.0f, 0.0f,
+                  OCTANTS[0][oct], OCTANTS[1][oct], OCTANTS[2][oct], OCTANTS[3][oct]);
+}
+
+
+void
+VisibilityMap::CastLight(Viewer& viewer, int row, float start, float end,
+                         int xx, int xy, int yx, int yy) const
+{
+    if(start < end)
+        return;
+
+    const int radius = viewer.Radius;
+    const int radiusSq = radius * radius;
+    float newStart = 0.0f;
+
+    for(int j = row; j <= radius; ++j)
+    {
+        int dx = -j - 1;
+        int dy = -j;
+        bool blocked = false;
+
+        while(dx <= 0)
+        {
+            ++dx;
+
+            int x = viewer.X + dx * xx + dy * xy;
+            int y = viewer.Y + dx * yx + dy * yy;
+            float leftSlope = (dx - 0.5f) / (dy + 0.5f);
+            float rightSlope = (dx + 0.5f) / (dy - 0.5f);
+
+            if(start < rightSlope)
+                continue;
+            else if(end > leftSlope)
+                break;
+
+            if(viewer.Tiles.Inside(x, y) && dx * dx + dy * dy <= radiusSq)
+                viewer.Tiles.Set(x, y);
+
+            bool wall = IsWall(x, y);
+            if(blocked)
+            {
+                if(wall)
+                {
+                    newStart = rightSlope;
+                    continue;
+                }
+
+                blocked = false;
+                start = newStart;
+            }
+            else if(wall && j < radius)
+            {
+                blocked = true;
+                CastLight(viewer, j + 1, start, leftSlope, xx, xy, yx, yy);
+                newStart = rightSlope;
+            }
+        }
+
+        if(blocked)
+            break;
+    }
+}
@@ -0,0 +1,113 @@
+//
+//  visibility.hpp
+//  labyrinth_server
+//
+
+#ifndef visibility_hpp
+#define visibility_hpp
+
+#include "../../toolkit/Point.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+
+/*
+ * Packed 2D bitset, one bit per map tile, rows are padded to 64 bits.
+ */
+class BitGrid
+{
+public:
+    BitGrid(uint16_t width = 0, uint16_t height = 0)
+    : _width(width),
+      _height(height),
+      _rowWords((width + 63) / 64),
+      _words(_rowWords * height, 0)
+    { }
+
+    uint16_t Width() const
+    { return _width; }
+
+    uint16_t Height() const
+    { return _height; }
+
+    bool Inside(int x, int y) const
+    { return x >= 0 && y >= 0 && x < _width && y < _height; }
+
+    bool Get(int x, int y) const
+    { return (_words[y * _rowWords + (x >> 6)] >> (x & 63)) & 1; }
+
+    void Set(int x, int y)
+    { _words[y * _rowWords + (x >> 6)] |= (uint64_t(1) << (x & 63)); }
+
+    void Reset(int x, int y)
+    { _words[y * _rowWords + (x >> 6)] &= ~(uint64_t(1) << (x & 63)); }
+
+    void Clear()
+    { std::fill(_words.begin(), _words.end(), 0); }
+
+private:
+    uint16_t                _width;
+    uint16_t                _height;
+    size_t                  _rowWords;
+    std::vector<uint64_t>   _words;
+};
+
+
+/*
+ * Line-of-sight over static labyrinth walls (recursive shadowcasting).
+ * Every unit registers as a viewer, its visible tiles are cached in a BitGrid and recalculated
+ * only when the unit changes tile (or view radius), so IsVisible() is a hash lookup plus bit test.
+ */
+class VisibilityMap
+{
+public:
+    VisibilityMap(uint16_t width, uint16_t height);
+
+    /*
+     * Clears walls for the next map. Viewers of the same map size keep their tiles memory,
+     * they are recalculated on the next update or dropped as stale.
+     */
+    void Reset(uint16_t width, uint16_t height);
+
+    void SetWall(int x, int y, bool wall);
+
+    bool IsWall(int x, int y) const
+    { return !_walls.Inside(x, y) || _walls.Get(x, y); }
+
+    /*
+     * Updates viewer position, does nothing if it stays on the same tile.
+     */
+    void UpdateViewer(uint32_t uid, const Point<>& pos, uint16_t radius);
+
+    /*
+     * Removes all viewers that were not updated since previous call.
+     */
+    void RemoveStaleViewers();
+
+    bool IsVisible(uint32_t viewerUid, const Point<>& pos) const;
+
+    const BitGrid* GetVisibleTiles(uint32_t viewerUid) const;
+
+private:
+    struct Viewer
+    {
+        int         X;
+        int         Y;
+        uint16_t    Radius;
+        bool        Touched;
+        BitGrid     Tiles;
+    };
+
+    void Compute(Viewer& viewer) const;
+    void CastLight(Viewer& viewer, int row, float start, float end,
+                   int xx, int xy, int yx, int yy) const;
+
+private:
+    BitGrid                                 _walls;
+    std::unordered_map<uint32_t, Viewer>    _viewers;
+};
+
+#endif /* visibility_hpp */
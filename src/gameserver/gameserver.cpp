@@ -8,12 +8,17 @@
 
 #include "gameserver.hpp"
 
+#include "../services/storage_backend.hpp"
+
+#include "../toolkit/cpu_pinning.hpp"
 #include "../toolkit/elapsed_time.hpp"
 #include "../toolkit/SafePacketGetter.hpp"
 
+#include <Poco/TaskNotification.h>
 #include <Poco/Thread.h>
 #include <Poco/Timer.h>
 
+#include <algorithm>
 #include <array>
 #include <iostream>
 #include <random>
@@ -93,14 +98,16 @@ const std::chrono::microseconds GameServer::PING_INTERVAL = 3s;
 
 GameServer::GameServer(const Configuration& config)
 : Task(("GameServer" + std::to_string(config.Port))),
-  _state(GameServer::State::LOBBY_FORMING),
+  _state(GameServer::State::STANDBY),
+  _connectedPlayers(0),
+  _utilization(0),
+  _overruns(0),
   _config(config),
   _msPerUpdate(10),
-  _logger("Server", NamedLogger::Mode::STDIO)
+  _matchStarted(0),
+  _logger("Server", NamedLogger::Mode::STDIO),
+  _unknownSenders(LogHandle(_logger), { "Received packets from unexisting player" })
 {
-    _logger.Info() << "Launch configuration {random_seed = " << _config.RandomSeed
-            << ", lobby_size = " << _config.Players << ", refresh_rate = " << _msPerUpdate.count() << "ms}";
-
     try
     {
         Poco::Net::SocketAddress addr(Poco::Net::IPAddress(),
@@ -121,27 +128,120 @@ void GameServer::shutdown()
 { Task::setState(Poco::Task::TaskState::TASK_FINISHED); }
 
 
-void GameServer::runTask()
+void GameServer::ChangeState(GameServer::State state)
 {
-    try
+    auto previous = _state.exchange(state, std::memory_order_acq_rel);
+    if(previous == State::LOBBY_FORMING && state != State::LOBBY_FORMING)
+        PostLobbyEvent({ true, 0, false });
+}
+
+
+void GameServer::PostLobbyEvent(const LobbyEvent& event)
+{
+        // delivered synchronously to the TaskManager observers, i.e. GameServersController
+    postNotification(new Poco::TaskCustomNotification<LobbyEvent>(this, event));
+}
+
+
+void GameServer::Activate(uint16_t players, uint32_t randomSeed)
+{
+    _config.Players = players;
+    _config.RandomSeed = randomSeed;
+
+        // configuration is published by the state change, standby_stage reads it after the event
+    ChangeState(State::LOBBY_FORMING);
+    _activation.set();
+}
+
+
+bool GameServer::standby_stage()
+{
+    while(!_activation.tryWait(100))
     {
-        // lobby forming stage
-        lobby_forming_stage();
-        // hero picking stage
-        hero_picking_stage();
-        // worldgen stage
-        world_generation_stage();
-        // running game stage
-        running_game_stage();
+        if(isCancelled())
+            return false;
     }
-    catch(const std::exception& e)
+
+    LOG_INFO(_logger) << "Launch configuration {random_seed = " << _config.RandomSeed
+            << ", lobby_size = " << _config.Players << ", refresh_rate = " << _msPerUpdate.count() << "ms}";
+    return true;
+}
+
+
+void GameServer::runTask()
+{
+        // pool threads are shared, so the core is taken by the server, not by the thread
+    CpuPinning::Instance().PinGameWorker(_config.Worker);
+
+        // one match per iteration, instance is reused until it is cancelled in standby
+    while(standby_stage())
     {
-        _logger.Error() << "Unhandled exception thrown in GameServer::run: " << e.what();
-        shutdown();
+        try
+        {
+            // lobby forming stage
+            lobby_forming_stage();
+            // hero picking stage
+            hero_picking_stage();
+            // worldgen stage
+            world_generation_stage();
+            // running game stage
+            running_game_stage();
+        }
+        catch(const std::exception& e)
+        {
+            _logger.Error() << "Unhandled exception thrown in GameServer::run: " << e.what();
+        }
+
+            // finished or aborted, as long as the game was actually played
+        if(_state == State::RUNNING_GAME)
+            RecordMatch();
+
+        Recycle();
     }
 }
 
 
+void GameServer::Recycle()
+{
+    _playersConnections.clear();
+    _connectedPlayers.store(0, std::memory_order_relaxed);
+    _utilization.store(0, std::memory_order_relaxed);
+    _overruns.store(0, std::memory_order_relaxed);
+    _matchStarted = 0;
+
+        // late packets of previous players must not reach the next lobby
+    std::array<uint8_t, 1024> drain;
+    while(_socket.available())
+        _socket.receiveBytes(drain.data(), static_cast<int>(drain.size()));
+
+    ChangeState(State::STANDBY);
+    PostLobbyEvent({ false, 0, true });
+
+    LOG_INFO(_logger) << "Match is over, server is back in standby";
+}
+
+
+void GameServer::RecordMatch()
+{
+    DBQuery::MatchRecord match;
+    match.Server = _config.Port;
+    match.RandomSeed = _config.RandomSeed;
+    match.StartedAt = _matchStarted;
+    match.DurationMs = static_cast<uint32_t>(_matchTime.Elapsed<std::chrono::milliseconds>().count());
+    match.Finished = (_world->GetState() == GameWorld::State::FINISHED);
+
+    for(auto& score : _world->GetScores())
+        match.Players.push_back({ score.Player.Name,
+                                  static_cast<uint32_t>(score.Player.Hero),
+                                  score.Kills,
+                                  score.Deaths,
+                                  score.Winner });
+
+        // the controller decides where it goes, this process may not be the master
+    postNotification(new Poco::TaskCustomNotification<DBQuery::MatchRecord>(this, match));
+}
+
+
 void GameServer::Ping()
 {
     static flatbuffers::FlatBufferBuilder builder;
@@ -180,15 +280,17 @@ void GameServer::SendMulticast(flatbuffers::FlatBufferBuilder& builder)
 }
 
 
-void GameServer::SendMulticast(const std::vector<uint8_t>& buffer)
+void GameServer::SendInterested(const EventBus::Packet& packet,
+                                const InterestManager& interest)
 {
     std::for_each(_playersConnections.cbegin(),
                   _playersConnections.cend(),
-                  [&buffer, this](const PlayerConnection& player)
+                  [&packet, &interest, this](const PlayerConnection& player)
                   {
-                      _socket.sendTo(buffer.data(),
-                                     buffer.size(),
-                                     player.GetAddress());
+                      if(interest.IsInterested(player.GetLocalUID(), packet))
+                          _socket.sendTo(packet.Data,
+                                         packet.Size,
+                                         player.GetAddress());
                   });
 }
 
@@ -198,6 +300,7 @@ void GameServer::lobby_forming_stage()
     RandomGenerator<std::mt19937, std::uniform_real_distribution<>> randGen(5000, 30000, 5); // FIXME: random seed?
     ElapsedTime pingTime;
 
+    SafePacketGetter packetGetter(_socket);
     while(_state == State::LOBBY_FORMING)
     {
         std::this_thread::sleep_for(_msPerUpdate);
@@ -208,9 +311,11 @@ void GameServer::lobby_forming_stage()
             Ping();
         }
 
+        packetGetter.FlushWarnings();
+        _unknownSenders.Flush();
+
         while(_socket.available())
         {
-            SafePacketGetter packetGetter(_socket);
             auto packet = packetGetter.Get<GameMessage::Message>();
             if(!packet)
                 continue;
@@ -272,7 +377,7 @@ void GameServer::lobby_forming_stage()
                 }
 
                     // Notify everyone about new player
-                _logger.Info() << "Player [UUID:" << playerConnection.GetUUID() << "] LocalUID: [" << playerConnection.GetLocalUID() << "] Nickname: [" << playerConnection.GetName() <<  "] connected";
+                LOG_INFO(_logger) << "Player [UUID:" << playerConnection.GetUUID() << "] LocalUID: [" << playerConnection.GetLocalUID() << "] Nickname: [" << playerConnection.GetName() <<  "] connected";
                 {
                     flatbuffers::FlatBufferBuilder builder;
                     auto nickname = builder.CreateString(playerConnection.GetName());
@@ -307,6 +412,7 @@ void GameServer::lobby_forming_stage()
         }
 
             // remove players with timeout and send notifications
+        auto connected = _playersConnections.size();
         _playersConnections.erase(
                                   std::remove_if(_playersConnections.begin(),
                                                  _playersConnections.end(),
@@ -314,7 +420,7 @@ void GameServer::lobby_forming_stage()
                                                  {
                                                      if(playerConnection.GetConnectionStatus() == PlayerConnection::ConnectionStatus::TIMEOUT)
                                                      {
-                                                         _logger.Info() << "Player" << playerConnection.GetUUID() << " has been removed from server (connection timeout).";
+                                                         LOG_INFO(_logger) << "Player" << playerConnection.GetUUID() << " has been removed from server (connection timeout).";
 
                                                          flatbuffers::FlatBufferBuilder builder;
                                                          auto disconnect = CreateSVPlayerDisconnected(builder,
@@ -332,11 +438,16 @@ void GameServer::lobby_forming_stage()
                                                  }),
                                   _playersConnections.end());
 
+            // their seats go back to the master
+        _connectedPlayers.store(static_cast<uint16_t>(_playersConnections.size()), std::memory_order_relaxed);
+        if(_playersConnections.size() < connected)
+            PostLobbyEvent({ false, static_cast<uint16_t>(connected - _playersConnections.size()), false });
+
         if(_playersConnections.size() == _config.Players)
         {
-            _state = GameServer::State::HERO_PICK;
+            ChangeState(GameServer::State::HERO_PICK);
             Task::setState(Poco::Task::TaskState::TASK_RUNNING);
-            _logger.Info() << "STATE CHANGE: LOBBY-FORMING -> HERO-PICKING";
+            LOG_INFO(_logger) << "STATE CHANGE: LOBBY-FORMING -> HERO-PICKING";
 
             flatbuffers::FlatBufferBuilder builder;
             auto pickStage = CreateSVHeroPickStage(builder);
@@ -370,6 +481,7 @@ void GameServer::hero_picking_stage()
 
     ElapsedTime pingTime;
 
+    SafePacketGetter packetGetter(_socket);
     while(_state == State::HERO_PICK)
     {
         std::this_thread::sleep_for(_msPerUpdate);
@@ -380,9 +492,11 @@ void GameServer::hero_picking_stage()
             Ping();
         }
 
+        packetGetter.FlushWarnings();
+        _unknownSenders.Flush();
+
         while(_socket.available())
         {
-            SafePacketGetter packetGetter(_socket);
             auto packet = packetGetter.Get<GameMessage::Message>();
             if(!packet)
                 continue;
@@ -392,7 +506,7 @@ void GameServer::hero_picking_stage()
 
             if(playerConnection == _playersConnections.end())
             {
-                _logger.Warning() << "Received packet from unexisting player";
+                _unknownSenders.Report(0, packet->Sender);
                 continue;
             }
 
@@ -417,7 +531,7 @@ void GameServer::hero_picking_stage()
                 }
 
                 playerInfo->first.Hero = (Hero::Type)pick->hero_type();
-                _logger.Info() << "Player" << playerInfo->first.LocalUid << " picked " << playerInfo->first.Hero;
+                LOG_INFO(_logger) << "Player" << playerInfo->first.LocalUid << " picked " << playerInfo->first.Hero;
 
                 flatbuffers::FlatBufferBuilder builder;
                 auto sv_pick = CreateSVHeroPick(builder,
@@ -489,13 +603,13 @@ void GameServer::hero_picking_stage()
 
         if(everyoneReady)
         {
-            _state = GameServer::State::GENERATING_WORLD;
-            _logger.Info() << "STATE CHANGE: HERO-PICKING -> WORLD-GENERATION";
+            ChangeState(GameServer::State::GENERATING_WORLD);
+            LOG_INFO(_logger) << "STATE CHANGE: HERO-PICKING -> WORLD-GENERATION";
 
                 // Log UUID to LocaUID mapping
-            _logger.Info() << "Players UUID <-> LocalUID mapping";
+            LOG_INFO(_logger) << "Players UUID <-> LocalUID mapping";
             for(auto& player : _playersConnections)
-                _logger.Info() << player.GetUUID() << " -> " << player.GetLocalUID();
+                LOG_INFO(_logger) << player.GetUUID() << " -> " << player.GetLocalUID();
 
                 // generate world for ourselves
             GameMapGenerator::Configuration mapConf;
@@ -512,8 +626,12 @@ void GameServer::hero_picking_stage()
                           });
 
                 // if we throw from constructor - no reason to live anyway, GS will fall
-            _world = std::make_unique<GameWorld>(mapConf,
-                                                 playersInfo);
+            if(_world)
+                _world->Reset(mapConf,
+                              playersInfo);
+            else
+                _world = std::make_unique<GameWorld>(mapConf,
+                                                     playersInfo);
 
             flatbuffers::FlatBufferBuilder builder;
             auto generateMap = CreateSVGenerateMap(builder,
@@ -550,6 +668,7 @@ void GameServer::world_generation_stage()
 
     ElapsedTime pingTime;
 
+    SafePacketGetter packetGetter(_socket);
     while(_state == State::GENERATING_WORLD)
     {
         std::this_thread::sleep_for(_msPerUpdate);
@@ -560,9 +679,11 @@ void GameServer::world_generation_stage()
             Ping();
         }
 
+        packetGetter.FlushWarnings();
+        _unknownSenders.Flush();
+
         while(_socket.available())
         {
-            SafePacketGetter packetGetter(_socket);
             auto packet = packetGetter.Get<GameMessage::Message>();
             if(!packet)
                 continue;
@@ -572,7 +693,7 @@ void GameServer::world_generation_stage()
 
             if(playerConnection == _playersConnections.end())
             {
-                _logger.Warning() << "Received packet from unexisting player";
+                _unknownSenders.Report(0, packet->Sender);
                 continue;
             }
 
@@ -597,7 +718,7 @@ void GameServer::world_generation_stage()
                 }
 
                 playerInfo->second = true;
-                _logger.Info() << "Player" << playerInfo->first.LocalUid << " done world generation";
+                LOG_INFO(_logger) << "Player" << playerInfo->first.LocalUid << " done world generation";
 
                 break;
             }
@@ -631,8 +752,10 @@ void GameServer::world_generation_stage()
 
         if(everyoneReady)
         {
-            _logger.Info() << "STATE CHANGE: WORLD-GENERATION -> GAME-RUNNING";
-            _state = State::RUNNING_GAME;
+            LOG_INFO(_logger) << "STATE CHANGE: WORLD-GENERATION -> GAME-RUNNING";
+            ChangeState(State::RUNNING_GAME);
+            _matchStarted = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+            _matchTime.Reset();
 
             flatbuffers::FlatBufferBuilder builder;
             auto start = CreateSVGameStart(builder);
@@ -650,14 +773,17 @@ void GameServer::world_generation_stage()
 
 void GameServer::running_game_stage()
 {
-    ElapsedTime frameTime, pingTime;
+    ElapsedTime frameTime, pingTime, tickTime;
+    _tickTimes.Reset();
 
+    SafePacketGetter packetGetter(_socket);
     while(_world->GetState() != GameWorld::State::FINISHED)
     {
         frameTime.Reset();
 
         // sleep for some time, then get all packets and pass it to the gameworld, update
         std::this_thread::sleep_for(_msPerUpdate);
+        tickTime.Reset();
 
         if(pingTime.Elapsed<std::chrono::microseconds>() > PING_INTERVAL)
         {
@@ -678,9 +804,11 @@ void GameServer::running_game_stage()
                 throw std::runtime_error("No active connections with players, shutting down server (connections timeout)");
         }
 
+        packetGetter.FlushWarnings();
+        _unknownSenders.Flush();
+
         while(_socket.available())
         {
-            SafePacketGetter packetGetter(_socket);
             auto packet = packetGetter.Get<GameMessage::Message>();
             if(!packet)
                 continue;
@@ -690,7 +818,7 @@ void GameServer::running_game_stage()
             auto player = FindPlayerByUID(message->sender_uid()->c_str());
             if(player == _playersConnections.end())
             {
-                _logger.Warning() << "Received packet from unexisting player";
+                _unknownSenders.Report(0, packet->Sender);
                 continue;
             }
 
@@ -707,15 +835,39 @@ void GameServer::running_game_stage()
         _world->update(frameTime.Elapsed<std::chrono::microseconds>());
 
         auto& out_events = _world->GetOutgoingEvents();
-        while(!out_events.empty())
+        auto& interest = _world->GetInterestManager();
+        for(size_t idx = 0; idx < out_events.PacketsCount(); ++idx)
         {
-            SendMulticast(out_events.front());
-            out_events.pop();
+            SendInterested(out_events.GetPacket(idx), interest);
         }
+        out_events.ClearPackets();
+
+        auto tickWork = tickTime.Elapsed<std::chrono::microseconds>();
+        _tickTimes.Record(tickWork);
+        UpdateLoad(tickWork);
     }
 }
 
 
+void GameServer::UpdateLoad(std::chrono::microseconds tickWork)
+{
+    const int64_t MAX_UTILIZATION = 10000;
+
+    auto budget = std::chrono::duration_cast<std::chrono::microseconds>(_msPerUpdate).count();
+    auto utilization = static_cast<uint32_t>(std::min<int64_t>(tickWork.count() * 1000 / budget, MAX_UTILIZATION));
+    uint32_t overrun = tickWork.count() > budget ? 1000 : 0;
+
+        // placement reads them from other threads, only this one writes
+    auto add = [](std::atomic<uint32_t>& sum, uint32_t sample)
+    {
+        auto current = sum.load(std::memory_order_relaxed);
+        sum.store(current - current / LOAD_WINDOW + sample, std::memory_order_relaxed);
+    };
+    add(_utilization, utilization);
+    add(_overruns, overrun);
+}
+
+
 bool GameServer::PlayerExists(const std::string& uid)
 {
     return std::find_if(_playersConnections.cbegin(),
@@ -10,13 +10,18 @@
 #define gameserver_hpp
 
 #include "gamelogic/gameworld.hpp"
+#include "../toolkit/elapsed_time.hpp"
+#include "../toolkit/latency_histogram.hpp"
 #include "../toolkit/named_logger.hpp"
 #include "../toolkit/Random.hpp"
+#include "../toolkit/rate_limited_log.hpp"
 
+#include <Poco/Event.h>
 #include <Poco/Net/DatagramSocket.h>
 #include <Poco/Task.h>
 #include <Poco/Timer.h>
 
+#include <atomic>
 #include <chrono>
 #include <cstring>
 #include <memory>
@@ -36,6 +41,7 @@ public:
 
     enum class State
     {
+        STANDBY,            // initialized and waiting for Activate()
         LOBBY_FORMING,
         HERO_PICK,
         GENERATING_WORLD,
@@ -48,6 +54,28 @@ public:
         uint32_t Port;
         uint32_t RandomSeed;
         uint16_t Players;
+        uint32_t Worker;    // fixed for the server's life, picks its core when threads are pinned
+    };
+
+        // snapshot of a server, readable from any thread
+    struct Stats
+    {
+        GameServer::State           ServerState;
+        uint32_t                    Port;
+        uint16_t                    Players;
+        std::chrono::microseconds   TickP50;    // current or last match
+        std::chrono::microseconds   TickP95;
+        std::chrono::microseconds   TickP99;
+        uint16_t                    Utilization;    // permille of the tick budget, recent ticks weigh more
+        uint16_t                    Overruns;       // permille of recent ticks over the budget
+    };
+
+        // posted through the TaskManager as Poco::TaskCustomNotification<LobbyEvent>
+    struct LobbyEvent
+    {
+        bool        Closed;         // lobby is complete or server stops, no more players are accepted
+        uint16_t    PlayersLeft;    // seats freed by disconnected players
+        bool        Recycled;       // match is over, server is in standby again
     };
 
 public:
@@ -55,41 +83,84 @@ public:
 
     virtual void runTask();
 
+    /*
+     * Turns a standby server into a lobby for given number of players, callable from any thread.
+     */
+    void Activate(uint16_t players, uint32_t randomSeed);
+
     GameServer::State GetState() const
-    { return _state; }
+    { return _state.load(std::memory_order_acquire); }
 
     GameServer::Configuration GetConfig() const
     { return _config; }
 
+        // fixed at construction, unlike the rest of configuration
+    uint32_t GetPort() const
+    { return _config.Port; }
+
+        // safe from any thread
+    GameServer::Stats GetStats() const
+    {
+        return { GetState(),
+                 _config.Port,
+                 _connectedPlayers.load(std::memory_order_relaxed),
+                 _tickTimes.Percentile(0.5),
+                 _tickTimes.Percentile(0.95),
+                 _tickTimes.Percentile(0.99),
+                 static_cast<uint16_t>(_utilization.load(std::memory_order_relaxed) / LOAD_WINDOW),
+                 static_cast<uint16_t>(_overruns.load(std::memory_order_relaxed) / LOAD_WINDOW) };
+    }
+
 private:
     void shutdown();
 
+    void ChangeState(GameServer::State state);
+    void PostLobbyEvent(const LobbyEvent& event);
+
+    bool standby_stage();
     void lobby_forming_stage();
     void hero_picking_stage();
     void world_generation_stage();
     void running_game_stage();
 
+        // posted as Poco::TaskCustomNotification<DBQuery::MatchRecord>
+    void RecordMatch();
+    void Recycle();
+
+        // moving averages are kept as sums over roughly the last LOAD_WINDOW ticks
+    static const uint32_t LOAD_WINDOW = 64;
+    void UpdateLoad(std::chrono::microseconds tickWork);
+
     void Ping();
 
     void SendSingle(flatbuffers::FlatBufferBuilder& builder,
                     Poco::Net::SocketAddress& address);
-    void SendMulticast(const std::vector<uint8_t>& buffer);
+    void SendInterested(const EventBus::Packet& packet,
+                        const InterestManager& interest);
     void SendMulticast(flatbuffers::FlatBufferBuilder& builder);
 
     inline bool PlayerExists(const std::string&);
     inline std::vector<PlayerConnection>::iterator FindPlayerByUID(const std::string&);
 
 private:
-    GameServer::State               _state;
+    std::atomic<GameServer::State>  _state;
+    Poco::Event                     _activation;
+    std::atomic<uint16_t>           _connectedPlayers;
+    LatencyHistogram                _tickTimes;     // update and send, without the sleep
+    std::atomic<uint32_t>           _utilization;   // see Stats, written by the server thread only
+    std::atomic<uint32_t>           _overruns;
     GameServer::Configuration       _config;
     std::string                     _serverName;
     Poco::Net::DatagramSocket       _socket;
     std::chrono::milliseconds       _msPerUpdate;
 
     std::unique_ptr<GameWorld>      _world;
+    int64_t                         _matchStarted;  // unix time, seconds
+    ElapsedTime                     _matchTime;
     std::vector<PlayerConnection>   _playersConnections;
 
     NamedLogger                     _logger;
+    RateLimitedLog                  _unknownSenders;
 };
 
 #endif /* gameserver_hpp */
@@ -0,0 +1,137 @@
+//
+//  lobby_registry.cpp
+//  labyrinth_server
+//
+
+#include "lobby_registry.hpp"
+
+
+LobbyRegistry::LobbyRegistry(size_t capacity)
+: _capacity(capacity),
+  _slots(new std::atomic<uint64_t>[capacity]),
+  _published(NO_LOBBY)
+{
+    for(size_t slot = 0; slot < _capacity; ++slot)
+        _slots[slot].store(Pack(0, State::FREE, 0));
+}
+
+
+std::experimental::optional<size_t>
+LobbyRegistry::TakeSeat()
+{
+    auto hint = _published.load(std::memory_order_acquire);
+    while(hint != NO_LOBBY)
+    {
+        auto slot = static_cast<size_t>(hint & 0xFFFFFFFF);
+        auto word = _slots[slot].load(std::memory_order_acquire);
+
+            // lobby filled up, closed or even reused since it was published
+        if(GenerationOf(word) != GenerationOf(hint) ||
+           StateOf(word) != State::FORMING ||
+           FreeOf(word) == 0)
+        {
+            if(!_published.compare_exchange_weak(hint, NO_LOBBY, std::memory_order_acq_rel))
+                continue; // hint was changed meanwhile, it is in 'hint' now
+            return {};
+        }
+
+        if(_slots[slot].compare_exchange_weak(word, word - 1, std::memory_order_acq_rel))
+        {
+            if(FreeOf(word) == 1)
+                _published.compare_exchange_strong(hint, NO_LOBBY, std::memory_order_acq_rel);
+            return slot;
+        }
+
+        hint = _published.load(std::memory_order_acquire);
+    }
+
+    return {};
+}
+
+
+std::experimental::optional<size_t>
+LobbyRegistry::Publish()
+{
+    for(size_t slot = 0; slot < _capacity; ++slot)
+    {
+        auto word = _slots[slot].load(std::memory_order_acquire);
+        if(StateOf(word) == State::FORMING && FreeOf(word) > 0)
+        {
+            _published.store((uint64_t(GenerationOf(word)) << 32) | slot, std::memory_order_release);
+            return slot;
+        }
+    }
+
+    return {};
+}
+
+
+std::experimental::optional<size_t>
+LobbyRegistry::Reserve()
+{
+    for(size_t slot = 0; slot < _capacity; ++slot)
+    {
+        if(Reserve(slot))
+            return slot;
+    }
+
+    return {};
+}
+
+
+bool
+LobbyRegistry::Reserve(size_t slot)
+{
+    auto word = _slots[slot].load(std::memory_order_acquire);
+    return StateOf(word) == State::FREE &&
+           _slots[slot].compare_exchange_strong(word, Pack(GenerationOf(word) + 1, State::FORMING, 0), std::memory_order_acq_rel);
+}
+
+
+void
+LobbyRegistry::Reopen(size_t slot)
+{
+    auto word = _slots[slot].load(std::memory_order_acquire);
+    _slots[slot].store(Pack(GenerationOf(word) + 1, State::FORMING, 0), std::memory_order_release);
+}
+
+
+void
+LobbyRegistry::ReturnSeats(size_t slot, uint16_t count)
+{
+    auto word = _slots[slot].load(std::memory_order_acquire);
+    while(StateOf(word) == State::FORMING &&
+          !_slots[slot].compare_exchange_weak(word, word + count, std::memory_order_acq_rel))
+    { }
+}
+
+
+void
+LobbyRegistry::Close(size_t slot)
+{
+    auto word = _slots[slot].load(std::memory_order_acquire);
+    while(StateOf(word) == State::FORMING &&
+          !_slots[slot].compare_exchange_weak(word, Pack(GenerationOf(word), State::CLOSED, 0), std::memory_order_acq_rel))
+    { }
+
+    Unpublish(slot);
+}
+
+
+void
+LobbyRegistry::Release(size_t slot)
+{
+    auto word = _slots[slot].load(std::memory_order_acquire);
+    _slots[slot].store(Pack(GenerationOf(word), State::FREE, 0), std::memory_order_release);
+
+    Unpublish(slot);
+}
+
+
+void
+LobbyRegistry::Unpublish(size_t slot)
+{
+    auto hint = _published.load(std::memory_order_acquire);
+    if(hint != NO_LOBBY && (hint & 0xFFFFFFFF) == slot)
+        _published.compare_exchange_strong(hint, NO_LOBBY, std::memory_order_acq_rel);
+}
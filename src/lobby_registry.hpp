@@ -0,0 +1,102 @@
+//
+//  lobby_registry.hpp
+//  labyrinth_server
+//
+
+#ifndef lobby_registry_hpp
+#define lobby_registry_hpp
+
+#include "toolkit/optional.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+
+/*
+ * Seats of forming lobbies, one slot per game server.
+ * Lobbies are reserved whole by the matchmaker, seats freed by players who left are published
+ * for backfill. Every slot is a single atomic word (generation, state, free seats), the lobby being
+ * refilled is published as an atomic (generation, slot) hint. Taking a seat is a couple of loads and
+ * one CAS, so backfill never locks and never walks the servers list.
+ */
+class LobbyRegistry
+{
+public:
+    enum class State : uint8_t
+    {
+        FREE,       // no server
+        FORMING,    // server waits for players
+        CLOSED      // game goes on, or server is shutting down
+    };
+
+public:
+    LobbyRegistry(size_t capacity);
+
+    size_t Capacity() const
+    { return _capacity; }
+
+    /*
+     * Lock-free, safe from any thread. Takes a seat in the published lobby.
+     */
+    std::experimental::optional<size_t> TakeSeat();
+
+    /*
+     * Publishes a forming lobby which has free seats again, empty if there is none.
+     * Calls have to be serialized, two publishers would hide each other's lobby.
+     */
+    std::experimental::optional<size_t> Publish();
+
+    /*
+     * Turns a FREE slot into a lobby with every seat taken, the caller starts its server.
+     * Empty if every slot is busy.
+     */
+    std::experimental::optional<size_t> Reserve();
+
+    /*
+     * Same for the given slot, false if it is not FREE.
+     */
+    bool Reserve(size_t slot);
+
+    /*
+     * Reserves a CLOSED slot again, its server is reused for the next match.
+     */
+    void Reopen(size_t slot);
+
+        // called on behalf of the slot's server
+    void ReturnSeats(size_t slot, uint16_t count);
+    void Close(size_t slot);
+    void Release(size_t slot);
+
+    State GetState(size_t slot) const
+    { return StateOf(_slots[slot].load(std::memory_order_acquire)); }
+
+    uint16_t GetFreeSeats(size_t slot) const
+    { return FreeOf(_slots[slot].load(std::memory_order_acquire)); }
+
+private:
+        // slot word: generation << 32 | state << 16 | free seats
+    static uint64_t Pack(uint32_t generation, State state, uint16_t free)
+    { return (uint64_t(generation) << 32) | (uint64_t(state) << 16) | free; }
+
+    static uint32_t GenerationOf(uint64_t word)
+    { return static_cast<uint32_t>(word >> 32); }
+
+    static State StateOf(uint64_t word)
+    { return static_cast<State>((word >> 16) & 0xFF); }
+
+    static uint16_t FreeOf(uint64_t word)
+    { return static_cast<uint16_t>(word & 0xFFFF); }
+
+        // hint: generation << 32 | slot
+    static const uint64_t NO_LOBBY = ~uint64_t(0);
+
+    void Unpublish(size_t slot);
+
+private:
+    const size_t                            _capacity;
+    std::unique_ptr<std::atomic<uint64_t>[]> _slots;
+    std::atomic<uint64_t>                   _published;
+};
+
+#endif /* lobby_registry_hpp */
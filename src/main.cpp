@@ -6,24 +6,155 @@
 //  Copyright © 2017 sandyre. All rights reserved.
 //
 
+#include "GameServersController.hpp"
+#include "game_fleet.hpp"
+#include "gamehost.hpp"
 #include "masterserver.hpp"
+#include "services/DatabaseAccessor.hpp"
+#include "services/match_history.hpp"
+#include "services/matchmaker.hpp"
+#include "toolkit/cpu_pinning.hpp"
+#include "toolkit/named_logger.hpp"
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+
+
+namespace
+{
+        // SIGINT/SIGTERM stop a game host, its game servers are torn down before exit
+    GameHost * runningHost = nullptr;
+
+    void StopHost(int)
+    {
+        if(runningHost)
+            runningHost->Stop();
+    }
+}
+
 
 int main(int argc, const char * argv[])
 {
-    std::unique_ptr<MasterServer> server;
+    bool asyncLog = false;
+    uint32_t admKey = 0;
+    std::string binaryLogPath;
+    MatchHistory::Configuration historyConfig = { 1024, 64, std::chrono::milliseconds(1000), "match_history.spill" };
+    bool gameHost = false;
+    CpuPinning::Configuration pinningConfig = { false, 1 };
+    GameServersController::Configuration serversConfig = { 2, 1931 };
+    GameFleet::Configuration fleetConfig = { Poco::Net::SocketAddress("127.0.0.1", 1929), true,
+                                             std::chrono::milliseconds(3000), std::chrono::milliseconds(200), 0 };
+    GameHost::Configuration hostConfig = { Poco::Net::SocketAddress("127.0.0.1", 1929), std::string(),
+                                           std::chrono::milliseconds(1000), 0 };
+    Matchmaker::Configuration matchmakerConfig = { std::chrono::milliseconds(250), 1, 8, 4096,
+                                                   std::chrono::milliseconds(50), std::chrono::milliseconds(25),
+                                                   std::chrono::seconds(60) };
+    DatabaseAccessor::Configuration dbConfig = { std::chrono::milliseconds(0), 64, "mysql", 1024, std::chrono::milliseconds(3000) };
+    for(int i = 1; i < argc; ++i)
+    {
+        if(std::strcmp(argv[i], "--async-log") == 0)
+            asyncLog = true;
+        else if(std::strncmp(argv[i], "--db-batch-window=", 18) == 0)
+            dbConfig.BatchWindow = std::chrono::milliseconds(std::atoi(argv[i] + 18));
+        else if(std::strncmp(argv[i], "--storage=", 10) == 0)
+            dbConfig.Storage = argv[i] + 10;
+        else if(std::strncmp(argv[i], "--match-spill=", 14) == 0)
+            historyConfig.SpillPath = argv[i] + 14;
+        else if(std::strncmp(argv[i], "--db-queue=", 11) == 0)
+            dbConfig.QueueCapacity = std::atoi(argv[i] + 11);
+        else if(std::strncmp(argv[i], "--db-deadline=", 14) == 0)
+            dbConfig.Deadline = std::chrono::milliseconds(std::atoi(argv[i] + 14));
+        else if(std::strncmp(argv[i], "--warm-servers=", 15) == 0)
+            serversConfig.WarmServers = std::atoi(argv[i] + 15);
+        else if(std::strncmp(argv[i], "--base-port=", 12) == 0)
+            serversConfig.BasePort = static_cast<uint16_t>(std::atoi(argv[i] + 12));
+        else if(std::strncmp(argv[i], "--control=", 10) == 0)
+            fleetConfig.ControlAddress = Poco::Net::SocketAddress(argv[i] + 10);
+        else if(std::strcmp(argv[i], "--local-servers=0") == 0)
+            fleetConfig.LocalServers = false;
+        else if(std::strncmp(argv[i], "--game-host=", 12) == 0)
+        {
+            gameHost = true;
+            hostConfig.Master = Poco::Net::SocketAddress(argv[i] + 12);
+        }
+        else if(std::strncmp(argv[i], "--public-host=", 14) == 0)
+            hostConfig.PublicHost = argv[i] + 14;
+        else if(std::strncmp(argv[i], "--host-key=", 11) == 0)
+        {
+                // the same secret on the master and on every game host
+            fleetConfig.HostKey = static_cast<uint32_t>(std::strtoul(argv[i] + 11, nullptr, 10));
+            hostConfig.HostKey = fleetConfig.HostKey;
+        }
+        else if(std::strcmp(argv[i], "--pin-cpus") == 0)
+            pinningConfig.Enabled = true;
+        else if(std::strncmp(argv[i], "--service-cores=", 16) == 0)
+            pinningConfig.ServiceCores = std::atoi(argv[i] + 16);
+        else if(std::strncmp(argv[i], "--lobby-size=", 13) == 0)
+            matchmakerConfig.DefaultLobbySize = std::atoi(argv[i] + 13);
+        else if(std::strncmp(argv[i], "--match-interval=", 17) == 0)
+            matchmakerConfig.FormInterval = std::chrono::milliseconds(std::atoi(argv[i] + 17));
+        else if(std::strncmp(argv[i], "--adm-key=", 10) == 0)
+            admKey = static_cast<uint32_t>(std::strtoul(argv[i] + 10, nullptr, 10));
+        else if(std::strncmp(argv[i], "--binary-log=", 13) == 0)
+            binaryLogPath = argv[i] + 13;
+        else if(std::strcmp(argv[i], "--log-level=debug") == 0)
+            NamedLogger::SetLevel(NamedLogger::Level::DBG);
+        else if(std::strcmp(argv[i], "--log-level=info") == 0)
+            NamedLogger::SetLevel(NamedLogger::Level::INFO);
+        else if(std::strcmp(argv[i], "--log-level=warning") == 0)
+            NamedLogger::SetLevel(NamedLogger::Level::WARNING);
+        else if(std::strcmp(argv[i], "--log-level=error") == 0)
+            NamedLogger::SetLevel(NamedLogger::Level::ERROR);
+    }
+
+    DatabaseAccessor::Configure(dbConfig);
+    MatchHistory::Configure(historyConfig);
+    Matchmaker::Configure(matchmakerConfig);
+    GameServersController::Configure(serversConfig);
+    GameFleet::Configure(fleetConfig);
+    GameHost::Configure(hostConfig);
+    CpuPinning::Configure(pinningConfig);
+
+        // before any thread starts, they inherit service cores from main
+    CpuPinning::Instance().PinService();
+
+    if(asyncLog)
+        NamedLogger::EnableAsync();
+    if(!binaryLogPath.empty() && !BinaryLog::Instance().Open(binaryLogPath))
+    {
+        NamedLogger("Main").Error() << "Failed to open binary log " << binaryLogPath;
+        return 1;
+    }
+
+        // game host processes run game servers only, everything else stays in the master
+    std::unique_ptr<Poco::Runnable> server;
     try
     {
-        server = std::make_unique<MasterServer>();
+        if(gameHost)
+        {
+            auto host = std::make_unique<GameHost>();
+            runningHost = host.get();
+            server = std::move(host);
+
+            std::signal(SIGINT, StopHost);
+            std::signal(SIGTERM, StopHost);
+        }
+        else
+            server = std::make_unique<MasterServer>(admKey);
     }
     catch(...)
     {
         return 1;
     }
 
-    Poco::Thread ms_thread("MasterServer");
+    Poco::Thread ms_thread(gameHost ? "GameHost" : "MasterServer");
     ms_thread.setPriority(Poco::Thread::Priority::PRIO_HIGHEST);
     ms_thread.start(*server);
     ms_thread.join();
 
+    BinaryLog::Instance().Close();
+    NamedLogger::DisableAsync();
+
     return 0;
 }
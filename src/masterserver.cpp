@@ -10,6 +10,8 @@
 
 #include "MasterMessage.h"
 #include "services/DatabaseAccessor.hpp"
+#include "services/leaderboard.hpp"
+#include "services/match_history.hpp"
 #include "toolkit/SafePacketGetter.hpp"
 
 #include <Poco/Environment.h>
@@ -29,247 +31,216 @@ using namespace std::chrono_literals;
 using Poco::Data::Statement;
 
 
-class MasterServer::RegistrationTask : public Poco::Task
+namespace
 {
-public:
-    RegistrationTask(MasterServer& masterServer,
-                     const Poco::Net::SocketAddress& recipient,
-                     const std::string& email,
-                     const std::string& password)
-    : Task("RegistrationTask"),
-      _master(masterServer),
-      _logger("RegistrationTask", NamedLogger::Mode::STDIO),
-      _recipient(recipient),
-      _email(email),
-      _password(password)
-    { }
+        // the rest of a second gets rank and points only
+    const uint32_t TOP_REPLIES_PER_SECOND = 50;
 
-    void runTask()
+    template<typename Encoder>
+    std::vector<uint8_t> EncodeMessage(Encoder encoder)
     {
-        _logger.Debug() << "Registration task acquired, waiting DatabaseAccessor response";
-
-        DBQuery::RegisterQuery query;
-        query.Email = _email;
-        query.Password = _password;
+        flatbuffers::FlatBufferBuilder builder;
+        builder.Finish(encoder(builder));
 
-        auto queryResult = DatabaseAccessor::Instance().Query(query);
+        return std::vector<uint8_t>(builder.GetBufferPointer(),
+                                    builder.GetBufferPointer() + builder.GetSize());
+    }
 
-        DBQuery::RegisterResult result;
-        try
-        {
-            result = queryResult.get();
-        }
-        catch(const std::exception& e)
+    const char* OutcomeName(DBQuery::Status outcome)
+    {
+        switch(outcome)
         {
-            _logger.Error() << "DatabaseAccessor returned exception: " << e.what();
-            setState(Poco::Task::TaskState::TASK_FINISHED);
-            return;
+        case DBQuery::Status::OK:
+            return "ok";
+        case DBQuery::Status::OVERLOADED:
+            return "database queue is full";
+        case DBQuery::Status::TIMED_OUT:
+            return "deadline passed in database queue";
         }
 
-        flatbuffers::FlatBufferBuilder builder;
-        if(result.Success)
-        {
-            _logger.Debug() << "User " << _email << " registrated successfully";
-                // Send response to client
-            auto response = CreateSVRegister(builder,
-                                             RegistrationStatus_SUCCESS);
-            auto msg = CreateMessage(builder,
-                                     0,
-                                     Messages_SVRegister,
-                                     response.Union());
-            builder.Finish(msg);
-
-            _master._socket.sendTo(builder.GetBufferPointer(),
-                                   builder.GetSize(),
-                                   _recipient);
-        }
+        return "unknown";
+    }
+
+        // in place, the string keeps its capacity for the next client
+    void Assign(std::string& value, const flatbuffers::String* source)
+    {
+        if(source)
+            value.assign(source->c_str(), source->size());
         else
+            value.clear();
+    }
+
+    const char* StateName(GameServer::State state)
+    {
+        switch(state)
         {
-            _logger.Debug() << "User " << _email << " failed to register: email has been already taken";
-
-                // Send response to client
-            auto response = CreateSVRegister(builder,
-                                             RegistrationStatus_EMAIL_TAKEN);
-            auto msg = CreateMessage(builder,
-                                     0,
-                                     Messages_SVRegister,
-                                     response.Union());
-            builder.Finish(msg);
-
-            _master._socket.sendTo(builder.GetBufferPointer(),
-                                   builder.GetSize(),
-                                   _recipient);
+        case GameServer::State::STANDBY:
+            return "standby";
+        case GameServer::State::LOBBY_FORMING:
+            return "lobby";
+        case GameServer::State::HERO_PICK:
+            return "hero_pick";
+        case GameServer::State::GENERATING_WORLD:
+            return "world_generation";
+        case GameServer::State::RUNNING_GAME:
+            return "running";
+        case GameServer::State::FINISHED:
+            return "finished";
         }
 
-        setState(Poco::Task::TaskState::TASK_FINISHED);
+        return "unknown";
     }
 
-private:
-    MasterServer&                            _master;
-    NamedLogger                              _logger;
-    Poco::Net::SocketAddress                 _recipient;
-    const std::string                        _email;
-    const std::string                        _password;
-};
-
-
-class MasterServer::LoginTask : public Poco::Task
-{
-public:
-    LoginTask(MasterServer& masterServer,
-              const Poco::Net::SocketAddress& recipient,
-              const std::string& email,
-              const std::string& password)
-    : Task("LoginTask"),
-      _master(masterServer),
-      _logger("LoginTask", NamedLogger::Mode::STDIO),
-      _recipient(recipient),
-      _email(email),
-      _password(password)
-    { }
-
-    void runTask()
+    void WritePercentiles(std::ostream& os,
+                          std::chrono::microseconds p50,
+                          std::chrono::microseconds p95,
+                          std::chrono::microseconds p99)
     {
-        _logger.Debug() << "Login task acquired, waiting DatabaseAccessor response";
-
-        DBQuery::LoginQuery query;
-        query.Email = _email;
-        query.Password = _password;
-
-        auto queryResult = DatabaseAccessor::Instance().Query(query);
+        os << "{\"p50\":" << p50.count() << ",\"p95\":" << p95.count() << ",\"p99\":" << p99.count() << "}";
+    }
 
-        DBQuery::LoginResult result;
-        try
-        {
-            result = queryResult.get();
-        }
-        catch(const std::exception& e)
-        {
-            _logger.Error() << "DatabaseAccessor returned exception: " << e.what();
-            setState(Poco::Task::TaskState::TASK_FINISHED);
-            return;
-        }
+        // quoted and escaped, host supplied strings can hold anything
+    void WriteString(std::ostream& os,
+                     const std::string& value)
+    {
+        static const char HEX[] = "0123456789abcdef";
 
-        flatbuffers::FlatBufferBuilder builder;
-        if(result.Success)
+        os << '"';
+        for(unsigned char c : value)
         {
-            _logger.Debug() << "Player " << _email << " logged in";
-                // Send response to client
-            auto response = CreateSVLogin(builder,
-                                          LoginStatus_SUCCESS);
-            auto msg = CreateMessage(builder,
-                                     0,
-                                     Messages_SVLogin,
-                                     response.Union());
-            builder.Finish(msg);
-
-            _master._socket.sendTo(builder.GetBufferPointer(),
-                                   builder.GetSize(),
-                                   _recipient);
-        }
-        else // player is not registered, or wrong password
-        {
-            _logger.Debug() << "Player " << _email << " failed to log in: wrong pass or email";
-
-                // Send response to client
-            auto response = CreateSVLogin(builder,
-                                          LoginStatus_WRONG_INPUT);
-            auto msg = CreateMessage(builder,
-                                     0,
-                                     Messages_SVLogin,
-                                     response.Union());
-            builder.Finish(msg);
-
-            _master._socket.sendTo(builder.GetBufferPointer(),
-                                   builder.GetSize(),
-                                   _recipient);
+            if(c == '"' || c == '\\')
+                os << '\\' << c;
+            else if(c < 0x20)
+                os << "\\u00" << HEX[c >> 4] << HEX[c & 0xf];
+            else
+                os << c;
         }
-
-        setState(Poco::Task::TaskState::TASK_FINISHED);
+        os << '"';
     }
+}
 
-private:
-    MasterServer&                         _master;
-    NamedLogger                           _logger;
-    Poco::Net::SocketAddress              _recipient;
-    const std::string                     _email;
-    const std::string                     _password;
-};
 
 
-class MasterServer::FindGameTask : public Poco::Task
+/*
+ * Register or login request of one client. Owns the query strings while the database works on them,
+ * and goes back to its pool once answered, so a login storm stops allocating after warming up.
+ */
+template<typename TQuery, typename TResult>
+class MasterServer::AuthRequest : public DatabaseAccessor::Completion<TResult>
 {
 public:
-    FindGameTask(MasterServer& masterServer,
-                 const Poco::Net::SocketAddress& recipient)
-    : Task("FindGameTask"),
-    _master(masterServer),
-    _logger("FindGameTask", NamedLogger::Mode::STDIO),
-    _recipient(recipient)
+    AuthRequest(MasterServer& master,
+                AuthPool<TQuery, TResult>& pool)
+    : _master(master),
+      _pool(pool)
     { }
 
-    void runTask()
+    void Setup(const Poco::Net::SocketAddress& recipient,
+               const flatbuffers::String* email,
+               const flatbuffers::String* password)
     {
-        _logger.Debug() << "FindGame task acquired, waiting GameServersController response";
+        _recipient = recipient;
+        Assign(Query.Email, email);
+        Assign(Query.Password, password);
+    }
 
-        auto serverPort = _master._gameserversController->GetServerAddress();
-        if(!serverPort)
+    virtual void Done(const TResult& result, std::exception_ptr error) override
+    {
+        try
         {
-            _logger.Warning() << "GameServersController returned no address (no servers available)";
-            setState(Poco::Task::TaskState::TASK_FINISHED);
-            return;
+            _master.Answer(_recipient, Query, result, error);
+        }
+        catch(...)
+        {
+            Release();
+            throw;
         }
 
-        flatbuffers::FlatBufferBuilder builder;
-        _logger.Debug() << "Found game for [" << _recipient.toString() << "]";
-
-        auto game_found = CreateSVGameFound(builder,
-                                            *serverPort);
-        auto ms_event = CreateMessage(builder,
-                                      0,
-                                      Messages_SVGameFound,
-                                      game_found.Union());
-        builder.Finish(ms_event);
+        Release();
+    }
 
-        _master._socket.sendTo(builder.GetBufferPointer(),
-                               builder.GetSize(),
-                               _recipient);
+public:
+    TQuery                          Query;
 
-        setState(Poco::Task::TaskState::TASK_FINISHED);
+private:
+    void Release()
+    {
+        std::lock_guard<std::mutex> l(_pool.Mutex);
+        _pool.Free.push_back(this);
     }
 
 private:
-    MasterServer&                               _master;
-    NamedLogger                                 _logger;
-    Poco::Net::SocketAddress                    _recipient;
+    MasterServer&                   _master;
+    AuthPool<TQuery, TResult>&      _pool;
+    Poco::Net::SocketAddress        _recipient;
 };
 
 
-MasterServer::MasterServer()
+MasterServer::MasterServer(uint32_t admKey)
 : _logger("MasterServer", NamedLogger::Mode::STDIO),
-  _taskWorkers("MasterServerQueryWorkers", 8, 16, 60),
-  _taskManager(_taskWorkers)
+  _admKey(admKey),
+  _refused(LogHandle(_logger), { "Ignored stats requests with invalid admin key",
+                                  "Refused find-game requests, queue is full or lobby size is unsupported",
+                                  "Answered leaderboard requests without the top list, too many requests" }),
+  _topReplies(0)
 {
     uint16_t Port = 1930;
-    _logger.Info() << "Booting starts";
-
-    _logger.Info() << "Labyrinth core version: " << GAMECORE_MAJOR_VERSION << "." << GAMECORE_MINOR_VERSION << "." << GAMECORE_BUILD_VERSION;
-    _logger.Info() << "[----------------------PLATFORM INFO---------------------]";
+    LOG_INFO(_logger) << "Booting starts";
+
+        // Constant responses
+    _responses.Ping = EncodeMessage([](flatbuffers::FlatBufferBuilder& builder)
+                                    {
+                                        return CreateMessage(builder,
+                                                             0,
+                                                             Messages_CLPing,
+                                                             CreateSVPing(builder).Union());
+                                    });
+    _responses.RegisterSuccess = EncodeMessage([](flatbuffers::FlatBufferBuilder& builder)
+                                               {
+                                                   return CreateMessage(builder,
+                                                                        0,
+                                                                        Messages_SVRegister,
+                                                                        CreateSVRegister(builder, RegistrationStatus_SUCCESS).Union());
+                                               });
+    _responses.RegisterEmailTaken = EncodeMessage([](flatbuffers::FlatBufferBuilder& builder)
+                                                  {
+                                                      return CreateMessage(builder,
+                                                                           0,
+                                                                           Messages_SVRegister,
+                                                                           CreateSVRegister(builder, RegistrationStatus_EMAIL_TAKEN).Union());
+                                                  });
+    _responses.LoginSuccess = EncodeMessage([](flatbuffers::FlatBufferBuilder& builder)
+                                            {
+                                                return CreateMessage(builder,
+                                                                     0,
+                                                                     Messages_SVLogin,
+                                                                     CreateSVLogin(builder, LoginStatus_SUCCESS).Union());
+                                            });
+    _responses.LoginWrongInput = EncodeMessage([](flatbuffers::FlatBufferBuilder& builder)
+                                               {
+                                                   return CreateMessage(builder,
+                                                                        0,
+                                                                        Messages_SVLogin,
+                                                                        CreateSVLogin(builder, LoginStatus_WRONG_INPUT).Union());
+                                               });
+
+    LOG_INFO(_logger) << "Labyrinth core version: " << GAMECORE_MAJOR_VERSION << "." << GAMECORE_MINOR_VERSION << "." << GAMECORE_BUILD_VERSION;
+    LOG_INFO(_logger) << "[----------------------PLATFORM INFO---------------------]";
     {
-        _logger.Info() << "Operating System: " << Poco::Environment::osDisplayName() << " "
+        LOG_INFO(_logger) << "Operating System: " << Poco::Environment::osDisplayName() << " "
         << Poco::Environment::osVersion() << " "
         << Poco::Environment::osArchitecture();
-        _logger.Info() << "MasterServer linked against POCO version: "
+        LOG_INFO(_logger) << "MasterServer linked against POCO version: "
         << ((Poco::Environment::libraryVersion() >> 24) & 0xFF) << "."
         << ((Poco::Environment::libraryVersion() >> 16) & 0xFF) << "."
         << ((Poco::Environment::libraryVersion() >> 8) & 0xFF) << "."
         << ((Poco::Environment::libraryVersion() & 0xFF));
     }
 
-    _logger.Info() << "[------------------SYBSYSTEMS BOOTSTRAP------------------]";
+    LOG_INFO(_logger) << "[------------------SYBSYSTEMS BOOTSTRAP------------------]";
 
         // Init Net
-    _logger.Info() << "[------------------------NETWORK-------------------------]";
+    LOG_INFO(_logger) << "[------------------------NETWORK-------------------------]";
 
         // Check inet connection
     try
@@ -305,11 +276,23 @@ MasterServer::MasterServer()
         exit(1);
     }
 
-        // Init gameservers threadpool
-    _logger.Info() << "[----------------GAME SERVERS CONTROLLER-----------------]";
+        // Init gameservers threadpool and game hosts control channel
+    LOG_INFO(_logger) << "[----------------GAME SERVERS CONTROLLER-----------------]";
     try
     {
-        _gameserversController = std::make_unique<GameServersController>();
+        _gameFleet = std::make_unique<GameFleet>();
+        _matchmaker = std::make_unique<Matchmaker>(*_gameFleet,
+                                                   [this](const std::vector<Matchmaker::Ticket>& players,
+                                                          const GameEndpoint& endpoint)
+                                                   {
+                                                       SendGameFound(players, endpoint);
+                                                   },
+                                                   [this](const Matchmaker::Ticket& ticket)
+                                                   {
+                                                       SendFindGameStatus(ticket.Recipient,
+                                                                          ticket.PlayerUid,
+                                                                          ConnectionResponse_REFUSED);
+                                                   });
     }
     catch(const std::exception& e)
     {
@@ -317,11 +300,13 @@ MasterServer::MasterServer()
     }
 
         // Init DB
-    _logger.Info() << "[---------------DATABASE ACCESSOR SERVICE----------------]";
+    LOG_INFO(_logger) << "[---------------DATABASE ACCESSOR SERVICE----------------]";
 
     try
     {
         DatabaseAccessor::Instance();
+        MatchHistory::Instance();
+        Leaderboard::Instance();
     }
     catch(const std::exception& e)
     {
@@ -331,7 +316,7 @@ MasterServer::MasterServer()
         exit(2);
     }
 
-    _logger.Info() << "[---------------------SYSTEM MONITOR---------------------]";
+    LOG_INFO(_logger) << "[---------------------SYSTEM MONITOR---------------------]";
 
     try
     {
@@ -343,90 +328,429 @@ MasterServer::MasterServer()
     }
 
         // Everything done
-    _logger.Info() << "[-------------SYBSYSTEMS BOOTSTRAP COMPLETED-------------]\n\n";
+    LOG_INFO(_logger) << "[-------------SYBSYSTEMS BOOTSTRAP COMPLETED-------------]\n\n";
 }
 
 
 MasterServer::~MasterServer()
 {
-    _logger.Info() << "Waiting all workers to complete";
-    _taskWorkers.collect();
+    LOG_INFO(_logger) << "Stopping matchmaker";
+    _matchmaker.reset();
+    _gameFleet.reset();
+}
+
+
+void
+MasterServer::Register(const Poco::Net::SocketAddress& recipient,
+                       const flatbuffers::String* email,
+                       const flatbuffers::String* password)
+{
+    auto request = AcquireRequest(_registrations);
+    request->Setup(recipient, email, password);
+
+        // reply is sent from the database worker, master thread goes on receiving
+    DatabaseAccessor::Instance().Query(request->Query, *request);
+}
+
+
+void
+MasterServer::Login(const Poco::Net::SocketAddress& recipient,
+                    const flatbuffers::String* email,
+                    const flatbuffers::String* password)
+{
+    auto request = AcquireRequest(_logins);
+    request->Setup(recipient, email, password);
+
+        // reply is sent from the database worker, master thread goes on receiving
+    DatabaseAccessor::Instance().Query(request->Query, *request);
+}
+
+
+void
+MasterServer::Answer(const Poco::Net::SocketAddress& recipient,
+                     const DBQuery::RegisterQuery& query,
+                     const DBQuery::RegisterResult& result,
+                     std::exception_ptr error)
+{
+    static const LogHandle logger(NamedLogger::Channel("RegistrationTask"));
+
+    if(error)
+    {
+        try
+        {
+            std::rethrow_exception(error);
+        }
+        catch(const std::exception& e)
+        {
+            logger.Error() << "DatabaseAccessor returned exception: " << e.what();
+        }
+        return;
+    }
+
+        // shed under load, client retries
+    if(result.Outcome != DBQuery::Status::OK)
+    {
+        logger.Warning() << "Query for " << query.Email << " was not executed: " << OutcomeName(result.Outcome);
+        return;
+    }
+
+    if(result.Success)
+    {
+        LOG_DEBUG(logger) << "User " << query.Email << " registrated successfully";
+        SendResponse(_responses.RegisterSuccess, recipient);
+    }
+    else
+    {
+        LOG_DEBUG(logger) << "User " << query.Email << " failed to register: email has been already taken";
+        SendResponse(_responses.RegisterEmailTaken, recipient);
+    }
+}
+
+
+void
+MasterServer::Answer(const Poco::Net::SocketAddress& recipient,
+                     const DBQuery::LoginQuery& query,
+                     const DBQuery::LoginResult& result,
+                     std::exception_ptr error)
+{
+    static const LogHandle logger(NamedLogger::Channel("LoginTask"));
+
+    if(error)
+    {
+        try
+        {
+            std::rethrow_exception(error);
+        }
+        catch(const std::exception& e)
+        {
+            logger.Error() << "DatabaseAccessor returned exception: " << e.what();
+        }
+        return;
+    }
+
+        // shed under load, client retries
+    if(result.Outcome != DBQuery::Status::OK)
+    {
+        logger.Warning() << "Query for " << query.Email << " was not executed: " << OutcomeName(result.Outcome);
+        return;
+    }
+
+    if(result.Success)
+    {
+        LOG_DEBUG(logger) << "Player " << query.Email << " logged in";
+        SendResponse(_responses.LoginSuccess, recipient);
+    }
+    else // player is not registered, or wrong password
+    {
+        LOG_DEBUG(logger) << "Player " << query.Email << " failed to log in: wrong pass or email";
+        SendResponse(_responses.LoginWrongInput, recipient);
+    }
+}
+
+
+template<typename TQuery, typename TResult>
+MasterServer::AuthRequest<TQuery, TResult>*
+MasterServer::AcquireRequest(AuthPool<TQuery, TResult>& pool)
+{
+    std::lock_guard<std::mutex> l(pool.Mutex);
+
+        // grows to the number of queries in flight, bounded by the database queue
+    if(pool.Free.empty())
+    {
+        pool.Requests.push_back(std::make_unique<AuthRequest<TQuery, TResult>>(*this, pool));
+        pool.Free.push_back(pool.Requests.back().get());
+    }
+
+    auto request = pool.Free.back();
+    pool.Free.pop_back();
+    return request;
+}
+
+
+void
+MasterServer::FindGame(const Poco::Net::SocketAddress& recipient,
+                       const CLFindGame* request)
+{
+    Matchmaker::Ticket ticket;
+    ticket.Recipient = recipient;
+    ticket.PlayerUid = request->player_uid();
+    ticket.LobbySize = request->lobby_size();
+    ticket.Rtt = request->rtt();
+    ticket.Enqueued = std::chrono::steady_clock::now();
+
+    if(!_matchmaker || !_matchmaker->Enqueue(ticket))
+    {
+        _refused.Report(FIND_GAME_REFUSED, recipient);
+        SendFindGameStatus(recipient,
+                           ticket.PlayerUid,
+                           ConnectionResponse_REFUSED);
+        return;
+    }
+
+    SendFindGameStatus(recipient,
+                       ticket.PlayerUid,
+                       ConnectionResponse_ACCEPTED);
+}
+
+
+void
+MasterServer::SendGameFound(const std::vector<Matchmaker::Ticket>& players,
+                            const GameEndpoint& endpoint)
+{
+        // the same message goes to every player of the match
+    thread_local flatbuffers::FlatBufferBuilder builder;
+    builder.Clear();
+
+    auto gameFound = CreateSVGameFound(builder,
+                                       endpoint.Port,
+                                       builder.CreateString(endpoint.Host));
+    auto message = CreateMessage(builder,
+                                 0,
+                                 Messages_SVGameFound,
+                                 gameFound.Union());
+    builder.Finish(message);
+
+    for(auto& player : players)
+    {
+        LOG_DEBUG(_logger) << "Found game for [" << player.Recipient.toString() << "] on "
+                           << (endpoint.Host.empty() ? "master" : endpoint.Host) << ":" << endpoint.Port;
+        _socket.sendTo(builder.GetBufferPointer(),
+                       builder.GetSize(),
+                       player.Recipient);
+    }
+}
+
+
+void
+MasterServer::SendFindGameStatus(const Poco::Net::SocketAddress& recipient,
+                                 uint32_t playerUid,
+                                 ConnectionResponse status)
+{
+    thread_local flatbuffers::FlatBufferBuilder builder;
+    builder.Clear();
+
+    auto findGame = CreateSVFindGame(builder,
+                                     playerUid,
+                                     status);
+    auto message = CreateMessage(builder,
+                                 0,
+                                 Messages_SVFindGame,
+                                 findGame.Union());
+    builder.Finish(message);
+
+    _socket.sendTo(builder.GetBufferPointer(),
+                   builder.GetSize(),
+                   recipient);
+}
+
+
+void
+MasterServer::SendLeaderboard(const Poco::Net::SocketAddress& recipient,
+                              const std::string& name)
+{
+        // answered in place: in-memory lookups only, builder is reused by the receive loop
+    static flatbuffers::FlatBufferBuilder builder;
+    builder.Clear();
+
+        // UDP senders are not verified, the reply must not become an amplifier
+    auto now = std::chrono::steady_clock::now();
+    if(now - _topWindow >= 1s)
+    {
+        _topWindow = now;
+        _topReplies = 0;
+    }
+    bool withTop = _topReplies < TOP_REPLIES_PER_SECOND;
+    if(withTop)
+        ++_topReplies;
+    else
+        _refused.Report(LEADERBOARD_LIMITED, recipient);
+
+    _top.clear();
+    uint32_t rank = 0;
+    uint32_t points = 0;
+    Leaderboard::Instance().Read([&](const Ranking& ranking)
+                                 {
+                                     if(withTop)
+                                     {
+                                         for(auto& score : ranking.Top())
+                                             _top.push_back(CreateLeaderboardEntry(builder,
+                                                                                   builder.CreateString(score.Name),
+                                                                                   score.Points,
+                                                                                   score.Wins,
+                                                                                   score.Kills,
+                                                                                   score.Deaths));
+                                     }
+
+                                     rank = ranking.Rank(name);
+                                     if(auto score = ranking.Find(name))
+                                         points = score->Points;
+                                 });
+
+    auto leaderboard = CreateSVLeaderboard(builder,
+                                           builder.CreateVector(_top),
+                                           rank,
+                                           points);
+    auto message = CreateMessage(builder,
+                                 0,
+                                 Messages_SVLeaderboard,
+                                 leaderboard.Union());
+    builder.Finish(message);
+
+    _socket.sendTo(builder.GetBufferPointer(),
+                   builder.GetSize(),
+                   recipient);
+}
+
+
+void
+MasterServer::SendStats(const Poco::Net::SocketAddress& recipient,
+                        uint32_t admKey)
+{
+        // wrong keys are not answered, the reply is much larger than the request
+    if(!_admKey || admKey != _admKey)
+    {
+        _refused.Report(INVALID_ADMIN_KEY, recipient);
+        return;
+    }
+
+    std::ostringstream json;
+    json << "{";
+
+    if(auto local = _gameFleet ? _gameFleet->GetLocalServers() : nullptr)
+    {
+        auto servers = local->GetStats();
+        json << "\"games\":{\"running\":" << servers.Games << ",\"lobbies\":" << servers.Lobbies
+             << ",\"standby\":" << servers.Warm << "},";
+        json << "\"servers\":[";
+        for(size_t idx = 0; idx < servers.Servers.size(); ++idx)
+        {
+            auto& server = servers.Servers[idx];
+            json << (idx ? "," : "") << "{\"port\":" << server.Port << ",\"state\":\"" << StateName(server.ServerState)
+                 << "\",\"players\":" << server.Players << ",\"tick_us\":";
+            WritePercentiles(json, server.TickP50, server.TickP95, server.TickP99);
+            json << ",\"utilization\":" << server.Utilization << ",\"overruns\":" << server.Overruns << "}";
+        }
+        json << "],";
+        json << "\"game_workers\":{\"used\":" << servers.WorkersUsed << ",\"capacity\":" << servers.Workers << "},";
+    }
+
+    if(_gameFleet)
+    {
+        auto hosts = _gameFleet->GetHosts();
+        json << "\"hosts\":[";
+        for(size_t idx = 0; idx < hosts.size(); ++idx)
+        {
+            auto& host = hosts[idx];
+            json << (idx ? "," : "") << "{\"id\":" << host.HostId << ",\"control\":";
+            WriteString(json, host.Control);
+            json << ",\"public_host\":";
+            WriteString(json, host.PublicHost);
+            json << ",\"capacity\":" << host.Capacity
+                 << ",\"standby\":" << host.Standby << ",\"lobbies\":" << host.Lobbies
+                 << ",\"games\":" << host.Games << ",\"cores\":" << host.Cores << ",\"players\":" << host.Players
+                 << ",\"utilization\":" << host.Utilization << ",\"overruns\":" << host.Overruns << "}";
+        }
+        json << "],";
+    }
+
+    auto db = DatabaseAccessor::Instance().GetMetrics();
+    json << "\"queues\":{\"matchmaker\":" << (_matchmaker ? _matchmaker->Waiting() : 0)
+         << ",\"database\":" << db.QueueDepth
+         << ",\"match_history\":" << MatchHistory::Instance().Pending() << "},";
+    json << "\"database\":{\"latency_us\":";
+    WritePercentiles(json, db.LatencyP50, db.LatencyP95, db.LatencyP99);
+    json << ",\"wait_us\":{\"avg\":" << db.AverageWait.count() << ",\"max\":" << db.MaxWait.count() << "}"
+         << ",\"max_queue\":" << db.MaxQueueDepth << ",\"executed\":" << db.Executed
+         << ",\"overloaded\":" << db.Overloaded << ",\"timed_out\":" << db.TimedOut << "},";
+    json << "\"rss_kb\":" << SystemMonitor::CurrentRSS() / 1024 << ",\"peak_rss_kb\":" << SystemMonitor::PeakRSS() / 1024;
+    json << "}";
+
+    flatbuffers::FlatBufferBuilder builder;
+    auto response = CreateSV_ADM_Stats(builder,
+                                       builder.CreateString(json.str()));
+    auto message = CreateMessage(builder,
+                                 0,
+                                 Messages_SV_ADM_Stats,
+                                 response.Union());
+    builder.Finish(message);
+
+    _socket.sendTo(builder.GetBufferPointer(),
+                   builder.GetSize(),
+                   recipient);
+}
+
+
+void
+MasterServer::SendResponse(const std::vector<uint8_t>& response,
+                           const Poco::Net::SocketAddress& recipient)
+{
+    _socket.sendTo(response.data(),
+                   response.size(),
+                   recipient);
 }
 
 
 void MasterServer::run()
 {
-    _logger.Info() << "[----------------MASTERSERVER IS RUNNING-----------------]";
+    LOG_INFO(_logger) << "[----------------MASTERSERVER IS RUNNING-----------------]";
+
+    SafePacketGetter packetGetter(_socket);
+    Packet packet;
     while(true)
     {
-        SafePacketGetter packetGetter(_socket);
-        auto packet = packetGetter.Get<MasterMessage::Message>();
-        if(!packet)
+        packetGetter.FlushWarnings();
+        _refused.Flush();
+        if(!packetGetter.Get<MasterMessage::Message>(packet))
             continue;
 
-        auto msg = GetMessage(packet->Data.data());
+        auto msg = GetMessage(packet.Data.data());
 
         switch(msg->payload_type())
         {
         case Messages_CLPing:
         {
-            flatbuffers::FlatBufferBuilder builder;
-            auto pong = CreateSVPing(builder);
-            auto smsg = CreateMessage(builder,
-                                      0,
-                                      Messages_CLPing,
-                                      pong.Union());
-            builder.Finish(smsg);
-
-            _socket.sendTo(builder.GetBufferPointer(),
-                           builder.GetSize(),
-                           packet->Sender);
+            SendResponse(_responses.Ping, packet.Sender);
             break;
         }
 
         case Messages_CLRegister:
         {
-            if(_taskWorkers.available())
-            {
-                auto registr = static_cast<const CLRegister*>(msg->payload());
-                _taskManager.start(new RegistrationTask(*this,
-                                                        packet->Sender,
-                                                        std::string(registr->email()->c_str()),
-                                                        std::string(registr->password()->c_str())));
-            }
-            else
-                _logger.Warning() << "No workers available, task skipped";
-
+            auto registr = static_cast<const CLRegister*>(msg->payload());
+            Register(packet.Sender,
+                     registr->email(),
+                     registr->password());
             break;
         }
 
         case Messages_CLLogin:
         {
-            if(_taskWorkers.available())
-            {
-                auto login = static_cast<const CLLogin*>(msg->payload());
-                _taskManager.start(new LoginTask(*this,
-                                                 packet->Sender,
-                                                 std::string(login->email()->c_str()),
-                                                 std::string(login->password()->c_str())));
-            }
-            else
-                _logger.Warning() << "No workers available, task skipped";
+            auto login = static_cast<const CLLogin*>(msg->payload());
+            Login(packet.Sender,
+                  login->email(),
+                  login->password());
+            break;
+        }
 
+        case Messages_CLLeaderboard:
+        {
+            auto leaderboard = static_cast<const CLLeaderboard*>(msg->payload());
+            SendLeaderboard(packet.Sender,
+                            leaderboard->name() ? leaderboard->name()->str() : std::string());
             break;
         }
 
-        case Messages_CLFindGame:
+        case Messages_CL_ADM_Stats:
         {
-            if(_taskWorkers.available())
-            {
-                auto finder = static_cast<const CLFindGame*>(msg->payload());
-                _taskManager.start(new FindGameTask(*this,
-                                                    packet->Sender));
-            }
-            else
-                _logger.Warning() << "No workers available, task skipped";
+            auto stats = static_cast<const CL_ADM_Stats*>(msg->payload());
+            SendStats(packet.Sender,
+                      stats->adm_key());
+            break;
+        }
 
+        case Messages_CLFindGame:
+        {
+            FindGame(packet.Sender,
+                     static_cast<const CLFindGame*>(msg->payload()));
             break;
         }
 
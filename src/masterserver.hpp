@@ -9,10 +9,13 @@
 #ifndef masterserver_hpp
 #define masterserver_hpp
 
-#include "GameServersController.hpp"
+#include "game_fleet.hpp"
+#include "MasterMessage.h"
 #include "services/system_monitor.hpp"
 #include "services/DatabaseAccessor.hpp"
+#include "services/matchmaker.hpp"
 #include "toolkit/named_logger.hpp"
+#include "toolkit/rate_limited_log.hpp"
 
 #include <Poco/Data/SessionFactory.h>
 #include <Poco/Net/DatagramSocket.h>
@@ -22,6 +25,7 @@
 #include <Poco/Timer.h>
 
 #include <array>
+#include <chrono>
 #include <deque>
 #include <future>
 #include <memory>
@@ -35,33 +39,104 @@
 class MasterServer : public Poco::Runnable
 {
 private:
-    class RegistrationTask;
-    class LoginTask;
-    class FindGameTask;
+        // requests dropped without a reply, warnings about them come in floods
+    enum RefusedRequest
+    {
+        INVALID_ADMIN_KEY,
+        FIND_GAME_REFUSED,
+        LEADERBOARD_LIMITED
+    };
+
+        // Responses which never change, encoded once at startup
+    struct EncodedResponses
+    {
+        std::vector<uint8_t>    Ping;
+        std::vector<uint8_t>    RegisterSuccess;
+        std::vector<uint8_t>    RegisterEmailTaken;
+        std::vector<uint8_t>    LoginSuccess;
+        std::vector<uint8_t>    LoginWrongInput;
+    };
+
+    template<typename TQuery, typename TResult>
+    class AuthRequest;
+
+        // account requests waiting for the database, reused once answered
+    template<typename TQuery, typename TResult>
+    struct AuthPool
+    {
+        std::mutex                                                      Mutex;
+        std::vector<std::unique_ptr<AuthRequest<TQuery, TResult>>>      Requests;
+        std::vector<AuthRequest<TQuery, TResult>*>                      Free;
+    };
 
 public:
-    MasterServer();
+    /*
+     * admKey authorizes CL_ADM_* requests, 0 disables them.
+     */
+    MasterServer(uint32_t admKey = 0);
     ~MasterServer();
 
     virtual void run() override;
 
+protected:
+        // answered from DatabaseAccessor workers
+    void Register(const Poco::Net::SocketAddress& recipient,
+                  const flatbuffers::String* email,
+                  const flatbuffers::String* password);
+    void Login(const Poco::Net::SocketAddress& recipient,
+               const flatbuffers::String* email,
+               const flatbuffers::String* password);
+    void Answer(const Poco::Net::SocketAddress& recipient,
+                const DBQuery::RegisterQuery& query,
+                const DBQuery::RegisterResult& result,
+                std::exception_ptr error);
+    void Answer(const Poco::Net::SocketAddress& recipient,
+                const DBQuery::LoginQuery& query,
+                const DBQuery::LoginResult& result,
+                std::exception_ptr error);
+
+    template<typename TQuery, typename TResult>
+    AuthRequest<TQuery, TResult>* AcquireRequest(AuthPool<TQuery, TResult>& pool);
+
+    void FindGame(const Poco::Net::SocketAddress& recipient,
+                  const MasterMessage::CLFindGame* request);
+    void SendGameFound(const std::vector<Matchmaker::Ticket>& players,
+                       const GameEndpoint& endpoint);
+    void SendFindGameStatus(const Poco::Net::SocketAddress& recipient,
+                            uint32_t playerUid,
+                            MasterMessage::ConnectionResponse status);
+
+    void SendLeaderboard(const Poco::Net::SocketAddress& recipient,
+                         const std::string& name);
+
+    void SendStats(const Poco::Net::SocketAddress& recipient,
+                   uint32_t admKey);
+
+    void SendResponse(const std::vector<uint8_t>& response,
+                      const Poco::Net::SocketAddress& recipient);
+
 protected:
     NamedLogger                             _logger;
+    uint32_t                                _admKey;
 
         // Network
     Poco::Net::DatagramSocket               _socket;
 
-        // Processing
-    Poco::ThreadPool                        _taskWorkers;
-    Poco::TaskManager                       _taskManager;
+    EncodedResponses                        _responses;
+    RateLimitedLog                          _refused;       // receive thread only
+
+        // leaderboard replies with the top list, few per second: the request is tiny, the list is not
+    std::vector<flatbuffers::Offset<MasterMessage::LeaderboardEntry>>  _top;
+    std::chrono::steady_clock::time_point   _topWindow;
+    uint32_t                                _topReplies;
+
+    AuthPool<DBQuery::RegisterQuery, DBQuery::RegisterResult>   _registrations;
+    AuthPool<DBQuery::LoginQuery, DBQuery::LoginResult>         _logins;
 
         // Subsystems
     std::unique_ptr<SystemMonitor>          _systemMonitor;
-    std::unique_ptr<GameServersController>  _gameserversController;
-
-    friend RegistrationTask;
-    friend LoginTask;
-    friend FindGameTask;
+    std::unique_ptr<GameFleet>              _gameFleet;
+    std::unique_ptr<Matchmaker>             _matchmaker;
 };
 
 #endif /* masterserver_hpp */
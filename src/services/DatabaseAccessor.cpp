@@ -8,178 +8,458 @@
 
 #include "DatabaseAccessor.hpp"
 
-#include <Poco/Data/MySQL/Connector.h>
 #include <Poco/Observer.h>
 
+#include <algorithm>
+#include <stdexcept>
 
-class DatabaseAccessor::RegisterTask : public Poco::Task
+
+/*
+ * List of admitted queries executed with one storage call.
+ * Queries which spent more than Deadline in the queue are answered with TIMED_OUT and skipped.
+ * Jobs are pooled per query type: the pending list keeps its capacity and goes back to the batch
+ * the next time the job is taken.
+ */
+template<typename TQuery, typename TResult>
+class DatabaseAccessor::QueryJob : public DatabaseAccessor::Job
 {
 public:
-    RegisterTask(Poco::Data::Session session,
-                 std::unique_ptr<std::promise<DBQuery::RegisterResult>> promise,
-                 const DBQuery::RegisterQuery& reg)
-    : Task("registrationDatabaseTask"),
-      _dbSession(session),
-      _promise(std::move(promise)),
-      _taskInfo(reg)
+    QueryJob(DatabaseAccessor& accessor,
+             PendingBatch<TQuery, TResult>& batch)
+    : _accessor(accessor),
+      _batch(batch)
     { }
 
-    void runTask()
+        // batch.Mutex is held, the empty list of the last run is left in place of the taken one
+    void Take(std::vector<PendingQuery<TQuery, TResult>>& queries)
+    { _pending.swap(queries); }
+
+    virtual size_t Size() const override
+    { return _pending.size(); }
+
+    virtual void Run() override
     {
-        using namespace Poco::Data::Keywords;
+        auto now = Clock::now();
+        auto deadline = DatabaseAccessor::_config.Deadline;
+
+            // per worker scratch, cleared but never shrunk
+        thread_local std::vector<Clock::duration> waits;
+        thread_local std::vector<TQuery> queries;
+        thread_local std::vector<size_t> live;
+        waits.clear();
+        queries.clear();
+        live.clear();
+
+        for(size_t i = 0; i < _pending.size(); ++i)
+        {
+            auto wait = now - _pending[i].Enqueued;
+            waits.push_back(wait);
+
+            if(deadline.count() && wait > deadline)
+            {
+                TResult result {};
+                result.Outcome = DBQuery::Status::TIMED_OUT;
+                Complete(_pending[i], result, nullptr);
+                continue;
+            }
+
+                // strings change hands instead of being copied, the caller gets them back before Done
+            queries.emplace_back();
+            std::swap(queries.back(), *_pending[i].Query);
+            live.push_back(i);
+        }
 
-        DBQuery::RegisterResult result;
-        size_t already_registered = 0;
+        _accessor.RecordWaits(waits, _pending.size() - live.size());
+        if(!queries.empty())
+            Execute(queries, live);
 
+        Recycle();
+    }
+
+private:
+    void Execute(std::vector<TQuery>& queries, const std::vector<size_t>& live)
+    {
+        std::vector<TResult> results;
         try
         {
-            Poco::Data::Statement select(_dbSession);
-            select << "SELECT COUNT(*) FROM user WHERE email=?", into(already_registered), use(_taskInfo.Email), now;
+            results = Execute(queries);
         }
         catch(...)
         {
-            _promise->set_exception(std::current_exception());
-            setState(Poco::Task::TaskState::TASK_FINISHED);
+            auto error = std::current_exception();
+            for(size_t i = 0; i < live.size(); ++i)
+            {
+                std::swap(queries[i], *_pending[live[i]].Query);
+                Complete(_pending[live[i]], TResult {}, error);
+            }
             return;
         }
 
-        if(!already_registered)
+        auto done = Clock::now();
+        auto answered = std::min(results.size(), live.size());
+        for(size_t i = 0; i < answered; ++i)
         {
-            try
-            {
-                Poco::Data::Statement insert(_dbSession);
-                insert << "INSERT INTO user(email, password) VALUES(?, ?)", use(_taskInfo.Email), use(_taskInfo.Password), now;
-            }
-            catch(...)
-            {
-                _promise->set_exception(std::current_exception());
-                setState(Poco::Task::TaskState::TASK_FINISHED);
-                return;
-            }
+            auto& pending = _pending[live[i]];
+            _accessor.Remember(queries[i], results[i]);
+            _accessor._latency.Record(std::chrono::duration_cast<std::chrono::microseconds>(done - pending.Enqueued));
 
-            result.Success = true;
+            std::swap(queries[i], *pending.Query);
+            Complete(pending, results[i], nullptr);
         }
-        else
-            result.Success = false;
 
-        _promise->set_value(result);
-        setState(Poco::Task::TaskState::TASK_FINISHED);
+        if(results.size() == live.size())
+            return;
+
+            // a backend bug, but every caller still has to get an answer
+        _accessor._logger.Error() << "Storage answered " << results.size() << " of " << live.size() << " queries";
+        auto error = std::make_exception_ptr(std::runtime_error("storage returned no result for the query"));
+        for(size_t i = answered; i < live.size(); ++i)
+        {
+            std::swap(queries[i], *_pending[live[i]].Query);
+            Complete(_pending[live[i]], TResult {}, error);
+        }
+    }
+
+        // a throwing completion must not take the worker down
+    void Complete(PendingQuery<TQuery, TResult>& pending, const TResult& result, std::exception_ptr error)
+    {
+        try
+        {
+            pending.Done->Done(result, error);
+        }
+        catch(const std::exception& e)
+        {
+            _accessor._logger.Error() << "Query completion thrown: " << e.what();
+        }
     }
 
+    void Recycle()
+    {
+        _pending.clear();
+
+        std::lock_guard<std::mutex> l(_batch.Mutex);
+        _batch.FreeJobs.push_back(this);
+    }
+
+    std::vector<DBQuery::RegisterResult> Execute(const std::vector<DBQuery::RegisterQuery>& queries)
+    { return _accessor._backend->Register(queries); }
+
+    std::vector<DBQuery::LoginResult> Execute(const std::vector<DBQuery::LoginQuery>& queries)
+    { return _accessor._backend->Login(queries); }
+
 private:
-    Poco::Data::Session                                      _dbSession;
-    std::unique_ptr<std::promise<DBQuery::RegisterResult>>   _promise;
-    DBQuery::RegisterQuery                                   _taskInfo;
+    DatabaseAccessor&                               _accessor;
+    PendingBatch<TQuery, TResult>&                  _batch;
+    std::vector<PendingQuery<TQuery, TResult>>      _pending;
 };
 
 
-class DatabaseAccessor::LoginTask : public Poco::Task
+/*
+ * One per query type while batching is on. Wakes up for the first query of a batch, waits BatchWindow
+ * and queues everything collected meanwhile.
+ */
+template<typename TQuery, typename TResult>
+class DatabaseAccessor::FlushTask : public Poco::Task
 {
 public:
-    LoginTask(Poco::Data::Session session,
-              std::unique_ptr<std::promise<DBQuery::LoginResult>> promise,
-              const DBQuery::LoginQuery& log)
-    : Task("loginDatabaseTask"),
-      _dbSession(session),
-      _promise(std::move(promise)),
-      _taskInfo(log)
+    FlushTask(DatabaseAccessor& accessor,
+              PendingBatch<TQuery, TResult>& batch)
+    : Task("batchFlushTask"),
+      _accessor(accessor),
+      _batch(batch)
     { }
 
     void runTask()
     {
-        using namespace Poco::Data::Keywords;
+        while(!isCancelled())
+        {
+            {
+                std::unique_lock<std::mutex> l(_batch.Mutex);
+                if(!_batch.Scheduled.wait_for(l,
+                                              std::chrono::milliseconds(100),
+                                              [this]{ return _batch.FlushScheduled; }))
+                    continue;
+            }
 
-        DBQuery::LoginResult result;
-        Poco::Nullable<std::string> storedPass;
+            if(sleep(DatabaseAccessor::_config.BatchWindow.count()))
+                break;
 
-        try
-        {
-            Poco::Data::Statement select(_dbSession);
-            select << "SELECT PASSWORD FROM user WHERE email=?", into(storedPass), use(_taskInfo.Email), now;
-        }
-        catch(...)
-        {
-            _promise->set_exception(std::current_exception());
-            setState(Poco::Task::TaskState::TASK_FINISHED);
-            return;
+            std::lock_guard<std::mutex> l(_batch.Mutex);
+            _batch.FlushScheduled = false;
+            if(!_batch.Queries.empty())
+                _accessor.Push(_accessor.TakeJob(_batch));
         }
 
-        if(!storedPass.isNull())
+        setState(Poco::Task::TaskState::TASK_FINISHED);
+    }
+
+private:
+    DatabaseAccessor&                   _accessor;
+    PendingBatch<TQuery, TResult>&      _batch;
+};
+
+
+/*
+ * Takes jobs from the queue until cancelled.
+ */
+class DatabaseAccessor::Worker : public Poco::Task
+{
+public:
+    Worker(DatabaseAccessor& accessor)
+    : Task("databaseWorker"),
+      _accessor(accessor)
+    { }
+
+    void runTask()
+    {
+        while(!isCancelled())
         {
-            if(storedPass == _taskInfo.Password)
-                result.Success = true;
-            else
-                result.Success = false;
+            if(auto job = _accessor.Pop(std::chrono::milliseconds(100)))
+                job->Run();
         }
-        else
-            result.Success = false;
 
-        _promise->set_value(result);
         setState(Poco::Task::TaskState::TASK_FINISHED);
     }
 
 private:
-    Poco::Data::Session                                  _dbSession;
-    std::unique_ptr<std::promise<DBQuery::LoginResult>>  _promise;
-    DBQuery::LoginQuery                                  _taskInfo;
+    DatabaseAccessor&   _accessor;
 };
 
 
+DatabaseAccessor::Configuration DatabaseAccessor::_config = { std::chrono::milliseconds(0), 64, "mysql", 1024, std::chrono::milliseconds(3000) };
+
+
 DatabaseAccessor::DatabaseAccessor()
 : _logger("DatabaseAccessor", NamedLogger::Mode::STDIO),
-  _workers("DatabaseAccessorWorkers", 8, 16, 60),
+      // workers plus a flush task per batch type
+  _workers("DatabaseAccessorWorkers", WORKERS + 2, WORKERS + 2, 60),
   _taskManager(_workers),
-  _dbSessions("MySQL", "host=127.0.0.1;user=labyrinth;db=labyrinth;password=labyrinthdb;compress=true;auto-reconnect=true", 16)
+  _backend(StorageBackend::Create(_config.Storage)),
+  _queue(std::max<size_t>(_config.QueueCapacity, 1)),
+  _queueHead(0),
+  _queueSize(0),
+  _queuedQueries(0),
+  _metrics(),
+  _totalWait(0),
+  _waited(0)
 {
-    Poco::Data::MySQL::Connector::registerConnector();
+    _taskManager.addObserver(Poco::Observer<ProgressHandler, Poco::TaskStartedNotification>(_progressHandler,
+                                                                                            &ProgressHandler::onStarted));
+    _taskManager.addObserver(Poco::Observer<ProgressHandler, Poco::TaskFinishedNotification>(_progressHandler,
+                                                                                             &ProgressHandler::onFinished));
+
+    for(int i = 0; i < WORKERS; ++i)
+        _taskManager.start(new Worker(*this));
 
-        // Check the database connectivity
+    LOG_DEBUG(_logger) << "DatabaseAccessor service is up, number of workers: " << WORKERS << ", storage: " << _backend->Name();
+    LOG_DEBUG(_logger) << "Queue capacity: " << _config.QueueCapacity << ", deadline: " << _config.Deadline.count() << "ms";
+    if(_config.BatchWindow.count())
     {
-        using namespace Poco::Data::Keywords;
-        size_t registered_players = 0;
-        Poco::Data::Session test_session(_dbSessions.get());
-        Poco::Data::Statement select(test_session);
-        select << "SELECT COUNT(*) FROM user", into(registered_players), now;
+        _taskManager.start(new FlushTask<DBQuery::RegisterQuery, DBQuery::RegisterResult>(*this, _registerBatch));
+        _taskManager.start(new FlushTask<DBQuery::LoginQuery, DBQuery::LoginResult>(*this, _loginBatch));
+        LOG_DEBUG(_logger) << "Queries are batched, window: " << _config.BatchWindow.count() << "ms, max batch size: " << _config.MaxBatchSize;
     }
+}
 
-    _logger.Debug() << "DatabaseAccessor service is up, number of workers: " << _workers.capacity() << ", size of SessionsPool: " << _dbSessions.available();
 
-    _taskManager.addObserver(Poco::Observer<ProgressHandler, Poco::TaskStartedNotification>(_progressHandler,
-                                                                                            &ProgressHandler::onStarted));
-    _taskManager.addObserver(Poco::Observer<ProgressHandler, Poco::TaskFinishedNotification>(_progressHandler,
-                                                                                             &ProgressHandler::onFinished));
+DatabaseAccessor::~DatabaseAccessor()
+{
+    _taskManager.cancelAll();
+    _taskManager.joinAll();
+
+        // pool threads end before the storage they used goes away
+    _workers.stopAll();
+    _backend.reset();
 }
 
 
-std::future<DBQuery::RegisterResult>
-DatabaseAccessor::Query(const DBQuery::RegisterQuery& reg)
+void
+DatabaseAccessor::Query(DBQuery::RegisterQuery& reg, Completion<DBQuery::RegisterResult>& completion)
 {
-    std::lock_guard<std::mutex> l(_callGuard);
+    auto cached = _credentials.Find(reg.Email, reg.Password);
+    if(cached == CredentialCache::Lookup::MATCH ||
+       cached == CredentialCache::Lookup::WRONG_PASSWORD)
+    {
+        completion.Done(DBQuery::RegisterResult{ false }, nullptr);
+        return;
+    }
 
-    auto promise = std::make_unique<std::promise<DBQuery::RegisterResult>>();
-    auto future = promise->get_future();
+    if(!Admit())
+    {
+        DBQuery::RegisterResult rejected {};
+        rejected.Outcome = DBQuery::Status::OVERLOADED;
+        completion.Done(rejected, nullptr);
+        return;
+    }
 
-    if(_workers.available())
-        _taskManager.start(new RegisterTask(_dbSessions.get(), std::move(promise), reg));
-    else
-        _logger.Warning() << "No workers, task skipped";
+    Submit(_registerBatch, reg, completion);
+}
+
+
+void
+DatabaseAccessor::Query(DBQuery::LoginQuery& login, Completion<DBQuery::LoginResult>& completion)
+{
+    auto cached = _credentials.Find(login.Email, login.Password);
+    if(cached != CredentialCache::Lookup::MISS)
+    {
+        DBQuery::LoginResult result;
+        result.Registered = (cached != CredentialCache::Lookup::NOT_REGISTERED);
+        result.Success = (cached == CredentialCache::Lookup::MATCH);
+        completion.Done(result, nullptr);
+        return;
+    }
+
+    if(!Admit())
+    {
+        DBQuery::LoginResult rejected {};
+        rejected.Outcome = DBQuery::Status::OVERLOADED;
+        completion.Done(rejected, nullptr);
+        return;
+    }
 
-    return future;
+    Submit(_loginBatch, login, completion);
 }
 
 
-std::future<DBQuery::LoginResult>
-DatabaseAccessor::Query(const DBQuery::LoginQuery& login)
+DatabaseAccessor::Metrics
+DatabaseAccessor::GetMetrics()
 {
-    std::lock_guard<std::mutex> l(_callGuard);
+    Metrics metrics;
+    {
+        std::lock_guard<std::mutex> l(_metricsMutex);
+        metrics = _metrics;
+        if(_waited)
+            metrics.AverageWait = std::chrono::duration_cast<std::chrono::microseconds>(_totalWait / _waited);
+    }
+
+    metrics.LatencyP50 = _latency.Percentile(0.5);
+    metrics.LatencyP95 = _latency.Percentile(0.95);
+    metrics.LatencyP99 = _latency.Percentile(0.99);
+
+    std::lock_guard<std::mutex> l(_queueMutex);
+    metrics.QueueDepth = _queuedQueries;
+    return metrics;
+}
+
+
+template<typename TQuery, typename TResult>
+void
+DatabaseAccessor::Submit(PendingBatch<TQuery, TResult>& batch, TQuery& query, Completion<TResult>& completion)
+{
+    std::lock_guard<std::mutex> l(batch.Mutex);
+    batch.Queries.push_back({ &query, &completion, Clock::now() });
+
+        // without a window every query is a separate round trip
+    if(!_config.BatchWindow.count() || batch.Queries.size() >= _config.MaxBatchSize)
+    {
+        Push(TakeJob(batch));
+    }
+    else if(!batch.FlushScheduled)
+    {
+        batch.FlushScheduled = true;
+        batch.Scheduled.notify_one();
+    }
+}
 
-    auto promise = std::make_unique<std::promise<DBQuery::LoginResult>>();
-    auto future = promise->get_future();
 
-    if(_workers.available())
-        _taskManager.start(new LoginTask(_dbSessions.get(), std::move(promise), login));
-    else
-        _logger.Warning() << "No workers, task skipped";
+template<typename TQuery, typename TResult>
+DatabaseAccessor::QueryJob<TQuery, TResult>*
+DatabaseAccessor::TakeJob(PendingBatch<TQuery, TResult>& batch)
+{
+        // new jobs are made only until there is one per query in flight
+    if(batch.FreeJobs.empty())
+    {
+        batch.Jobs.push_back(std::make_unique<QueryJob<TQuery, TResult>>(*this, batch));
+        batch.FreeJobs.push_back(batch.Jobs.back().get());
+    }
 
-    return future;
+    auto job = batch.FreeJobs.back();
+    batch.FreeJobs.pop_back();
+    job->Take(batch.Queries);
+    return job;
+}
+
+
+bool
+DatabaseAccessor::Admit()
+{
+    size_t depth;
+    {
+        std::lock_guard<std::mutex> l(_queueMutex);
+        if(_queuedQueries >= _config.QueueCapacity)
+            depth = 0;
+        else
+            depth = ++_queuedQueries;
+    }
+
+    std::lock_guard<std::mutex> l(_metricsMutex);
+    if(!depth)
+    {
+        ++_metrics.Overloaded;
+        return false;
+    }
+
+    _metrics.MaxQueueDepth = std::max(_metrics.MaxQueueDepth, depth);
+    return true;
+}
+
+
+void
+DatabaseAccessor::Push(Job* job)
+{
+    {
+        std::lock_guard<std::mutex> l(_queueMutex);
+        _queue[(_queueHead + _queueSize++) % _queue.size()] = job;
+    }
+
+    _queueReady.notify_one();
+}
+
+
+DatabaseAccessor::Job*
+DatabaseAccessor::Pop(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> l(_queueMutex);
+    if(!_queueReady.wait_for(l, timeout, [this]{ return _queueSize != 0; }))
+        return nullptr;
+
+    auto job = _queue[_queueHead];
+    _queueHead = (_queueHead + 1) % _queue.size();
+    --_queueSize;
+    _queuedQueries -= job->Size();
+    return job;
+}
+
+
+void
+DatabaseAccessor::RecordWaits(const std::vector<Clock::duration>& waits, size_t timedOut)
+{
+    std::lock_guard<std::mutex> l(_metricsMutex);
+    for(auto wait : waits)
+    {
+        _totalWait += wait;
+        _metrics.MaxWait = std::max(_metrics.MaxWait, std::chrono::duration_cast<std::chrono::microseconds>(wait));
+    }
+
+    _waited += waits.size();
+    _metrics.Executed += waits.size() - timedOut;
+    _metrics.TimedOut += timedOut;
+}
+
+
+void
+DatabaseAccessor::Remember(const DBQuery::RegisterQuery& query, const DBQuery::RegisterResult& result)
+{
+    if(result.Success)
+        _credentials.StoreVerified(query.Email, query.Password);
+}
+
+
+void
+DatabaseAccessor::Remember(const DBQuery::LoginQuery& query, const DBQuery::LoginResult& result)
+{
+    if(result.Success)
+        _credentials.StoreVerified(query.Email, query.Password);
+    else if(!result.Registered)
+        _credentials.StoreMissing(query.Email);
 }
@@ -9,67 +9,135 @@
 #ifndef DatabaseAccessor_hpp
 #define DatabaseAccessor_hpp
 
+#include "credential_cache.hpp"
+#include "storage_backend.hpp"
+#include "../toolkit/latency_histogram.hpp"
 #include "../toolkit/named_logger.hpp"
 
-#include <Poco/Data/SessionPool.h>
 #include <Poco/TaskManager.h>
 #include <Poco/ThreadPool.h>
 #include <Poco/TaskNotification.h>
 
-#include <future>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 
-namespace DBQuery
+/*
+ * Runs account queries on a fixed set of workers fed from a bounded queue.
+ * Every query is completed exactly once: with the storage answer, with an exception from the storage,
+ * or with OVERLOADED/TIMED_OUT Outcome when the query was shed.
+ * Jobs, the queue and worker scratch are reused, so once warmed up a query allocates nothing here.
+ */
+class DatabaseAccessor
 {
-    struct RegisterQuery
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /*
+     * Receiver of a query answer, owned by the caller. result holds no data when error is set.
+     */
+    template<typename TResult>
+    class Completion
     {
-        std::string Email;
-        std::string Password;
+    public:
+        virtual ~Completion()
+        { }
+
+        virtual void Done(const TResult& result, std::exception_ptr error) = 0;
     };
-    struct RegisterResult
+
+    struct Configuration
     {
-        bool Success;
+        std::chrono::milliseconds   BatchWindow;    // 0 - every query is a separate round trip
+        size_t                      MaxBatchSize;   // batch is flushed early when it's full
+        std::string                 Storage;        // StorageBackend::Create spec
+        size_t                      QueueCapacity;  // admitted queries not yet taken by a worker
+        std::chrono::milliseconds   Deadline;       // max time in the queue, 0 - no deadline
     };
 
-    struct LoginQuery
+    struct Metrics
     {
-        std::string Email;
-        std::string Password;
+        size_t                      QueueDepth;
+        size_t                      MaxQueueDepth;
+        uint64_t                    Executed;
+        uint64_t                    Overloaded;
+        uint64_t                    TimedOut;
+        std::chrono::microseconds   AverageWait;    // time from Query() until a worker took the query
+        std::chrono::microseconds   MaxWait;
+        std::chrono::microseconds   LatencyP50;     // time from Query() until the answer, executed queries
+        std::chrono::microseconds   LatencyP95;
+        std::chrono::microseconds   LatencyP99;
     };
-    struct LoginResult
+
+private:
+    static const int WORKERS = 8;
+
+        // both borrowed from the caller until Done
+    template<typename TQuery, typename TResult>
+    struct PendingQuery
     {
-        bool Success;
+        TQuery *                    Query;
+        Completion<TResult> *       Done;
+        Clock::time_point           Enqueued;
     };
-}
 
+    class Job
+    {
+    public:
+        virtual ~Job()
+        { }
 
-class DatabaseAccessor
-{
-private:
-    class RegisterTask;
-    class LoginTask;
+        virtual size_t Size() const = 0;
+            // the job is back in its pool when Run returns
+        virtual void Run() = 0;
+    };
+
+    template<typename TQuery, typename TResult>
+    class QueryJob;
+
+    template<typename TQuery, typename TResult>
+    struct PendingBatch
+    {
+        std::mutex                                                  Mutex;
+        std::condition_variable                                     Scheduled;
+        std::vector<PendingQuery<TQuery, TResult>>                  Queries;
+        bool                                                        FlushScheduled = false;
+
+            // every job ever made for this query type, queued ones included
+        std::vector<std::unique_ptr<QueryJob<TQuery, TResult>>>     Jobs;
+        std::vector<QueryJob<TQuery, TResult>*>                     FreeJobs;
+    };
+
+    template<typename TQuery, typename TResult>
+    class FlushTask;
+
+    class Worker;
 
     class ProgressHandler
     {
     public:
         ProgressHandler()
-        : _logger("TasksProgressReporter", NamedLogger::Mode::STDIO)
+        : _logger(NamedLogger::Channel("TasksProgressReporter"))
         { }
 
         void onStarted(Poco::TaskStartedNotification* pNf)
         {
-            _logger.Debug() << pNf->task()->name() << " started.";
+            LOG_DEBUG(_logger) << pNf->task()->name() << " started.";
             pNf->release();
         }
 
         void onFinished(Poco::TaskFinishedNotification* pNf)
         {
-            _logger.Debug() << pNf->task()->name() << " finished.";
+            LOG_DEBUG(_logger) << pNf->task()->name() << " finished.";
             pNf->release();
         }
 
     private:
-        NamedLogger     _logger;
+        LogHandle       _logger;
     };
 
 public:
@@ -79,21 +147,78 @@ public:
         return dbAccessor;
     }
 
-    std::future<DBQuery::RegisterResult> Query(const DBQuery::RegisterQuery&);
-    std::future<DBQuery::LoginResult> Query(const DBQuery::LoginQuery&);
+    /*
+     * Has to be called before the first Instance() call.
+     */
+    static void Configure(const Configuration& config)
+    { _config = config; }
+
+    ~DatabaseAccessor();
+
+    /*
+     * completion runs on a database worker, or right away on the calling thread when the answer
+     * is cached or the query is shed. It must not block: the worker serves other queries after it.
+     * query and completion must stay alive and untouched until Done: the worker moves query strings
+     * into its batch and back instead of copying them.
+     */
+    void Query(DBQuery::RegisterQuery& query, Completion<DBQuery::RegisterResult>& completion);
+    void Query(DBQuery::LoginQuery& query, Completion<DBQuery::LoginResult>& completion);
+
+    Metrics GetMetrics();
+
+    /*
+     * For services writing to the same storage on their own threads.
+     */
+    StorageBackend& GetStorage()
+    { return *_backend; }
 
 private:
     DatabaseAccessor();
 
+        // feeds the credentials cache with database answers
+    void Remember(const DBQuery::RegisterQuery& query, const DBQuery::RegisterResult& result);
+    void Remember(const DBQuery::LoginQuery& query, const DBQuery::LoginResult& result);
+
+    template<typename TQuery, typename TResult>
+    void Submit(PendingBatch<TQuery, TResult>& batch, TQuery& query, Completion<TResult>& completion);
+
+        // batch.Mutex is held, the job takes every query collected in the batch
+    template<typename TQuery, typename TResult>
+    QueryJob<TQuery, TResult>* TakeJob(PendingBatch<TQuery, TResult>& batch);
+
+        // queue
+    bool Admit();
+    void Push(Job* job);
+    Job* Pop(std::chrono::milliseconds timeout);
+    void RecordWaits(const std::vector<Clock::duration>& waits, size_t timedOut);
+
 private:
     NamedLogger                             _logger;
 
-    std::mutex                              _callGuard;
-    Poco::TaskManager                       _taskManager;
     Poco::ThreadPool                        _workers;
+    Poco::TaskManager                       _taskManager;
     ProgressHandler                         _progressHandler;
 
-    Poco::Data::SessionPool                 _dbSessions;
+    std::unique_ptr<StorageBackend>         _backend;
+    CredentialCache                         _credentials;
+
+    std::mutex                              _queueMutex;
+    std::condition_variable                 _queueReady;
+    std::vector<Job*>                       _queue;         // ring, holds no more jobs than admitted queries
+    size_t                                  _queueHead;
+    size_t                                  _queueSize;
+    size_t                                  _queuedQueries; // admitted, including the ones still in batches
+
+    std::mutex                              _metricsMutex;
+    Metrics                                 _metrics;
+    Clock::duration                         _totalWait;
+    uint64_t                                _waited;
+    LatencyHistogram                        _latency;
+
+    PendingBatch<DBQuery::RegisterQuery, DBQuery::RegisterResult>   _registerBatch;
+    PendingBatch<DBQuery::LoginQuery, DBQuery::LoginResult>         _loginBatch;
+
+    static Configuration _config;
 };
 
 #endif /* DatabaseAccessor_hpp */
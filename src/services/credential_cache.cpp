@@ -0,0 +1,138 @@
+//
+//  credential_cache.cpp
+//  labyrinth_server
+//
+
+#include "credential_cache.hpp"
+
+
+CredentialCache::CredentialCache(std::chrono::seconds verifiedTtl,
+                                 std::chrono::seconds missingTtl,
+                                 size_t maxShardSize)
+: _verifiedTtl(verifiedTtl),
+  _missingTtl(missingTtl),
+  _maxShardSize(maxShardSize)
+{ }
+
+
+CredentialCache::Lookup
+CredentialCache::Find(const std::string& email, const std::string& password)
+{
+    auto& shard = GetShard(email);
+    std::lock_guard<std::mutex> l(shard.Mutex);
+
+    auto entry = shard.Entries.find(email);
+    if(entry == shard.Entries.end())
+        return Lookup::MISS;
+
+    if(entry->second.Expires < std::chrono::steady_clock::now())
+    {
+        Erase(shard, entry);
+        return Lookup::MISS;
+    }
+
+    if(!entry->second.Registered)
+        return Lookup::NOT_REGISTERED;
+
+    return entry->second.Password == password ? Lookup::MATCH : Lookup::WRONG_PASSWORD;
+}
+
+
+void
+CredentialCache::StoreVerified(const std::string& email, const std::string& password)
+{
+    Entry entry;
+    entry.Registered = true;
+    entry.Password = password;
+    entry.Expires = std::chrono::steady_clock::now() + _verifiedTtl;
+
+        // also replaces "not registered" entry after registration
+    Store(email, std::move(entry));
+}
+
+
+void
+CredentialCache::StoreMissing(const std::string& email)
+{
+    Entry entry;
+    entry.Registered = false;
+    entry.Expires = std::chrono::steady_clock::now() + _missingTtl;
+
+    Store(email, std::move(entry));
+}
+
+
+void
+CredentialCache::Store(const std::string& email, Entry entry)
+{
+    auto& shard = GetShard(email);
+    std::lock_guard<std::mutex> l(shard.Mutex);
+
+        // refreshed entry moves to the back of the queue of its new kind, nothing is allocated
+    auto found = shard.Entries.find(email);
+    if(found != shard.Entries.end())
+    {
+            // accounts are never removed, so "not registered" is a late answer of a query issued
+            // before the registration, it must not hide the new account
+        if(found->second.Registered && !entry.Registered)
+            return;
+
+        auto& queue = Queue(shard, entry.Registered);
+        queue.splice(queue.end(), Queue(shard, found->second.Registered), found->second.Position);
+
+        entry.Position = found->second.Position;
+        found->second = std::move(entry);
+        return;
+    }
+
+    if(shard.Entries.size() >= _maxShardSize)
+        MakeRoom(shard);
+
+    auto inserted = shard.Entries.emplace(email, std::move(entry)).first;
+    auto& queue = Queue(shard, inserted->second.Registered);
+    inserted->second.Position = queue.insert(queue.end(), &inserted->first);
+}
+
+
+void
+CredentialCache::Erase(Shard& shard, EntryMap::iterator entry)
+{
+    Queue(shard, entry->second.Registered).erase(entry->second.Position);
+    shard.Entries.erase(entry);
+}
+
+
+void
+CredentialCache::MakeRoom(Shard& shard)
+{
+    auto now = std::chrono::steady_clock::now();
+    auto front = [&](ExpiryQueue& queue)
+    {
+        return queue.empty() ? shard.Entries.end() : shard.Entries.find(*queue.front());
+    };
+
+    auto verified = front(shard.Verified);
+    auto missing = front(shard.Missing);
+
+        // every expired entry goes at once, it costs no more than the inserts which made it
+    while(verified != shard.Entries.end() && verified->second.Expires < now)
+    {
+        Erase(shard, verified);
+        verified = front(shard.Verified);
+    }
+    while(missing != shard.Entries.end() && missing->second.Expires < now)
+    {
+        Erase(shard, missing);
+        missing = front(shard.Missing);
+    }
+
+    if(shard.Entries.size() < _maxShardSize)
+        return;
+
+        // nothing expired, the entry closest to expiry is dropped
+    if(missing == shard.Entries.end() ||
+       (verified != shard.Entries.end() && verified->second.Expires < missing->second.Expires))
+        Erase(shard, verified);
+    else
+        Erase(shard, missing);
+}
@@ -0,0 +1,89 @@
+//
+//  credential_cache.hpp
+//  labyrinth_server
+//
+
+#ifndef credential_cache_hpp
+#define credential_cache_hpp
+
+#include <array>
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+
+/*
+ * Recently verified credentials and emails known to be unregistered.
+ * Sharded by email hash, so concurrent lookups rarely meet on one mutex.
+ * Entries come only from database answers and expire after their TTL.
+ * Every kind of entry has one TTL, so a queue per kind is ordered by expiry and a full shard
+ * makes room in O(1): expired entries go first, then the one closest to expiry.
+ */
+class CredentialCache
+{
+public:
+    enum class Lookup
+    {
+        MISS,
+        MATCH,
+        WRONG_PASSWORD,
+        NOT_REGISTERED
+    };
+
+public:
+    CredentialCache(std::chrono::seconds verifiedTtl = std::chrono::seconds(300),
+                    std::chrono::seconds missingTtl = std::chrono::seconds(30),
+                    size_t maxShardSize = 4096);
+
+    Lookup Find(const std::string& email, const std::string& password);
+
+    void StoreVerified(const std::string& email, const std::string& password);
+    void StoreMissing(const std::string& email);
+
+private:
+        // keys of the entries, oldest first
+    using ExpiryQueue = std::list<const std::string*>;
+
+    struct Entry
+    {
+        bool                                    Registered;
+        std::string                             Password;
+        std::chrono::steady_clock::time_point   Expires;
+        ExpiryQueue::iterator                   Position;   // in the queue of its kind
+    };
+
+    using EntryMap = std::unordered_map<std::string, Entry>;
+
+    struct Shard
+    {
+        std::mutex                              Mutex;
+        EntryMap                                Entries;
+        ExpiryQueue                             Verified;
+        ExpiryQueue                             Missing;
+    };
+
+    static const size_t SHARDS_COUNT = 16;
+
+    Shard& GetShard(const std::string& email)
+    { return _shards[std::hash<std::string>()(email) % SHARDS_COUNT]; }
+
+    static ExpiryQueue& Queue(Shard& shard, bool registered)
+    { return registered ? shard.Verified : shard.Missing; }
+
+    void Store(const std::string& email, Entry entry);
+
+        // shard.Mutex is held
+    static void Erase(Shard& shard, EntryMap::iterator entry);
+    void MakeRoom(Shard& shard);
+
+private:
+    const std::chrono::seconds          _verifiedTtl;
+    const std::chrono::seconds          _missingTtl;
+    const size_t                        _maxShardSize;
+
+    std::array<Shard, SHARDS_COUNT>     _shards;
+};
+
+#endif /* credential_cache_hpp */
@@ -0,0 +1,95 @@
+//
+//  leaderboard.cpp
+//  labyrinth_server
+//
+
+#include "leaderboard.hpp"
+
+#include "DatabaseAccessor.hpp"
+
+
+Leaderboard&
+Leaderboard::Instance()
+{
+    static Leaderboard leaderboard(DatabaseAccessor::Instance().GetStorage());
+    return leaderboard;
+}
+
+
+Leaderboard::Leaderboard(StorageBackend& storage)
+: _logger("Leaderboard", NamedLogger::Mode::STDIO),
+  _storage(storage),
+  _timer(std::make_unique<Poco::Timer>(60000, 60000))
+{
+    try
+    {
+        for(auto& score : _storage.LoadScores())
+            _ranking.Set(score);
+
+            // restored scores are stored already
+        _ranking.TakeChanged();
+    }
+    catch(const std::exception& e)
+    {
+        _logger.Error() << "Failed to load scores, starting with empty leaderboard: " << e.what();
+    }
+
+    LOG_DEBUG(_logger) << "Leaderboard is up, players: " << _ranking.Size() << ", checkpoint interval: " << _timer->getPeriodicInterval() << "ms";
+
+    Poco::TimerCallback<Leaderboard> checkpoint(*this,
+                                                &Leaderboard::Checkpoint);
+    _timer->start(checkpoint);
+}
+
+
+Leaderboard::~Leaderboard()
+{
+    _timer->stop();
+    Checkpoint();
+}
+
+
+void
+Leaderboard::Report(const DBQuery::MatchRecord& match)
+{
+    std::lock_guard<std::mutex> l(_mutex);
+    for(auto& player : match.Players)
+        _ranking.Add(player.Name, player.Winner, player.Kills, player.Deaths);
+}
+
+
+void
+Leaderboard::Checkpoint(Poco::Timer&)
+{
+    Poco::Thread::current()->setName("LeaderboardTimer");
+    Checkpoint();
+}
+
+
+void
+Leaderboard::Checkpoint()
+{
+    std::lock_guard<std::mutex> cl(_checkpointMutex);
+
+    std::vector<Ranking::Score> changed;
+    {
+        std::lock_guard<std::mutex> l(_mutex);
+        changed = _ranking.TakeChanged();
+    }
+
+    if(changed.empty())
+        return;
+
+    try
+    {
+        _storage.SaveScores(changed);
+        LOG_DEBUG(_logger) << "Checkpoint: " << changed.size() << " scores saved";
+    }
+    catch(const std::exception& e)
+    {
+        _logger.Warning() << "Checkpoint of " << changed.size() << " scores failed, retry with the next one: " << e.what();
+
+        std::lock_guard<std::mutex> l(_mutex);
+        _ranking.MarkChanged(changed);
+    }
+}
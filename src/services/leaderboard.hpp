@@ -0,0 +1,60 @@
+//
+//  leaderboard.hpp
+//  labyrinth_server
+//
+
+#ifndef leaderboard_hpp
+#define leaderboard_hpp
+
+#include "ranking.hpp"
+#include "storage_backend.hpp"
+#include "../toolkit/named_logger.hpp"
+
+#include <Poco/Timer.h>
+
+#include <memory>
+#include <mutex>
+
+
+/*
+ * Master-side player ranking.
+ * Kept in memory and updated with every reported match, so lookups never touch the database.
+ * Changed scores are checkpointed to the storage periodically and loaded back at startup.
+ */
+class Leaderboard
+{
+public:
+    static Leaderboard& Instance();
+
+    ~Leaderboard();
+
+    void Report(const DBQuery::MatchRecord& match);
+
+    /*
+     * reader gets const Ranking& under the lock, keep it short.
+     */
+    template<typename Reader>
+    void Read(Reader reader)
+    {
+        std::lock_guard<std::mutex> l(_mutex);
+        reader(static_cast<const Ranking&>(_ranking));
+    }
+
+private:
+    Leaderboard(StorageBackend& storage);
+
+    void Checkpoint(Poco::Timer&);
+    void Checkpoint();
+
+private:
+    NamedLogger                     _logger;
+    StorageBackend&                 _storage;
+
+    std::mutex                      _mutex;
+    Ranking                         _ranking;
+
+    std::mutex                      _checkpointMutex;
+    std::unique_ptr<Poco::Timer>    _timer;
+};
+
+#endif /* leaderboard_hpp */
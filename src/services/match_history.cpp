@@ -0,0 +1,433 @@
+//
+//  match_history.cpp
+//  labyrinth_server
+//
+
+#include "match_history.hpp"
+
+#include "DatabaseAccessor.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+
+namespace
+{
+        // spill file line: server seed started duration finished players [name hero kills deaths winner]...
+    std::string Encode(const DBQuery::MatchRecord& match)
+    {
+        std::ostringstream line;
+        line << match.Server << '\t' << match.RandomSeed << '\t' << match.StartedAt << '\t'
+             << match.DurationMs << '\t' << match.Finished << '\t' << match.Players.size();
+
+        for(auto& player : match.Players)
+        {
+            auto name = player.Name;
+            std::replace_if(name.begin(), name.end(), [](char c){ return c == '\t' || c == '\n'; }, ' ');
+
+            line << '\t' << name << '\t' << player.Hero << '\t' << player.Kills << '\t'
+                 << player.Deaths << '\t' << player.Winner;
+        }
+
+        return line.str();
+    }
+
+    bool Decode(const std::string& line, DBQuery::MatchRecord& match)
+    {
+        std::istringstream fields(line);
+        auto next = [&fields](std::string& field)
+        { return static_cast<bool>(std::getline(fields, field, '\t')); };
+
+        std::string field;
+        size_t players = 0;
+        try
+        {
+            if(!next(field)) return false;
+            match.Server = std::stoul(field);
+            if(!next(field)) return false;
+            match.RandomSeed = std::stoul(field);
+            if(!next(field)) return false;
+            match.StartedAt = std::stoll(field);
+            if(!next(field)) return false;
+            match.DurationMs = std::stoul(field);
+            if(!next(field)) return false;
+            match.Finished = (field == "1");
+            if(!next(field)) return false;
+            players = std::stoul(field);
+
+            match.Players.resize(players);
+            for(auto& player : match.Players)
+            {
+                if(!next(player.Name)) return false;
+                if(!next(field)) return false;
+                player.Hero = std::stoul(field);
+                if(!next(field)) return false;
+                player.Kills = std::stoul(field);
+                if(!next(field)) return false;
+                player.Deaths = std::stoul(field);
+                if(!next(field)) return false;
+                player.Winner = (field == "1");
+            }
+        }
+        catch(const std::exception&)
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+        // "offset 0000000000000024\n", rewritten in place when records are consumed
+    const size_t HEADER_SIZE = 24;
+
+    std::string Header(uint64_t offset)
+    {
+        char header[HEADER_SIZE + 1];
+        std::snprintf(header, sizeof(header), "offset %016llu\n", static_cast<unsigned long long>(offset));
+        return header;
+    }
+
+    uint64_t FileSize(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        return file ? static_cast<uint64_t>(file.tellg()) : 0;
+    }
+}
+
+
+MatchHistory::Configuration MatchHistory::_config = { 1024, 64, std::chrono::milliseconds(1000), "match_history.spill" };
+
+
+MatchHistory&
+MatchHistory::Instance()
+{
+    static MatchHistory history(DatabaseAccessor::Instance().GetStorage());
+    return history;
+}
+
+
+MatchHistory::MatchHistory(StorageBackend& storage)
+: _logger("MatchHistory", NamedLogger::Mode::STDIO),
+  _storage(storage),
+  _running(true),
+  _spillOffset(0),
+  _spilled(0),
+  _thread("MatchHistory")
+{
+        // leftovers of the previous run
+    OpenSpill();
+
+    LOG_DEBUG(_logger) << "MatchHistory is up, storage: " << _storage.Name() << ", spilled records: " << _spilled.load();
+
+    _thread.start(*this);
+}
+
+
+MatchHistory::~MatchHistory()
+{
+    {
+        std::lock_guard<std::mutex> l(_mutex);
+        _running = false;
+    }
+    _wakeup.notify_one();
+    _thread.join();
+}
+
+
+void
+MatchHistory::Record(DBQuery::MatchRecord record)
+{
+    std::lock_guard<std::mutex> l(_mutex);
+    _pending.push_back(std::move(record));
+
+        // records above MaxPending are spilled by the background thread
+    if(_pending.size() >= _config.MaxBatch || _pending.size() > _config.MaxPending)
+        _wakeup.notify_one();
+}
+
+
+size_t
+MatchHistory::Pending()
+{
+    std::lock_guard<std::mutex> l(_mutex);
+    return _pending.size() + _spilled.load();
+}
+
+
+void
+MatchHistory::run()
+{
+    bool healthy = true;
+
+    std::unique_lock<std::mutex> l(_mutex);
+    while(_running)
+    {
+            // after a failure only the timer or an overflow wakes us up, a full batch would spin otherwise
+        _wakeup.wait_for(l, _config.FlushInterval, [this, healthy]
+                         {
+                             return !_running
+                                 || _pending.size() > _config.MaxPending
+                                 || (healthy && (_pending.size() >= _config.MaxBatch || _spilled));
+                         });
+
+            // newest records go to disk, older ones keep their place in the queue
+        std::vector<DBQuery::MatchRecord> overflow;
+        if(_pending.size() > _config.MaxPending)
+        {
+            auto first = _pending.begin() + _config.MaxPending;
+            overflow.assign(std::make_move_iterator(first), std::make_move_iterator(_pending.end()));
+            _pending.erase(first, _pending.end());
+        }
+
+        auto count = std::min(_pending.size(), _config.MaxBatch);
+        if(!count && !_spilled && overflow.empty())
+            continue;
+
+        l.unlock();
+        if(!overflow.empty())
+            Spill(overflow);
+
+        healthy = Flush(count);
+
+            // database keeps up with live matches, write what was spilled while it didn't
+        if(healthy && _spilled && count < _config.MaxBatch)
+            healthy = FlushSpilled(_config.MaxBatch);
+        l.lock();
+    }
+
+        // last chance to write before shutdown
+    auto count = _pending.size();
+    l.unlock();
+    for(healthy = true; healthy && count; count -= std::min(count, _config.MaxBatch))
+        healthy = Flush(std::min(count, _config.MaxBatch));
+
+        // nothing is lost on shutdown: whatever was not written goes to disk
+    std::vector<DBQuery::MatchRecord> rest;
+    {
+        std::lock_guard<std::mutex> pl(_mutex);
+        rest.assign(std::make_move_iterator(_pending.begin()), std::make_move_iterator(_pending.end()));
+        _pending.clear();
+    }
+    if(!rest.empty())
+        Spill(rest);
+}
+
+
+bool
+MatchHistory::Flush(size_t count)
+{
+    if(!count)
+        return true;
+
+        // records stay at the front of the queue until they are written, Record() only appends
+    std::vector<DBQuery::MatchRecord> batch;
+    {
+        std::lock_guard<std::mutex> l(_mutex);
+        batch.assign(_pending.begin(), _pending.begin() + count);
+    }
+
+    try
+    {
+        _storage.SaveMatches(batch);
+    }
+    catch(const std::exception& e)
+    {
+        _logger.Warning() << "Failed to write " << count << " matches, retry in " << _config.FlushInterval.count() << "ms: " << e.what();
+        return false;
+    }
+
+    std::lock_guard<std::mutex> l(_mutex);
+    _pending.erase(_pending.begin(), _pending.begin() + count);
+
+    LOG_DEBUG(_logger) << count << " matches written, " << _pending.size() << " pending";
+    return true;
+}
+
+
+void
+MatchHistory::OpenSpill()
+{
+    std::ifstream spill(_config.SpillPath, std::ios::binary);
+    if(!spill)
+        return;
+
+    std::string header;
+    std::getline(spill, header);
+
+    uint64_t offset = 0;
+    if(header.size() + 1 == HEADER_SIZE && header.compare(0, 7, "offset ") == 0)
+        offset = std::strtoull(header.c_str() + 7, nullptr, 10);
+
+    auto size = FileSize(_config.SpillPath);
+    if(offset < HEADER_SIZE || offset > size)
+    {
+        _logger.Warning() << "Spill file " << _config.SpillPath << " has no valid read offset, it is read from the start";
+
+            // a broken header is dropped, a file without one (older format) starts with a record
+        DBQuery::MatchRecord record;
+        bool headerLine = header.compare(0, 7, "offset ") == 0 || !Decode(header, record);
+        uint64_t start = headerLine ? std::min<uint64_t>(header.size() + 1, size) : 0;
+
+        spill.close();
+        if(!CompactSpill(start))
+            return;
+
+        spill.open(_config.SpillPath, std::ios::binary);
+        size = FileSize(_config.SpillPath);
+        offset = HEADER_SIZE;
+    }
+    _spillOffset = offset;
+
+    spill.seekg(offset);
+    std::string line;
+    size_t count = 0;
+    while(std::getline(spill, line))
+        ++count;
+    _spilled = count;
+    spill.close();
+
+        // a line cut by a crash must not swallow the next appended one
+    if(size > offset)
+    {
+        std::ifstream last(_config.SpillPath, std::ios::binary);
+        last.seekg(size - 1);
+        if(last.get() != '\n')
+            std::ofstream(_config.SpillPath, std::ios::binary | std::ios::app) << '\n';
+    }
+}
+
+
+void
+MatchHistory::Spill(const std::vector<DBQuery::MatchRecord>& records)
+{
+    std::ofstream spill(_config.SpillPath, std::ios::binary | std::ios::app);
+    if(_spillOffset == 0)
+        spill << Header(HEADER_SIZE);
+    for(auto& record : records)
+        spill << Encode(record) << '\n';
+    spill.flush();
+
+    if(!spill)
+    {
+        _logger.Error() << records.size() << " matches lost, spill file " << _config.SpillPath << " is not writable";
+        return;
+    }
+
+    _spillOffset = std::max<uint64_t>(_spillOffset, HEADER_SIZE);
+    _spilled += records.size();
+    _logger.Warning() << records.size() << " matches spilled to " << _config.SpillPath << ", " << _spilled.load() << " there";
+}
+
+
+bool
+MatchHistory::FlushSpilled(size_t limit)
+{
+    std::vector<DBQuery::MatchRecord> batch;
+    size_t lines = 0;
+    uint64_t offset = _spillOffset;
+    {
+        std::ifstream spill(_config.SpillPath, std::ios::binary);
+        spill.seekg(offset);
+
+        std::string line;
+        while(batch.size() < limit && std::getline(spill, line))
+        {
+            offset += line.size() + 1;
+            ++lines;
+
+            DBQuery::MatchRecord record;
+            if(Decode(line, record))
+                batch.push_back(std::move(record));
+            else
+                _logger.Warning() << "Malformed spilled match skipped: " << line;
+        }
+    }
+
+    if(!batch.empty())
+    {
+        try
+        {
+            _storage.SaveMatches(batch);
+        }
+        catch(const std::exception& e)
+        {
+            _logger.Warning() << "Failed to write " << batch.size() << " spilled matches: " << e.what();
+            return false;
+        }
+    }
+
+        // committed, only now the lines may leave the file
+    _spilled -= std::min(_spilled.load(), lines);
+    AdvanceSpill(offset);
+
+    LOG_DEBUG(_logger) << batch.size() << " spilled matches written, " << _spilled.load() << " left";
+    return true;
+}
+
+
+void
+MatchHistory::AdvanceSpill(uint64_t offset)
+{
+    auto size = FileSize(_config.SpillPath);
+    if(offset >= size)
+    {
+        std::remove(_config.SpillPath.c_str());
+        _spillOffset = 0;
+        _spilled = 0;
+        return;
+    }
+
+        // consumed part is cut off once it outgrows the rest, every byte is copied at most once on average
+    if(offset - HEADER_SIZE < size - offset || !CompactSpill(offset))
+        WriteSpillOffset(offset);
+}
+
+
+bool
+MatchHistory::CompactSpill(uint64_t offset)
+{
+    auto temporary = _config.SpillPath + ".tmp";
+    {
+        std::ifstream from(_config.SpillPath, std::ios::binary);
+        from.seekg(offset);
+
+        std::ofstream to(temporary, std::ios::binary | std::ios::trunc);
+        to << Header(HEADER_SIZE) << from.rdbuf();
+        to.flush();
+        if(!to)
+        {
+            _logger.Warning() << "Failed to compact spill file " << _config.SpillPath;
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+
+        // rename replaces the file atomically, the old one is valid until then
+    if(std::rename(temporary.c_str(), _config.SpillPath.c_str()) != 0)
+    {
+        _logger.Warning() << "Failed to replace spill file " << _config.SpillPath;
+        std::remove(temporary.c_str());
+        return false;
+    }
+
+    _spillOffset = HEADER_SIZE;
+    return true;
+}
+
+
+void
+MatchHistory::WriteSpillOffset(uint64_t offset)
+{
+        // a crash before this point writes the batch again, it is never lost
+    _spillOffset = offset;
+
+    std::fstream spill(_config.SpillPath, std::ios::binary | std::ios::in | std::ios::out);
+    spill.seekp(0);
+    spill << Header(offset);
+    spill.flush();
+
+    if(!spill)
+        _logger.Error() << "Failed to update read offset of " << _config.SpillPath << ", written matches may be written again after restart";
+}
@@ -0,0 +1,96 @@
+//
+//  match_history.hpp
+//  labyrinth_server
+//
+
+#ifndef match_history_hpp
+#define match_history_hpp
+
+#include "storage_backend.hpp"
+#include "../toolkit/named_logger.hpp"
+
+#include <Poco/Runnable.h>
+#include <Poco/Thread.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+/*
+ * Write-behind store of finished matches.
+ * Game servers only enqueue records, background thread writes them in batches with one transaction
+ * per batch. Memory is bounded: while the database is unavailable the background thread appends records
+ * above MaxPending to a spill file and writes them from there once the database is back (also after restart).
+ * Spill file starts with a fixed-size header holding the offset of the first unwritten line, the offset moves
+ * only after the batch is committed. Consumed part is cut off through a temporary file and a rename once it
+ * outgrows the rest, so a process crash at any point loses nothing (a committed batch may be written twice).
+ * Writes are not synced to disk, a power loss can still take the last of them.
+ */
+class MatchHistory : public Poco::Runnable
+{
+public:
+    struct Configuration
+    {
+        size_t                      MaxPending;     // records kept in memory
+        size_t                      MaxBatch;       // records per transaction
+        std::chrono::milliseconds   FlushInterval;  // also the retry interval after a failed write
+        std::string                 SpillPath;
+    };
+
+public:
+    static MatchHistory& Instance();
+
+    /*
+     * Has to be called before the first Instance() call.
+     */
+    static void Configure(const Configuration& config)
+    { _config = config; }
+
+    ~MatchHistory();
+
+    void Record(DBQuery::MatchRecord record);
+
+        // records waiting in memory and in the spill file
+    size_t Pending();
+
+    size_t Spilled() const
+    { return _spilled.load(); }
+
+    virtual void run() override;
+
+private:
+    MatchHistory(StorageBackend& storage);
+
+    bool Flush(size_t count);
+
+        // spill file is touched by the background thread only
+    void OpenSpill();
+    void Spill(const std::vector<DBQuery::MatchRecord>& records);
+    bool FlushSpilled(size_t limit);
+    void AdvanceSpill(uint64_t offset);
+    bool CompactSpill(uint64_t offset);
+    void WriteSpillOffset(uint64_t offset);
+
+private:
+    NamedLogger                         _logger;
+    StorageBackend&                     _storage;
+
+    std::mutex                          _mutex;
+    std::condition_variable             _wakeup;
+    std::deque<DBQuery::MatchRecord>    _pending;
+    bool                                _running;
+
+    uint64_t                            _spillOffset;   // first unwritten line, 0 - no spill file
+    std::atomic<size_t>                 _spilled;       // records in the spill file
+
+    Poco::Thread                        _thread;
+
+    static Configuration _config;
+};
+
+#endif /* match_history_hpp */
@@ -0,0 +1,255 @@
+//
+//  matchmaker.cpp
+//  labyrinth_server
+//
+
+#include "matchmaker.hpp"
+
+#include <Poco/Thread.h>
+
+#include <algorithm>
+#include <set>
+
+using Clock = std::chrono::steady_clock;
+
+
+Matchmaker::Configuration Matchmaker::_config = { std::chrono::milliseconds(250), 1, 8, 4096,
+                                                  std::chrono::milliseconds(50), std::chrono::milliseconds(25),
+                                                  std::chrono::seconds(60) };
+
+
+Matchmaker::Matchmaker(GameFleet& servers,
+                       FoundCallback found,
+                       RefusedCallback refused)
+: _logger("Matchmaker", NamedLogger::Mode::STDIO),
+  _servers(servers),
+  _found(std::move(found)),
+  _refused(std::move(refused)),
+  _waiting(0),
+  _timer(std::make_unique<Poco::Timer>(0, _config.FormInterval.count()))
+{
+    LOG_DEBUG(_logger) << "Matchmaker is up, interval: " << _config.FormInterval.count() << "ms, default lobby: "
+                       << _config.DefaultLobbySize << ", queue: " << _config.MaxQueue;
+
+    Poco::TimerCallback<Matchmaker> form(*this,
+                                         &Matchmaker::Form);
+    _timer->start(form);
+}
+
+
+Matchmaker::~Matchmaker()
+{
+    _timer->stop();
+}
+
+
+bool
+Matchmaker::Enqueue(const Ticket& ticket)
+{
+    if(ticket.LobbySize > _config.MaxLobbySize)
+        return false;
+
+    std::lock_guard<std::mutex> l(_mutex);
+    if(_waiting >= _config.MaxQueue)
+        return false;
+
+    _incoming.push_back(ticket);
+    ++_waiting;
+    return true;
+}
+
+
+size_t
+Matchmaker::Waiting() const
+{
+    std::lock_guard<std::mutex> l(_mutex);
+    return _waiting;
+}
+
+
+void
+Matchmaker::Form(Poco::Timer&)
+{
+    Poco::Thread::current()->setName("MatchmakerTimer");
+    Form();
+}
+
+
+void
+Matchmaker::Form()
+{
+    std::vector<Ticket> incoming;
+    {
+        std::lock_guard<std::mutex> l(_mutex);
+        incoming.swap(_incoming);
+    }
+
+        // client resends find-game until answered, keep the first ticket
+    std::set<Poco::Net::SocketAddress> queued;
+    for(auto& queue : _queues)
+        for(auto& ticket : queue.second)
+            queued.insert(ticket.Recipient);
+
+    size_t merged = 0;
+    for(auto& ticket : incoming)
+    {
+        if(!queued.insert(ticket.Recipient).second)
+        {
+            ++merged;
+            continue;
+        }
+
+        auto lobbySize = ticket.LobbySize ? ticket.LobbySize : _config.DefaultLobbySize;
+        _queues[lobbySize].push_back(ticket);
+    }
+
+    if(merged)
+    {
+        std::lock_guard<std::mutex> l(_mutex);
+        _waiting -= merged;
+    }
+
+    auto now = Clock::now();
+    Expire(now);
+    Backfill();
+
+    for(auto& queue : _queues)
+    {
+        if(!FormMatches(queue.first, queue.second, now))
+            break;
+    }
+}
+
+
+void
+Matchmaker::Expire(Clock::time_point now)
+{
+    size_t expired = 0;
+    for(auto& queue : _queues)
+    {
+        auto& tickets = queue.second;
+        auto last = std::remove_if(tickets.begin(),
+                                   tickets.end(),
+                                   [&](const Ticket& ticket)
+                                   {
+                                       if(now - ticket.Enqueued < _config.MaxWait)
+                                           return false;
+
+                                       _refused(ticket);
+                                       return true;
+                                   });
+        expired += std::distance(last, tickets.end());
+        tickets.erase(last, tickets.end());
+    }
+
+    if(expired)
+    {
+        _logger.Warning() << expired << " find-game requests expired in the queue";
+
+        std::lock_guard<std::mutex> l(_mutex);
+        _waiting -= expired;
+    }
+}
+
+
+void
+Matchmaker::Backfill()
+{
+        // only tickets without preference go into lobbies of other players, whatever their size is
+    auto queue = _queues.find(_config.DefaultLobbySize);
+    if(queue == _queues.end())
+        return;
+
+    size_t filled = 0;
+    auto& tickets = queue->second;
+    auto last = std::remove_if(tickets.begin(),
+                               tickets.end(),
+                               [&](const Ticket& ticket)
+                               {
+                                   if(ticket.LobbySize != 0)
+                                       return false;
+
+                                   auto endpoint = _servers.TakeFreedSeat();
+                                   if(!endpoint)
+                                       return false;
+
+                                   _found({ ticket }, *endpoint);
+                                   ++filled;
+                                   return true;
+                               });
+    tickets.erase(last, tickets.end());
+
+    if(filled)
+    {
+        LOG_DEBUG(_logger) << filled << " players sent to lobbies with free seats";
+
+        std::lock_guard<std::mutex> l(_mutex);
+        _waiting -= filled;
+    }
+}
+
+
+bool
+Matchmaker::FormMatches(uint16_t lobbySize, std::vector<Ticket>& tickets, Clock::time_point now)
+{
+    std::sort(tickets.begin(),
+              tickets.end(),
+              [](const Ticket& a, const Ticket& b)
+              {
+                  return a.Rtt < b.Rtt;
+              });
+
+    std::vector<Ticket> rest;
+    std::vector<Ticket> match;
+    bool serversAvailable = true;
+
+    size_t idx = 0;
+    while(idx < tickets.size())
+    {
+        if(!serversAvailable || idx + lobbySize > tickets.size())
+        {
+            rest.insert(rest.end(), tickets.begin() + idx, tickets.end());
+            break;
+        }
+
+        auto first = tickets.begin() + idx;
+        auto last = first + lobbySize;
+
+            // window is sorted by RTT, its spread is the last minus the first one
+        auto oldest = std::min_element(first,
+                                       last,
+                                       [](const Ticket& a, const Ticket& b)
+                                       {
+                                           return a.Enqueued < b.Enqueued;
+                                       })->Enqueued;
+        auto waited = std::chrono::duration_cast<std::chrono::seconds>(now - oldest).count();
+        auto tolerance = _config.RttTolerance + _config.RttWidening * waited;
+
+        if(std::chrono::milliseconds((last - 1)->Rtt - first->Rtt) > tolerance)
+        {
+            rest.push_back(*first);
+            ++idx;
+            continue;
+        }
+
+        auto endpoint = _servers.StartLobby(lobbySize);
+        if(!endpoint)
+        {
+            serversAvailable = false;
+            continue;
+        }
+
+        match.assign(first, last);
+        _found(match, *endpoint);
+        idx += lobbySize;
+
+        LOG_DEBUG(_logger) << "Match of " << lobbySize << " players formed on "
+                           << (endpoint->Host.empty() ? "master" : endpoint->Host) << ":" << endpoint->Port;
+
+        std::lock_guard<std::mutex> l(_mutex);
+        _waiting -= lobbySize;
+    }
+
+    tickets.swap(rest);
+    return serversAvailable;
+}
@@ -0,0 +1,105 @@
+//
+//  matchmaker.hpp
+//  labyrinth_server
+//
+
+#ifndef matchmaker_hpp
+#define matchmaker_hpp
+
+#include "../game_fleet.hpp"
+#include "../toolkit/named_logger.hpp"
+
+#include <Poco/Net/SocketAddress.h>
+#include <Poco/Timer.h>
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+/*
+ * Find-game queue.
+ * Requests are queued as tickets and matched on a fixed cadence: tickets are grouped by lobby size,
+ * ordered by RTT and cut into full matches whose RTT spread fits the tolerance. Tolerance widens
+ * with waiting time, so nobody waits forever for a perfect match. Every match gets a server
+ * of its own, players of a match are answered together and the lobby starts full.
+ * When every server is busy tickets just stay queued until one finishes.
+ */
+class Matchmaker
+{
+public:
+    struct Configuration
+    {
+        std::chrono::milliseconds   FormInterval;
+        uint16_t                    DefaultLobbySize;   // for tickets without preference
+        uint16_t                    MaxLobbySize;
+        size_t                      MaxQueue;
+        std::chrono::milliseconds   RttTolerance;
+        std::chrono::milliseconds   RttWidening;        // added to tolerance per second of waiting
+        std::chrono::seconds        MaxWait;
+    };
+
+    struct Ticket
+    {
+        Poco::Net::SocketAddress                Recipient;
+        uint32_t                                PlayerUid;
+        uint16_t                                LobbySize;  // 0 - no preference
+        uint16_t                                Rtt;        // ms
+        std::chrono::steady_clock::time_point   Enqueued;
+    };
+
+        // called from the matchmaker thread
+    using FoundCallback = std::function<void(const std::vector<Ticket>& players, const GameEndpoint& endpoint)>;
+    using RefusedCallback = std::function<void(const Ticket& ticket)>;
+
+public:
+    /*
+     * Has to be called before the matchmaker is created.
+     */
+    static void Configure(const Configuration& config)
+    { _config = config; }
+
+    Matchmaker(GameFleet& servers,
+               FoundCallback found,
+               RefusedCallback refused);
+    ~Matchmaker();
+
+    /*
+     * False if the queue is full or lobby size is not supported.
+     * Repeated requests from the same address are merged.
+     */
+    bool Enqueue(const Ticket& ticket);
+
+    size_t Waiting() const;
+
+private:
+    void Form(Poco::Timer&);
+    void Form();
+
+    void Expire(std::chrono::steady_clock::time_point now);
+    void Backfill();
+        // false once servers ran out, remaining queues wait for the next round
+    bool FormMatches(uint16_t lobbySize, std::vector<Ticket>& tickets, std::chrono::steady_clock::time_point now);
+
+private:
+    static Configuration                        _config;
+
+    NamedLogger                                 _logger;
+    GameFleet&                                  _servers;
+    FoundCallback                               _found;
+    RefusedCallback                             _refused;
+
+    mutable std::mutex                          _mutex;
+    std::vector<Ticket>                         _incoming;
+    size_t                                      _waiting;   // incoming + queued
+
+        // owned by the timer thread
+    std::map<uint16_t, std::vector<Ticket>>     _queues;    // by lobby size, 0 - no preference
+
+    std::unique_ptr<Poco::Timer>                _timer;
+};
+
+#endif /* matchmaker_hpp */
@@ -0,0 +1,68 @@
+//
+//  memory_backend.cpp
+//  labyrinth_server
+//
+
+#include "memory_backend.hpp"
+
+
+std::vector<DBQuery::RegisterResult>
+MemoryBackend::Register(const std::vector<DBQuery::RegisterQuery>& queries)
+{
+    std::vector<DBQuery::RegisterResult> results(queries.size());
+
+    std::lock_guard<std::mutex> l(_mutex);
+    for(size_t i = 0; i < queries.size(); ++i)
+        results[i].Success = _passwords.emplace(queries[i].Email, queries[i].Password).second;
+
+    return results;
+}
+
+
+std::vector<DBQuery::LoginResult>
+MemoryBackend::Login(const std::vector<DBQuery::LoginQuery>& queries)
+{
+    std::vector<DBQuery::LoginResult> results(queries.size());
+
+    std::lock_guard<std::mutex> l(_mutex);
+    for(size_t i = 0; i < queries.size(); ++i)
+    {
+        auto stored = _passwords.find(queries[i].Email);
+        results[i].Registered = (stored != _passwords.end());
+        results[i].Success = results[i].Registered && stored->second == queries[i].Password;
+    }
+
+    return results;
+}
+
+
+void
+MemoryBackend::SaveMatches(const std::vector<DBQuery::MatchRecord>& matches)
+{
+    std::lock_guard<std::mutex> l(_mutex);
+    _matches.insert(_matches.end(), matches.begin(), matches.end());
+    while(_matches.size() > MAX_MATCHES)
+        _matches.pop_front();
+}
+
+
+void
+MemoryBackend::SaveScores(const std::vector<DBQuery::PlayerScore>& scores)
+{
+    std::lock_guard<std::mutex> l(_mutex);
+    for(auto& score : scores)
+        _scores[score.Name] = score;
+}
+
+
+std::vector<DBQuery::PlayerScore>
+MemoryBackend::LoadScores()
+{
+    std::lock_guard<std::mutex> l(_mutex);
+
+    std::vector<DBQuery::PlayerScore> scores;
+    for(auto& score : _scores)
+        scores.push_back(score.second);
+
+    return scores;
+}
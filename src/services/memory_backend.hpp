@@ -0,0 +1,41 @@
+//
+//  memory_backend.hpp
+//  labyrinth_server
+//
+
+#ifndef memory_backend_hpp
+#define memory_backend_hpp
+
+#include "storage_backend.hpp"
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+
+/*
+ * Process-local accounts, lost on exit. Lets the master run (and be load-tested) without any database.
+ */
+class MemoryBackend : public StorageBackend
+{
+public:
+    static const size_t MAX_MATCHES = 4096;
+
+public:
+    virtual std::string Name() const override
+    { return "Memory"; }
+
+    virtual std::vector<DBQuery::RegisterResult> Register(const std::vector<DBQuery::RegisterQuery>& queries) override;
+    virtual std::vector<DBQuery::LoginResult> Login(const std::vector<DBQuery::LoginQuery>& queries) override;
+    virtual void SaveMatches(const std::vector<DBQuery::MatchRecord>& matches) override;
+    virtual void SaveScores(const std::vector<DBQuery::PlayerScore>& scores) override;
+    virtual std::vector<DBQuery::PlayerScore> LoadScores() override;
+
+private:
+    std::mutex                                      _mutex;
+    std::unordered_map<std::string, std::string>    _passwords;
+    std::deque<DBQuery::MatchRecord>                _matches;   // latest MAX_MATCHES
+    std::unordered_map<std::string, DBQuery::PlayerScore>   _scores;
+};
+
+#endif /* memory_backend_hpp */
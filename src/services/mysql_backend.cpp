@@ -0,0 +1,432 @@
+//
+//  mysql_backend.cpp
+//  labyrinth_server
+//
+
+#include "mysql_backend.hpp"
+
+#include <Poco/Data/MySQL/Connector.h>
+#include <Poco/Data/RecordSet.h>
+#include <Poco/Data/Statement.h>
+#include <Poco/Nullable.h>
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+
+const std::string MySQLBackend::DEFAULT_CONNECTION = "host=127.0.0.1;user=labyrinth;db=labyrinth;password=labyrinthdb;compress=true;auto-reconnect=true";
+
+
+/*
+ * Session checked out of the pool for the whole life of a worker thread.
+ * Statements are compiled once and re-executed with new values of the bound members.
+ * Batched statements take IN-lists and VALUES-lists of power of two sizes, shorter batches
+ * are padded with their first element, so only a handful of them is ever prepared.
+ */
+class MySQLBackend::PreparedSession
+{
+public:
+    static const size_t MAX_BATCH = 64;
+
+    PreparedSession(Poco::Data::Session session)
+    : _session(session),
+      _register(_session),
+      _login(_session)
+    {
+        using namespace Poco::Data::Keywords;
+
+            // relies on UNIQUE index on user.email: taken email gives 0 affected rows
+        _register << "INSERT IGNORE INTO user(email, password) VALUES(?, ?)", use(_email), use(_password);
+        _login << "SELECT password FROM user WHERE email=?", into(_storedPassword), use(_email);
+    }
+
+    DBQuery::RegisterResult Register(const DBQuery::RegisterQuery& query)
+    {
+        _email = query.Email;
+        _password = query.Password;
+
+        DBQuery::RegisterResult result;
+        result.Success = (_register.execute() == 1);
+        return result;
+    }
+
+    DBQuery::LoginResult Login(const DBQuery::LoginQuery& query)
+    {
+        _email = query.Email;
+        _storedPassword = Poco::Nullable<std::string>();
+        _login.execute();
+
+        DBQuery::LoginResult result;
+        result.Registered = !_storedPassword.isNull();
+        result.Success = result.Registered && _storedPassword == query.Password;
+        return result;
+    }
+
+    std::vector<DBQuery::RegisterResult> Execute(const std::vector<DBQuery::RegisterQuery>& queries)
+    {
+        std::vector<DBQuery::RegisterResult> results(queries.size(), DBQuery::RegisterResult{ false });
+
+            // only the first registration of an email in the batch has a chance
+        std::unordered_set<std::string> seen;
+        std::vector<size_t> candidates;
+        std::vector<std::string> candidateEmails;
+        for(size_t i = 0; i < queries.size(); ++i)
+        {
+            if(seen.insert(queries[i].Email).second)
+            {
+                candidates.push_back(i);
+                candidateEmails.push_back(queries[i].Email);
+            }
+        }
+
+        auto existing = SelectPasswords(candidateEmails);
+
+        std::vector<size_t> toInsert;
+        for(auto i : candidates)
+        {
+            if(!existing.count(queries[i].Email))
+                toInsert.push_back(i);
+        }
+
+        size_t inserted = 0;
+        for(size_t from = 0; from < toInsert.size(); from += MAX_BATCH)
+        {
+            auto count = std::min(MAX_BATCH, toInsert.size() - from);
+            auto bucket = BucketSize(count);
+            for(size_t slot = 0; slot < bucket; ++slot)
+            {
+                auto& query = queries[toInsert[from + (slot < count ? slot : 0)]];
+                _batchEmails[slot] = query.Email;
+                _batchPasswords[slot] = query.Password;
+            }
+
+            inserted += InsertStatement(bucket).execute();
+        }
+
+        if(inserted == toInsert.size())
+        {
+            for(auto i : toInsert)
+                results[i].Success = true;
+        }
+        else
+        {
+                // concurrent registration of some emails, owners are the ones whose password is stored
+            std::vector<std::string> insertedEmails;
+            for(auto i : toInsert)
+                insertedEmails.push_back(queries[i].Email);
+
+            auto stored = SelectPasswords(insertedEmails);
+            for(auto i : toInsert)
+            {
+                auto found = stored.find(queries[i].Email);
+                results[i].Success = (found != stored.end() && found->second == queries[i].Password);
+            }
+        }
+
+        return results;
+    }
+
+    std::vector<DBQuery::LoginResult> Execute(const std::vector<DBQuery::LoginQuery>& queries)
+    {
+        std::vector<std::string> emails;
+        for(auto& query : queries)
+            emails.push_back(query.Email);
+
+        auto stored = SelectPasswords(emails);
+
+        std::vector<DBQuery::LoginResult> results(queries.size());
+        for(size_t i = 0; i < queries.size(); ++i)
+        {
+            auto found = stored.find(queries[i].Email);
+            results[i].Registered = (found != stored.end());
+            results[i].Success = results[i].Registered && found->second == queries[i].Password;
+        }
+
+        return results;
+    }
+
+private:
+    static size_t BucketSize(size_t count)
+    {
+        size_t bucket = 1;
+        while(bucket < count)
+            bucket <<= 1;
+
+        return bucket;
+    }
+
+    std::unordered_map<std::string, std::string> SelectPasswords(const std::vector<std::string>& emails)
+    {
+        std::unordered_map<std::string, std::string> stored;
+
+        for(size_t from = 0; from < emails.size(); from += MAX_BATCH)
+        {
+            auto count = std::min(MAX_BATCH, emails.size() - from);
+            auto bucket = BucketSize(count);
+            for(size_t slot = 0; slot < bucket; ++slot)
+                _batchEmails[slot] = emails[from + (slot < count ? slot : 0)];
+
+            _foundEmails.clear();
+            _foundPasswords.clear();
+            SelectStatement(bucket).execute();
+
+            for(size_t i = 0; i < _foundEmails.size(); ++i)
+                stored[_foundEmails[i]] = _foundPasswords[i];
+        }
+
+        return stored;
+    }
+
+    Poco::Data::Statement& SelectStatement(size_t bucket)
+    {
+        using namespace Poco::Data::Keywords;
+
+        auto& statement = _selectBatch[bucket];
+        if(!statement)
+        {
+            std::string sql = "SELECT email, password FROM user WHERE email IN (?";
+            for(size_t i = 1; i < bucket; ++i)
+                sql += ", ?";
+            sql += ")";
+
+            statement = std::make_unique<Poco::Data::Statement>(_session);
+            *statement << sql, into(_foundEmails), into(_foundPasswords);
+            for(size_t i = 0; i < bucket; ++i)
+                *statement, use(_batchEmails[i]);
+        }
+
+        return *statement;
+    }
+
+    Poco::Data::Statement& InsertStatement(size_t bucket)
+    {
+        using namespace Poco::Data::Keywords;
+
+        auto& statement = _insertBatch[bucket];
+        if(!statement)
+        {
+            std::string sql = "INSERT IGNORE INTO user(email, password) VALUES (?, ?)";
+            for(size_t i = 1; i < bucket; ++i)
+                sql += ", (?, ?)";
+
+            statement = std::make_unique<Poco::Data::Statement>(_session);
+            *statement << sql;
+            for(size_t i = 0; i < bucket; ++i)
+                *statement, use(_batchEmails[i]), use(_batchPasswords[i]);
+        }
+
+        return *statement;
+    }
+
+private:
+    Poco::Data::Session             _session;
+    Poco::Data::Statement           _register;
+    Poco::Data::Statement           _login;
+
+        // statements parameters
+    std::string                     _email;
+    std::string                     _password;
+    Poco::Nullable<std::string>     _storedPassword;
+
+        // batched statements, by IN/VALUES list size
+    std::map<size_t, std::unique_ptr<Poco::Data::Statement>>    _selectBatch;
+    std::map<size_t, std::unique_ptr<Poco::Data::Statement>>    _insertBatch;
+
+    std::array<std::string, MAX_BATCH>  _batchEmails;
+    std::array<std::string, MAX_BATCH>  _batchPasswords;
+    std::vector<std::string>            _foundEmails;
+    std::vector<std::string>            _foundPasswords;
+};
+
+
+MySQLBackend::MySQLBackend(const std::string& connection)
+{
+    Poco::Data::MySQL::Connector::registerConnector();
+    _dbSessions = std::make_unique<Poco::Data::SessionPool>("MySQL", connection, 16);
+
+        // Check the database connectivity
+    using namespace Poco::Data::Keywords;
+    size_t registered_players = 0;
+    Poco::Data::Session test_session(_dbSessions->get());
+    Poco::Data::Statement select(test_session);
+    select << "SELECT COUNT(*) FROM user", into(registered_players), now;
+
+        // INSERT IGNORE tells a taken email apart only by the UNIQUE index, without it the same email
+        // silently gets a second account, so the server refuses to start
+    Poco::Data::Statement emailIndex(test_session);
+    emailIndex << "SHOW INDEX FROM user WHERE Column_name='email' AND Non_unique=0", now;
+    if(Poco::Data::RecordSet(emailIndex).rowCount() == 0)
+        throw std::runtime_error("user.email has no UNIQUE index, add it: ALTER TABLE user ADD UNIQUE INDEX(email)");
+
+    test_session << "CREATE TABLE IF NOT EXISTS game_match(id BIGINT AUTO_INCREMENT PRIMARY KEY, server INT UNSIGNED, "
+                    "seed INT UNSIGNED, started_at BIGINT, duration_ms INT UNSIGNED, finished BOOL)", now;
+    test_session << "CREATE TABLE IF NOT EXISTS match_player(match_id BIGINT, name VARCHAR(255), hero INT UNSIGNED, "
+                    "kills INT UNSIGNED, deaths INT UNSIGNED, winner BOOL, INDEX(match_id))", now;
+    test_session << "CREATE TABLE IF NOT EXISTS leaderboard(name VARCHAR(255) PRIMARY KEY, points INT UNSIGNED, "
+                    "wins INT UNSIGNED, kills INT UNSIGNED, deaths INT UNSIGNED, matches INT UNSIGNED)", now;
+}
+
+
+MySQLBackend::~MySQLBackend()
+{
+        // sessions return to the pool, so they go before it
+    std::lock_guard<std::mutex> l(_sessionsMutex);
+    _sessions.clear();
+}
+
+
+std::vector<DBQuery::RegisterResult>
+MySQLBackend::Register(const std::vector<DBQuery::RegisterQuery>& queries)
+{
+    try
+    {
+        if(queries.size() == 1)
+            return { LocalSession().Register(queries.front()) };
+
+        return LocalSession().Execute(queries);
+    }
+    catch(...)
+    {
+        ResetLocalSession();
+        throw;
+    }
+}
+
+
+std::vector<DBQuery::LoginResult>
+MySQLBackend::Login(const std::vector<DBQuery::LoginQuery>& queries)
+{
+    try
+    {
+        if(queries.size() == 1)
+            return { LocalSession().Login(queries.front()) };
+
+        return LocalSession().Execute(queries);
+    }
+    catch(...)
+    {
+        ResetLocalSession();
+        throw;
+    }
+}
+
+
+void
+MySQLBackend::SaveMatches(const std::vector<DBQuery::MatchRecord>& matches)
+{
+    using namespace Poco::Data::Keywords;
+
+        // rare and big writes, a pooled session is enough
+    Poco::Data::Session session(_dbSessions->get());
+
+    session.begin();
+    try
+    {
+        for(auto& match : matches)
+        {
+            session << "INSERT INTO game_match(server, seed, started_at, duration_ms, finished) VALUES(?, ?, ?, ?, ?)",
+                useRef(match.Server), useRef(match.RandomSeed), useRef(match.StartedAt), useRef(match.DurationMs), useRef(match.Finished), now;
+
+            int64_t matchId = 0;
+            session << "SELECT LAST_INSERT_ID()", into(matchId), now;
+
+            for(auto& player : match.Players)
+                session << "INSERT INTO match_player(match_id, name, hero, kills, deaths, winner) VALUES(?, ?, ?, ?, ?, ?)",
+                    useRef(matchId), useRef(player.Name), useRef(player.Hero), useRef(player.Kills), useRef(player.Deaths), useRef(player.Winner), now;
+        }
+    }
+    catch(...)
+    {
+        session.rollback();
+        throw;
+    }
+    session.commit();
+}
+
+
+void
+MySQLBackend::SaveScores(const std::vector<DBQuery::PlayerScore>& scores)
+{
+    using namespace Poco::Data::Keywords;
+
+    Poco::Data::Session session(_dbSessions->get());
+
+    session.begin();
+    try
+    {
+        for(auto& score : scores)
+            session << "INSERT INTO leaderboard(name, points, wins, kills, deaths, matches) VALUES(?, ?, ?, ?, ?, ?) "
+                       "ON DUPLICATE KEY UPDATE points=VALUES(points), wins=VALUES(wins), kills=VALUES(kills), "
+                       "deaths=VALUES(deaths), matches=VALUES(matches)",
+                useRef(score.Name), useRef(score.Points), useRef(score.Wins), useRef(score.Kills), useRef(score.Deaths), useRef(score.Matches), now;
+    }
+    catch(...)
+    {
+        session.rollback();
+        throw;
+    }
+    session.commit();
+}
+
+
+std::vector<DBQuery::PlayerScore>
+MySQLBackend::LoadScores()
+{
+    using namespace Poco::Data::Keywords;
+
+    Poco::Data::Session session(_dbSessions->get());
+
+    std::vector<std::string> names;
+    std::vector<uint32_t> points, wins, kills, deaths, matches;
+    session << "SELECT name, points, wins, kills, deaths, matches FROM leaderboard",
+        into(names), into(points), into(wins), into(kills), into(deaths), into(matches), now;
+
+    std::vector<DBQuery::PlayerScore> scores;
+    for(size_t i = 0; i < names.size(); ++i)
+        scores.push_back({ names[i], points[i], wins[i], kills[i], deaths[i], matches[i] });
+
+    return scores;
+}
+
+
+MySQLBackend::PreparedSession&
+MySQLBackend::LocalSession()
+{
+    auto thread = std::this_thread::get_id();
+    {
+        std::lock_guard<std::mutex> l(_sessionsMutex);
+        auto found = _sessions.find(thread);
+        if(found != _sessions.end())
+            return *found->second;
+    }
+
+        // connecting and preparing is slow, other threads go on meanwhile
+    auto session = std::make_unique<PreparedSession>(_dbSessions->get());
+
+    std::lock_guard<std::mutex> l(_sessionsMutex);
+    auto& local = _sessions[thread];
+    local = std::move(session);
+    return *local;
+}
+
+
+void
+MySQLBackend::ResetLocalSession()
+{
+        // statements may be dead after reconnect, prepare them again on the next query
+    std::unique_ptr<PreparedSession> session;
+    {
+        std::lock_guard<std::mutex> l(_sessionsMutex);
+        auto found = _sessions.find(std::this_thread::get_id());
+        if(found == _sessions.end())
+            return;
+
+        session = std::move(found->second);
+        _sessions.erase(found);
+    }
+        // closed here, outside the lock
+}
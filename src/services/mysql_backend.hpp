@@ -0,0 +1,52 @@
+//
+//  mysql_backend.hpp
+//  labyrinth_server
+//
+
+#ifndef mysql_backend_hpp
+#define mysql_backend_hpp
+
+#include "storage_backend.hpp"
+
+#include <Poco/Data/SessionPool.h>
+
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+
+class MySQLBackend : public StorageBackend
+{
+public:
+    static const std::string DEFAULT_CONNECTION;
+
+public:
+    MySQLBackend(const std::string& connection);
+    ~MySQLBackend();
+
+    virtual std::string Name() const override
+    { return "MySQL"; }
+
+    virtual std::vector<DBQuery::RegisterResult> Register(const std::vector<DBQuery::RegisterQuery>& queries) override;
+    virtual std::vector<DBQuery::LoginResult> Login(const std::vector<DBQuery::LoginQuery>& queries) override;
+    virtual void SaveMatches(const std::vector<DBQuery::MatchRecord>& matches) override;
+    virtual void SaveScores(const std::vector<DBQuery::PlayerScore>& scores) override;
+    virtual std::vector<DBQuery::PlayerScore> LoadScores() override;
+
+private:
+    class PreparedSession;
+
+        // per calling thread, only that thread touches it
+    PreparedSession& LocalSession();
+    void ResetLocalSession();
+
+private:
+    std::unique_ptr<Poco::Data::SessionPool>    _dbSessions;
+
+        // owned by the backend, not by the threads: they give sessions back to the pool while it lives
+    std::mutex                                                              _sessionsMutex;
+    std::unordered_map<std::thread::id, std::unique_ptr<PreparedSession>>   _sessions;
+};
+
+#endif /* mysql_backend_hpp */
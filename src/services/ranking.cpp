@@ -0,0 +1,150 @@
+//
+//  ranking.cpp
+//  labyrinth_server
+//
+
+#include "ranking.hpp"
+
+#include <algorithm>
+
+
+namespace
+{
+    bool Better(const DBQuery::PlayerScore& lhs, const DBQuery::PlayerScore& rhs)
+    {
+        if(lhs.Points != rhs.Points)
+            return lhs.Points > rhs.Points;
+
+        return lhs.Name < rhs.Name;
+    }
+}
+
+
+Ranking::Ranking(size_t topSize)
+: _topSize(topSize),
+  _tree(MAX_POINTS + 1, 0)
+{
+    _top.reserve(_topSize + 1);
+}
+
+
+const Ranking::Score&
+Ranking::Add(const std::string& name, bool winner, uint32_t kills, uint32_t deaths)
+{
+    auto inserted = _scores.emplace(name, Score { name, 0, 0, 0, 0, 0 });
+    auto& score = inserted.first->second;
+    auto previousPoints = score.Points;
+
+    score.Points += (winner ? POINTS_PER_WIN : 0) + kills * POINTS_PER_KILL;
+    score.Wins += winner ? 1 : 0;
+    score.Kills += kills;
+    score.Deaths += deaths;
+    score.Matches += 1;
+
+    Update(score, previousPoints, !inserted.second);
+    return score;
+}
+
+
+void
+Ranking::Set(const Score& score)
+{
+    auto inserted = _scores.emplace(score.Name, score);
+    auto& stored = inserted.first->second;
+    auto previousPoints = stored.Points;
+
+    stored = score;
+    Update(stored, previousPoints, !inserted.second);
+}
+
+
+const Ranking::Score*
+Ranking::Find(const std::string& name) const
+{
+    auto score = _scores.find(name);
+    return score != _scores.end() ? &score->second : nullptr;
+}
+
+
+uint32_t
+Ranking::Rank(const std::string& name) const
+{
+    auto score = Find(name);
+    if(!score)
+        return 0;
+
+    return static_cast<uint32_t>(_scores.size()) - CountUpTo(score->Points) + 1;
+}
+
+
+std::vector<Ranking::Score>
+Ranking::TakeChanged()
+{
+    std::vector<Score> changed;
+    changed.reserve(_changed.size());
+    for(auto& name : _changed)
+        changed.push_back(_scores.at(name));
+
+    _changed.clear();
+    return changed;
+}
+
+
+void
+Ranking::MarkChanged(const std::vector<Score>& scores)
+{
+    for(auto& score : scores)
+        _changed.insert(score.Name);
+}
+
+
+void
+Ranking::Count(uint32_t points, int32_t delta)
+{
+    for(auto idx = Bucket(points); idx <= MAX_POINTS; idx += idx & (~idx + 1))
+        _tree[idx] += delta;
+}
+
+
+uint32_t
+Ranking::CountUpTo(uint32_t points) const
+{
+    int32_t count = 0;
+    for(auto idx = Bucket(points); idx > 0; idx -= idx & (~idx + 1))
+        count += _tree[idx];
+
+    return static_cast<uint32_t>(count);
+}
+
+
+void
+Ranking::Update(Score& score, uint32_t previousPoints, bool known)
+{
+    if(known)
+        Count(previousPoints, -1);
+    Count(score.Points, +1);
+
+    UpdateTop(score);
+    _changed.insert(score.Name);
+}
+
+
+void
+Ranking::UpdateTop(const Score& score)
+{
+    auto current = std::find_if(_top.begin(),
+                                _top.end(),
+                                [&score](const Score& top)
+                                {
+                                    return top.Name == score.Name;
+                                });
+    if(current != _top.end())
+        _top.erase(current);
+
+    if(_top.size() >= _topSize && !Better(score, _top.back()))
+        return;
+
+    _top.insert(std::upper_bound(_top.begin(), _top.end(), score, Better), score);
+    if(_top.size() > _topSize)
+        _top.pop_back();
+}
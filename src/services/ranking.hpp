@@ -0,0 +1,90 @@
+//
+//  ranking.hpp
+//  labyrinth_server
+//
+
+#ifndef ranking_hpp
+#define ranking_hpp
+
+#include "storage_backend.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+
+/*
+ * Player scores with incrementally maintained top list and rank index.
+ * Rank is the number of players with more points plus one, counted by a Fenwick tree over point values,
+ * so both an update and a lookup take O(log MAX_POINTS) no matter how many players there are.
+ * Scores only grow during a run, a player pushed out of the top can return there only with an update
+ * of their own score, so the top list never has to be refilled from the rest.
+ * Not thread safe.
+ */
+class Ranking
+{
+public:
+    using Score = DBQuery::PlayerScore;
+
+    static const uint32_t MAX_POINTS = 1 << 20;     // higher scores share the last value in the rank index
+    static const uint32_t POINTS_PER_WIN = 10;
+    static const uint32_t POINTS_PER_KILL = 1;
+
+public:
+    Ranking(size_t topSize = 10);
+
+    /*
+     * Adds one match result to player's score.
+     */
+    const Score& Add(const std::string& name, bool winner, uint32_t kills, uint32_t deaths);
+
+    /*
+     * Replaces player's score, used to restore a checkpoint.
+     */
+    void Set(const Score& score);
+
+    const Score* Find(const std::string& name) const;
+
+    /*
+     * 1 for the best player, equal points share a rank. 0 if the player has no score.
+     */
+    uint32_t Rank(const std::string& name) const;
+
+        // sorted by points, best first
+    const std::vector<Score>& Top() const
+    { return _top; }
+
+    size_t Size() const
+    { return _scores.size(); }
+
+    /*
+     * Scores changed since the previous call.
+     */
+    std::vector<Score> TakeChanged();
+    void MarkChanged(const std::vector<Score>& scores);
+
+private:
+    static uint32_t Bucket(uint32_t points)
+    { return std::min(points, MAX_POINTS - 1) + 1; }
+
+        // Fenwick tree over buckets
+    void Count(uint32_t points, int32_t delta);
+    uint32_t CountUpTo(uint32_t points) const;
+
+    void Update(Score& score, uint32_t previousPoints, bool known);
+    void UpdateTop(const Score& score);
+
+private:
+    const size_t                                _topSize;
+
+    std::unordered_map<std::string, Score>      _scores;
+    std::vector<int32_t>                        _tree;
+    std::vector<Score>                          _top;
+
+    std::unordered_set<std::string>             _changed;
+};
+
+#endif /* ranking_hpp */
@@ -0,0 +1,162 @@
+//
+//  sqlite_backend.cpp
+//  labyrinth_server
+//
+
+#include "sqlite_backend.hpp"
+
+#include <Poco/Data/SQLite/Connector.h>
+
+
+namespace
+{
+    const std::string& RegisteredConnector()
+    {
+        static const std::string name = (Poco::Data::SQLite::Connector::registerConnector(), "SQLite");
+        return name;
+    }
+}
+
+
+SQLiteBackend::SQLiteBackend(const std::string& path)
+: _session(RegisteredConnector(), path),
+  _register(_session),
+  _login(_session)
+{
+    using namespace Poco::Data::Keywords;
+
+    _session << "CREATE TABLE IF NOT EXISTS user(email VARCHAR(255) PRIMARY KEY, password VARCHAR(255) NOT NULL)", now;
+    _session << "CREATE TABLE IF NOT EXISTS game_match(id INTEGER PRIMARY KEY AUTOINCREMENT, server INTEGER, seed INTEGER, "
+                "started_at INTEGER, duration_ms INTEGER, finished INTEGER)", now;
+    _session << "CREATE TABLE IF NOT EXISTS match_player(match_id INTEGER, name VARCHAR(255), hero INTEGER, "
+                "kills INTEGER, deaths INTEGER, winner INTEGER)", now;
+    _session << "CREATE TABLE IF NOT EXISTS leaderboard(name VARCHAR(255) PRIMARY KEY, points INTEGER, wins INTEGER, "
+                "kills INTEGER, deaths INTEGER, matches INTEGER)", now;
+
+    _register << "INSERT OR IGNORE INTO user(email, password) VALUES(?, ?)", use(_email), use(_password);
+    _login << "SELECT password FROM user WHERE email=?", into(_storedPassword), use(_email);
+}
+
+
+std::vector<DBQuery::RegisterResult>
+SQLiteBackend::Register(const std::vector<DBQuery::RegisterQuery>& queries)
+{
+    std::vector<DBQuery::RegisterResult> results(queries.size());
+
+    std::lock_guard<std::mutex> l(_mutex);
+
+        // whole batch is one transaction, so one fsync
+    _session.begin();
+    try
+    {
+        for(size_t i = 0; i < queries.size(); ++i)
+        {
+            _email = queries[i].Email;
+            _password = queries[i].Password;
+            results[i].Success = (_register.execute() == 1);
+        }
+    }
+    catch(...)
+    {
+        _session.rollback();
+        throw;
+    }
+    _session.commit();
+
+    return results;
+}
+
+
+std::vector<DBQuery::LoginResult>
+SQLiteBackend::Login(const std::vector<DBQuery::LoginQuery>& queries)
+{
+    std::vector<DBQuery::LoginResult> results(queries.size());
+
+    std::lock_guard<std::mutex> l(_mutex);
+    for(size_t i = 0; i < queries.size(); ++i)
+    {
+        _email = queries[i].Email;
+        _storedPassword = Poco::Nullable<std::string>();
+        _login.execute();
+
+        results[i].Registered = !_storedPassword.isNull();
+        results[i].Success = results[i].Registered && _storedPassword == queries[i].Password;
+    }
+
+    return results;
+}
+
+
+void
+SQLiteBackend::SaveMatches(const std::vector<DBQuery::MatchRecord>& matches)
+{
+    using namespace Poco::Data::Keywords;
+
+    std::lock_guard<std::mutex> l(_mutex);
+
+    _session.begin();
+    try
+    {
+        for(auto& match : matches)
+        {
+            _session << "INSERT INTO game_match(server, seed, started_at, duration_ms, finished) VALUES(?, ?, ?, ?, ?)",
+                useRef(match.Server), useRef(match.RandomSeed), useRef(match.StartedAt), useRef(match.DurationMs), useRef(match.Finished), now;
+
+            int64_t matchId = 0;
+            _session << "SELECT last_insert_rowid()", into(matchId), now;
+
+            for(auto& player : match.Players)
+                _session << "INSERT INTO match_player(match_id, name, hero, kills, deaths, winner) VALUES(?, ?, ?, ?, ?, ?)",
+                    useRef(matchId), useRef(player.Name), useRef(player.Hero), useRef(player.Kills), useRef(player.Deaths), useRef(player.Winner), now;
+        }
+    }
+    catch(...)
+    {
+        _session.rollback();
+        throw;
+    }
+    _session.commit();
+}
+
+
+void
+SQLiteBackend::SaveScores(const std::vector<DBQuery::PlayerScore>& scores)
+{
+    using namespace Poco::Data::Keywords;
+
+    std::lock_guard<std::mutex> l(_mutex);
+
+    _session.begin();
+    try
+    {
+        for(auto& score : scores)
+            _session << "INSERT OR REPLACE INTO leaderboard(name, points, wins, kills, deaths, matches) VALUES(?, ?, ?, ?, ?, ?)",
+                useRef(score.Name), useRef(score.Points), useRef(score.Wins), useRef(score.Kills), useRef(score.Deaths), useRef(score.Matches), now;
+    }
+    catch(...)
+    {
+        _session.rollback();
+        throw;
+    }
+    _session.commit();
+}
+
+
+std::vector<DBQuery::PlayerScore>
+SQLiteBackend::LoadScores()
+{
+    using namespace Poco::Data::Keywords;
+
+    std::lock_guard<std::mutex> l(_mutex);
+
+    std::vector<std::string> names;
+    std::vector<uint32_t> points, wins, kills, deaths, matches;
+    _session << "SELECT name, points, wins, kills, deaths, matches FROM leaderboard",
+        into(names), into(points), into(wins), into(kills), into(deaths), into(matches), now;
+
+    std::vector<DBQuery::PlayerScore> scores;
+    for(size_t i = 0; i < names.size(); ++i)
+        scores.push_back({ names[i], points[i], wins[i], kills[i], deaths[i], matches[i] });
+
+    return scores;
+}
@@ -0,0 +1,48 @@
+//
+//  sqlite_backend.hpp
+//  labyrinth_server
+//
+
+#ifndef sqlite_backend_hpp
+#define sqlite_backend_hpp
+
+#include "storage_backend.hpp"
+
+#include <Poco/Data/Session.h>
+#include <Poco/Data/Statement.h>
+#include <Poco/Nullable.h>
+
+#include <mutex>
+
+
+/*
+ * Embedded database file, creates the user table on first use.
+ * SQLite serializes writers anyway, so one session guarded by a mutex is enough.
+ */
+class SQLiteBackend : public StorageBackend
+{
+public:
+    SQLiteBackend(const std::string& path);
+
+    virtual std::string Name() const override
+    { return "SQLite"; }
+
+    virtual std::vector<DBQuery::RegisterResult> Register(const std::vector<DBQuery::RegisterQuery>& queries) override;
+    virtual std::vector<DBQuery::LoginResult> Login(const std::vector<DBQuery::LoginQuery>& queries) override;
+    virtual void SaveMatches(const std::vector<DBQuery::MatchRecord>& matches) override;
+    virtual void SaveScores(const std::vector<DBQuery::PlayerScore>& scores) override;
+    virtual std::vector<DBQuery::PlayerScore> LoadScores() override;
+
+private:
+    std::mutex                      _mutex;
+    Poco::Data::Session             _session;
+    Poco::Data::Statement           _register;
+    Poco::Data::Statement           _login;
+
+        // statements parameters
+    std::string                     _email;
+    std::string                     _password;
+    Poco::Nullable<std::string>     _storedPassword;
+};
+
+#endif /* sqlite_backend_hpp */
@@ -0,0 +1,30 @@
+//
+//  storage_backend.cpp
+//  labyrinth_server
+//
+
+#include "storage_backend.hpp"
+
+#include "memory_backend.hpp"
+#include "mysql_backend.hpp"
+#include "sqlite_backend.hpp"
+
+#include <stdexcept>
+
+
+std::unique_ptr<StorageBackend>
+StorageBackend::Create(const std::string& spec)
+{
+    auto separator = spec.find(':');
+    auto type = spec.substr(0, separator);
+    auto params = (separator == std::string::npos) ? std::string() : spec.substr(separator + 1);
+
+    if(type == "mysql")
+        return std::make_unique<MySQLBackend>(params.empty() ? MySQLBackend::DEFAULT_CONNECTION : params);
+    if(type == "sqlite" && !params.empty())
+        return std::make_unique<SQLiteBackend>(params);
+    if(type == "memory")
+        return std::make_unique<MemoryBackend>();
+
+    throw std::invalid_argument("Unknown storage backend: " + spec);
+}
@@ -0,0 +1,114 @@
+//
+//  storage_backend.hpp
+//  labyrinth_server
+//
+
+#ifndef storage_backend_hpp
+#define storage_backend_hpp
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace DBQuery
+{
+        // set by DatabaseAccessor, queries that were not executed carry no data
+    enum class Status : uint8_t
+    {
+        OK,
+        OVERLOADED,     // queue was full, rejected on arrival
+        TIMED_OUT       // deadline passed before a worker took the query
+    };
+
+    struct RegisterQuery
+    {
+        std::string Email;
+        std::string Password;
+    };
+    struct RegisterResult
+    {
+        bool Success;
+        Status Outcome = Status::OK;
+    };
+
+    struct LoginQuery
+    {
+        std::string Email;
+        std::string Password;
+    };
+    struct LoginResult
+    {
+        bool Success;
+        bool Registered;    // false if email is unknown
+        Status Outcome = Status::OK;
+    };
+
+    struct MatchPlayer
+    {
+        std::string Name;
+        uint32_t Hero;
+        uint32_t Kills;
+        uint32_t Deaths;
+        bool Winner;
+    };
+    struct MatchRecord
+    {
+        uint32_t Server;        // game server port
+        uint32_t RandomSeed;
+        int64_t StartedAt;      // unix time, seconds
+        uint32_t DurationMs;
+        bool Finished;          // false if the match was aborted
+        std::vector<MatchPlayer> Players;
+    };
+
+    struct PlayerScore
+    {
+        std::string Name;
+        uint32_t Points;
+        uint32_t Wins;
+        uint32_t Kills;
+        uint32_t Deaths;
+        uint32_t Matches;
+    };
+}
+
+
+/*
+ * Accounts storage used by DatabaseAccessor.
+ * Methods are called from several DatabaseAccessor workers at once and take whole batches,
+ * result i answers query i. Errors are reported with exceptions.
+ */
+class StorageBackend
+{
+public:
+    /*
+     * spec is one of:
+     *   mysql[:<connection string>]
+     *   sqlite:<database file>
+     *   memory
+     */
+    static std::unique_ptr<StorageBackend> Create(const std::string& spec);
+
+    virtual ~StorageBackend()
+    { }
+
+    virtual std::string Name() const = 0;
+
+    virtual std::vector<DBQuery::RegisterResult> Register(const std::vector<DBQuery::RegisterQuery>& queries) = 0;
+    virtual std::vector<DBQuery::LoginResult> Login(const std::vector<DBQuery::LoginQuery>& queries) = 0;
+
+    /*
+     * All matches are written in one transaction, nothing is written on exception.
+     */
+    virtual void SaveMatches(const std::vector<DBQuery::MatchRecord>& matches) = 0;
+
+    /*
+     * Leaderboard checkpoint: scores replace the stored ones of the same players.
+     */
+    virtual void SaveScores(const std::vector<DBQuery::PlayerScore>& scores) = 0;
+    virtual std::vector<DBQuery::PlayerScore> LoadScores() = 0;
+};
+
+#endif /* storage_backend_hpp */
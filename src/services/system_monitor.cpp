@@ -8,6 +8,8 @@
 
 #include "system_monitor.hpp"
 
+#include "DatabaseAccessor.hpp"
+
 namespace
 {
 
@@ -134,7 +136,7 @@ SystemMonitor::SystemMonitor()
   _timer(std::make_unique<Poco::Timer>(180000, 180000)),
   _lastRSS()
 {
-    _logger.Debug() << "SystemMonitor is up, report interval: " << _timer->getPeriodicInterval() << "ms";
+    LOG_DEBUG(_logger) << "SystemMonitor is up, report interval: " << _timer->getPeriodicInterval() << "ms";
 
     Poco::TimerCallback<SystemMonitor> free_callback(*this,
                                                      &SystemMonitor::PrintStats);
@@ -142,6 +144,16 @@ SystemMonitor::SystemMonitor()
 }
 
 
+size_t
+SystemMonitor::CurrentRSS()
+{ return getCurrentRSS(); }
+
+
+size_t
+SystemMonitor::PeakRSS()
+{ return getPeakRSS(); }
+
+
 void
 SystemMonitor::PrintStats(Poco::Timer& timer)
 {
@@ -149,11 +161,17 @@ SystemMonitor::PrintStats(Poco::Timer& timer)
     auto currentRSS = getCurrentRSS()/1024;
     if(currentRSS > _lastRSS)
     {
-        _logger.Info() << "Memory usage: " << currentRSS << "kB. Raised since last report: " << (currentRSS - _lastRSS) << "kB";
+        LOG_INFO(_logger) << "Memory usage: " << currentRSS << "kB. Raised since last report: " << (currentRSS - _lastRSS) << "kB";
     }
     else if(currentRSS <= _lastRSS)
     {
-        _logger.Info() << "Memory usage: " << currentRSS << "kB. Freed since last report: " << (_lastRSS - currentRSS) << "kB";
+        LOG_INFO(_logger) << "Memory usage: " << currentRSS << "kB. Freed since last report: " << (_lastRSS - currentRSS) << "kB";
     }
     _lastRSS = currentRSS;
+
+    auto db = DatabaseAccessor::Instance().GetMetrics();
+    LOG_INFO(_logger) << "Database queue: " << db.QueueDepth << " now, " << db.MaxQueueDepth << " max. Wait: "
+    << db.AverageWait.count() << "us avg, " << db.MaxWait.count() << "us max. Executed: " << db.Executed
+    << ", overloaded: " << db.Overloaded << ", timed out: " << db.TimedOut << ". Latency: "
+    << db.LatencyP50.count() << "us p50, " << db.LatencyP99.count() << "us p99";
 }
@@ -21,6 +21,10 @@ class SystemMonitor
 public:
     SystemMonitor();
 
+        // bytes, 0 if unsupported on this OS
+    static size_t CurrentRSS();
+    static size_t PeakRSS();
+
 private:
     void PrintStats(Poco::Timer& timer);
 
@@ -9,8 +9,8 @@
 #ifndef SafePacketGetter_hpp
 #define SafePacketGetter_hpp
 
-#include "named_logger.hpp"
 #include "optional.hpp"
+#include "rate_limited_log.hpp"
 
 #include <Poco/Net/DatagramSocket.h>
 #include <flatbuffers/flatbuffers.h>
@@ -25,25 +25,52 @@ struct Packet
 
 class SafePacketGetter
 {
+public:
+    enum RejectReason
+    {
+        OVERSIZED,
+        VERIFICATION_FAILED
+    };
+
 public:
     SafePacketGetter(Poco::Net::DatagramSocket& socket)
-    : _logger("SafePacketGetter", NamedLogger::Mode::STDIO),
+    : _rejectedLog(LogHandle(LogChannel()),
+                   { "Dropped packets bigger than buffer_size, probably a hack or DDoS",
+                     "Dropped packets which failed verification, probably a DDoS" }),
       _socket(socket)
     { }
 
+    /*
+     * Lets the owner's loop report the last burst of rejected packets.
+     */
+    void FlushWarnings()
+    { _rejectedLog.Flush(); }
+
     template<typename T>
     std::experimental::optional<Packet> Get()
     {
         Packet packet;
+        if(!Get<T>(packet))
+            return std::experimental::optional<Packet>();
+
+        return packet;
+    }
+
+    /*
+     * Receives into existing packet, so its Data capacity is reused between calls.
+     */
+    template<typename T>
+    bool Get(Packet& packet)
+    {
         if(_socket.available() > _internalBuffer.size())
         {
             _socket.receiveFrom(_internalBuffer.data(),
                                 1,
                                 packet.Sender);
 
-            _logger.Warning() << "Received packet which size is more than buffer_size. Probably, its a hack or DDoS. Sender addr: " << packet.Sender.toString();
+            _rejectedLog.Report(OVERSIZED, packet.Sender);
 
-            return std::experimental::optional<Packet>();
+            return false;
         }
 
         auto packSize = _socket.receiveFrom(_internalBuffer.data(),
@@ -52,18 +79,25 @@ public:
 
         if(!flatbuffers::Verifier(_internalBuffer.data(), packSize).VerifyBuffer<T>(nullptr))
         {
-            _logger.Warning() << "Packet verification failed, probably a DDoS. Sender addr: " << packet.Sender.toString();
+            _rejectedLog.Report(VERIFICATION_FAILED, packet.Sender);
 
-            return std::experimental::optional<Packet>();
+            return false;
         }
 
         packet.Data.assign(_internalBuffer.begin(),
                            _internalBuffer.begin() + packSize);
-        return packet;
+        return true;
+    }
+
+private:
+    static NamedLogger& LogChannel()
+    {
+        static NamedLogger& channel = NamedLogger::Channel("SafePacketGetter");
+        return channel;
     }
 
 private:
-    NamedLogger                 _logger;
+    RateLimitedLog              _rejectedLog;
     Poco::Net::DatagramSocket&  _socket;
     std::array<uint8_t, 4096>   _internalBuffer;
 };
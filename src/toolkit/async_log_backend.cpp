@@ -0,0 +1,285 @@
+//
+//  async_log_backend.cpp
+//  labyrinth_server
+//
+
+#include "async_log_backend.hpp"
+
+#include "named_logger.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+
+static_assert(sizeof(AsyncLogBackend::Record) == 256, "log record outgrew its cache lines");
+
+
+AsyncLogBackend::Ring::Ring(size_t capacity)
+: Dropped(0),
+  ReportedDrops(0),
+  _mask(capacity - 1),
+  _records(capacity),
+  _head(0),
+  _tail(0),
+  _producerVersion(0),
+  _firstVersion(1)
+{ }
+
+
+AsyncLogBackend::Record*
+AsyncLogBackend::Ring::Reserve()
+{
+    auto tail = _tail.load(std::memory_order_relaxed);
+    if(tail - _head.load(std::memory_order_acquire) > _mask)
+        return nullptr;
+
+    return &_records[tail & _mask];
+}
+
+
+void
+AsyncLogBackend::Ring::Commit()
+{ _tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+
+uint32_t
+AsyncLogBackend::Ring::NameVersion(const std::string& thread)
+{
+    if(_producerVersion && thread == _producerName)
+        return _producerVersion;
+
+    _producerName = thread;
+    std::lock_guard<std::mutex> l(_namesMutex);
+    _names.push_back(thread);
+    return ++_producerVersion;
+}
+
+
+const AsyncLogBackend::Record*
+AsyncLogBackend::Ring::Front()
+{
+    auto head = _head.load(std::memory_order_relaxed);
+    if(head == _tail.load(std::memory_order_acquire))
+        return nullptr;
+
+    return &_records[head & _mask];
+}
+
+
+void
+AsyncLogBackend::Ring::Pop()
+{ _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+
+const std::string&
+AsyncLogBackend::Ring::Name(uint32_t version)
+{
+    std::lock_guard<std::mutex> l(_namesMutex);
+
+        // records come in push order, older names are not needed anymore
+    while(_firstVersion < version && _names.size() > 1)
+    {
+        _names.pop_front();
+        ++_firstVersion;
+    }
+
+    return _names.front();
+}
+
+
+AsyncLogBackend&
+AsyncLogBackend::Instance()
+{
+    static AsyncLogBackend backend;
+    return backend;
+}
+
+
+AsyncLogBackend::AsyncLogBackend()
+: _running(false),
+  _ringCapacity(512),
+  _thread("AsyncLogBackend")
+{ }
+
+
+AsyncLogBackend::~AsyncLogBackend()
+{ Stop(); }
+
+
+void
+AsyncLogBackend::Start(size_t ringCapacity)
+{
+    if(_running.exchange(true))
+        return;
+
+    _ringCapacity = 1;
+    while(_ringCapacity < ringCapacity)
+        _ringCapacity <<= 1;
+
+    _thread.start(*this);
+}
+
+
+void
+AsyncLogBackend::Stop()
+{
+    if(!_running.exchange(false))
+        return;
+
+    _thread.join();
+
+        // something could have been pushed after the last drain
+    std::string tail;
+    Drain(tail);
+    std::cout << tail << std::flush;
+}
+
+
+uint16_t
+AsyncLogBackend::RegisterLogger(const std::string& name)
+{
+    std::lock_guard<std::mutex> l(_loggersMutex);
+
+    _loggers.push_back(name);
+    return static_cast<uint16_t>(_loggers.size());
+}
+
+
+bool
+AsyncLogBackend::Push(std::chrono::system_clock::time_point time,
+                      uint8_t level,
+                      uint16_t loggerId,
+                      uint32_t instance,
+                      const char* format,
+                      const void* data,
+                      size_t size)
+{
+    auto& ring = LocalRing();
+    auto record = ring.Reserve();
+    if(!record)
+    {
+        ring.Dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    record->Time = time;
+    record->Format = format;
+    record->Instance = instance;
+    record->NameVersion = ring.NameVersion(NamedLogger::ThreadName());
+    record->LoggerId = loggerId;
+    record->Level = level;
+    record->Truncated = size > DATA_SIZE;
+    record->Length = static_cast<uint16_t>(std::min(size, size_t(DATA_SIZE)));
+    std::memcpy(record->Data, data, record->Length);
+    ring.Commit();
+
+    return true;
+}
+
+
+void
+AsyncLogBackend::run()
+{
+    std::string out;
+    while(_running.load(std::memory_order_relaxed))
+    {
+        if(!Drain(out))
+        {
+            Poco::Thread::sleep(1);
+            continue;
+        }
+
+        std::cout << out << std::flush;
+        out.clear();
+    }
+}
+
+
+AsyncLogBackend::Ring&
+AsyncLogBackend::LocalRing()
+{
+    thread_local std::shared_ptr<Ring> ring;
+    if(!ring)
+    {
+        ring = std::make_shared<Ring>(_ringCapacity);
+
+        std::lock_guard<std::mutex> l(_ringsMutex);
+        _rings.push_back(ring);
+    }
+
+    return *ring;
+}
+
+
+size_t
+AsyncLogBackend::Drain(std::string& out)
+{
+    std::lock_guard<std::mutex> l(_ringsMutex);
+
+    size_t drained = 0;
+    std::ostringstream oss;
+    for(auto& ring : _rings)
+    {
+        while(auto record = ring->Front())
+        {
+            FormatRecord(oss, *ring, *record);
+            ring->Pop();
+            ++drained;
+        }
+
+        auto dropped = ring->Dropped.load(std::memory_order_relaxed);
+        if(dropped != ring->ReportedDrops)
+        {
+            NamedLogger::Format(oss,
+                                std::chrono::system_clock::now(),
+                                NamedLogger::Level::WARNING,
+                                "AsyncLogBackend",
+                                "AsyncLogBackend",
+                                NamedLogger::NO_INSTANCE,
+                                std::to_string(dropped - ring->ReportedDrops) + " records dropped, log ring is full");
+            ring->ReportedDrops = dropped;
+            ++drained;
+        }
+    }
+
+        // rings of finished threads
+    _rings.erase(std::remove_if(_rings.begin(),
+                                _rings.end(),
+                                [](const std::shared_ptr<Ring>& ring)
+                                {
+                                    return ring.use_count() == 1 && ring->Empty();
+                                }),
+                 _rings.end());
+
+    out += oss.str();
+    return drained;
+}
+
+
+void
+AsyncLogBackend::FormatRecord(std::ostream& os, Ring& ring, const Record& record)
+{
+    static const std::string unknown = "__unknown__";
+
+    const std::string * logger = &unknown;
+    {
+        std::lock_guard<std::mutex> l(_loggersMutex);
+        if(record.LoggerId > 0 && record.LoggerId <= _loggers.size())
+            logger = &_loggers[record.LoggerId - 1];
+    }
+
+    auto level = static_cast<NamedLogger::Level>(record.Level);
+    NamedLogger::FormatHeader(os, record.Time, level, ring.Name(record.NameVersion), *logger, record.Instance);
+
+    if(record.Format)
+        BinaryLog::FormatArgs(os, record.Format, record.Data, record.Length);
+    else
+        os.write(reinterpret_cast<const char*>(record.Data), record.Length);
+
+        // cut lines still get their color reset
+    if(record.Truncated)
+        os << " [truncated]";
+    os << Color::RESET << std::endl;
+}
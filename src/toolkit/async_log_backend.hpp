@@ -0,0 +1,143 @@
+//
+//  async_log_backend.hpp
+//  labyrinth_server
+//
+
+#ifndef async_log_backend_hpp
+#define async_log_backend_hpp
+
+#include <Poco/Runnable.h>
+#include <Poco/Thread.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+/*
+ * Background writer for NamedLogger.
+ * Each producer thread owns a single-producer/single-consumer ring of fixed-size records, pushing is
+ * a memcpy and one release store. Records keep raw parts only: logger id, instance, level, version of
+ * the thread name and either the text of a stream statement or the format and encoded arguments of
+ * a BLOG_* one. A ring keeps the thread name once per rename, not per record. Backend thread
+ * drains all rings, formats lines and does the I/O. When a ring is full the record is dropped and
+ * counted, backend reports drop counts in the log.
+ */
+class AsyncLogBackend : public Poco::Runnable
+{
+public:
+    static const size_t DATA_SIZE = 226; // record is 256 bytes
+
+    struct Record
+    {
+        std::chrono::system_clock::time_point   Time;
+        const char *                            Format;     // nullptr - Data is text
+        uint32_t                                Instance;
+        uint32_t                                NameVersion;    // thread name of the ring at push
+        uint16_t                                LoggerId;
+        uint8_t                                 Level;
+        bool                                    Truncated;
+        uint16_t                                Length;
+        uint8_t                                 Data[DATA_SIZE];
+    };
+
+private:
+    class Ring
+    {
+    public:
+        Ring(size_t capacity);
+
+            // producer side
+        Record* Reserve();
+        void Commit();
+        uint32_t NameVersion(const std::string& thread); // new version when the thread was renamed
+
+            // consumer side
+        const Record* Front();
+        void Pop();
+        const std::string& Name(uint32_t version);
+
+        bool Empty() const
+        { return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire); }
+
+        std::atomic<uint64_t>   Dropped;
+        uint64_t                ReportedDrops;
+
+    private:
+        const size_t            _mask;
+        std::vector<Record>     _records;
+        std::atomic<size_t>     _head; // next to read
+        std::atomic<size_t>     _tail; // next to write
+
+        std::string             _producerName;
+        uint32_t                _producerVersion;
+
+        std::mutex              _namesMutex;
+        std::deque<std::string> _names;         // versions from _firstVersion on, still used by records
+        uint32_t                _firstVersion;
+    };
+
+public:
+    static AsyncLogBackend& Instance();
+
+    ~AsyncLogBackend();
+
+    /*
+     * ringCapacity is rounded up to power of two, every thread that logs gets its own ring.
+     */
+    void Start(size_t ringCapacity = 512);
+
+    /*
+     * Drains every ring and stops the backend thread, further records are written synchronously.
+     */
+    void Stop();
+
+    bool IsRunning() const
+    { return _running.load(std::memory_order_relaxed); }
+
+    /*
+     * Id of a logger name, taken once per logger. Names are kept until the end of the program.
+     */
+    uint16_t RegisterLogger(const std::string& name);
+
+    /*
+     * Format is nullptr for plain text, otherwise data is BinaryArgs of a static format string.
+     * Data longer than DATA_SIZE is cut and the line is marked. Returns false if record was dropped.
+     */
+    bool Push(std::chrono::system_clock::time_point time,
+              uint8_t level,
+              uint16_t loggerId,
+              uint32_t instance,
+              const char* format,
+              const void* data,
+              size_t size);
+
+    virtual void run() override;
+
+private:
+    AsyncLogBackend();
+
+    Ring& LocalRing();
+    size_t Drain(std::string& out);
+    void FormatRecord(std::ostream& os, Ring& ring, const Record& record);
+
+private:
+    std::atomic<bool>                   _running;
+    size_t                              _ringCapacity;
+
+    std::mutex                          _ringsMutex;
+    std::vector<std::shared_ptr<Ring>>  _rings;
+
+    std::mutex                          _loggersMutex;
+    std::deque<std::string>             _loggers;   // by id - 1, references stay valid
+
+    Poco::Thread                        _thread;
+};
+
+#endif /* async_log_backend_hpp */
@@ -0,0 +1,310 @@
+//
+//  binary_log.cpp
+//  labyrinth_server
+//
+
+#include "binary_log.hpp"
+
+#include <Poco/Thread.h>
+
+#include <chrono>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace BinaryLogFormat;
+
+
+namespace
+{
+    int64_t NowNs(std::chrono::system_clock::time_point time)
+    { return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count(); }
+
+    int64_t NowNs(std::chrono::steady_clock::time_point time)
+    { return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count(); }
+
+    size_t Align(size_t size)
+    { return (size + 3) & ~size_t(3); }
+}
+
+
+BinaryLog&
+BinaryLog::Instance()
+{
+    static BinaryLog log;
+    return log;
+}
+
+
+BinaryLog::BinaryLog()
+: _open(false),
+  _header(nullptr),
+  _ring(nullptr),
+  _mappedSize(0),
+  _formatsCount(0),
+  _loggersCount(0),
+  _threadsCount(0)
+{ }
+
+
+BinaryLog::~BinaryLog()
+{ Close(); }
+
+
+bool
+BinaryLog::Open(const std::string& path, size_t capacity)
+{
+    std::lock_guard<std::mutex> l(_mutex);
+    if(_ring)
+        return true;
+
+    capacity = Align(capacity);
+    _mappedSize = sizeof(FileHeader) + capacity;
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0)
+        return false;
+
+    if(::ftruncate(fd, _mappedSize) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void * mapped = ::mmap(nullptr, _mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(mapped == MAP_FAILED)
+        return false;
+
+    _header = static_cast<FileHeader*>(mapped);
+    _header->Magic = MAGIC;
+    _header->Version = VERSION;
+    _header->Capacity = capacity;
+    _header->BaseWallNs = NowNs(std::chrono::system_clock::now());
+    _header->BaseSteadyNs = NowNs(std::chrono::steady_clock::now());
+    _header->Head = 0;
+    _header->Tail = 0;
+    _ring = static_cast<uint8_t*>(mapped) + sizeof(FileHeader);
+
+        // formats and loggers registered before Open
+    _dictionary.open(path + ".dict", std::ios::out | std::ios::trunc);
+    for(auto& line : _dictionaryLines)
+        _dictionary << line << '\n';
+    _dictionary.flush();
+
+    _open.store(true, std::memory_order_release);
+    return true;
+}
+
+
+void
+BinaryLog::Close()
+{
+    std::lock_guard<std::mutex> l(_mutex);
+    if(!_ring)
+        return;
+
+    _open.store(false, std::memory_order_release);
+
+    ::msync(_header, _mappedSize, MS_SYNC);
+    ::munmap(_header, _mappedSize);
+    _header = nullptr;
+    _ring = nullptr;
+
+    _dictionary.close();
+}
+
+
+uint16_t
+BinaryLog::RegisterFormat(uint8_t level, const char* file, int line, const char* format)
+{
+    std::lock_guard<std::mutex> l(_mutex);
+
+    uint16_t id = ++_formatsCount;
+    std::ostringstream oss;
+    oss << "F " << id << ' ' << static_cast<int>(level) << ' ' << file << ':' << line << ' ' << format;
+    WriteDictionary(oss.str());
+
+    return id;
+}
+
+
+uint16_t
+BinaryLog::RegisterLogger(const std::string& name)
+{
+    std::lock_guard<std::mutex> l(_mutex);
+
+    uint16_t id = ++_loggersCount;
+    WriteDictionary("L " + std::to_string(id) + " " + name);
+
+    return id;
+}
+
+
+void
+BinaryLog::Append(uint16_t formatId, uint16_t loggerId, uint32_t instance, const uint8_t* args, size_t argsSize)
+{
+    auto ticks = NowNs(std::chrono::steady_clock::now());
+
+    RecordHeader record;
+    record.Size = static_cast<uint16_t>(Align(sizeof(RecordHeader) + argsSize));
+    record.FormatId = formatId;
+    record.LoggerId = loggerId;
+    record.Instance = instance;
+    record.Reserved = 0;
+
+    std::lock_guard<std::mutex> l(_mutex);
+    if(!_ring)
+        return;
+
+    record.ThreadId = LocalThreadId();
+    record.Ticks = ticks - _header->BaseSteadyNs;
+
+    auto tail = _header->Tail;
+
+        // record has to leave room for the padding marker, so Tail never reaches Capacity
+    if(_header->Capacity - tail <= record.Size)
+    {
+        while(_header->Head > tail)
+            DropOldest();
+
+        std::memset(_ring + tail, 0, sizeof(uint16_t));
+        tail = 0;
+
+            // Head == Tail means empty ring, records starting at 0 are overwritten now
+        if(_header->Head == 0)
+            DropOldest();
+    }
+
+        // drop records overwritten by this one, Head must stay ahead of the new Tail
+    while(_header->Head > tail && _header->Head - tail <= record.Size)
+        DropOldest();
+
+    std::memcpy(_ring + tail, &record, sizeof(RecordHeader));
+    std::memcpy(_ring + tail + sizeof(RecordHeader), args, argsSize);
+        // alignment bytes are zero, decoder takes them for the end of arguments
+    std::memset(_ring + tail + sizeof(RecordHeader) + argsSize, 0, record.Size - sizeof(RecordHeader) - argsSize);
+
+    _header->Tail = tail + record.Size;
+}
+
+
+void
+BinaryLog::FormatArgs(std::ostream& os, const char* format, const uint8_t* args, size_t size)
+{
+    size_t argPos = 0;
+
+    auto read = [&](void* value, size_t needed)
+    {
+        if(argPos + needed > size)
+            return false;
+
+        std::memcpy(value, args + argPos, needed);
+        argPos += needed;
+        return true;
+    };
+
+    while(auto placeholder = std::strstr(format, "{}"))
+    {
+        uint8_t type = 0;
+        if(!read(&type, sizeof(type)))
+            break;
+
+        bool decoded = false;
+        switch(type)
+        {
+        case ARG_INT:
+        {
+            int64_t value;
+            decoded = read(&value, sizeof(value));
+            if(decoded)
+                os.write(format, placeholder - format) << value;
+            break;
+        }
+        case ARG_UINT:
+        {
+            uint64_t value;
+            decoded = read(&value, sizeof(value));
+            if(decoded)
+                os.write(format, placeholder - format) << value;
+            break;
+        }
+        case ARG_DOUBLE:
+        {
+            double value;
+            decoded = read(&value, sizeof(value));
+            if(decoded)
+                os.write(format, placeholder - format) << value;
+            break;
+        }
+        case ARG_STRING:
+        {
+            uint16_t length;
+            if(!read(&length, sizeof(length)))
+                break;
+
+            os.write(format, placeholder - format);
+            if(argPos + length <= size)
+            {
+                os.write(reinterpret_cast<const char*>(args + argPos), length);
+                argPos += length;
+                decoded = true;
+                break;
+            }
+
+                // a cut string is written up to the cut, nothing can follow it
+            os.write(reinterpret_cast<const char*>(args + argPos), size - argPos);
+            format = placeholder + 2;
+            break;
+        }
+        default:
+            break;
+        }
+
+        if(!decoded)
+            break;
+        format = placeholder + 2;
+    }
+
+    os << format;
+}
+
+
+uint16_t
+BinaryLog::LocalThreadId()
+{
+    thread_local uint16_t id = 0;
+    if(id == 0)
+    {
+        id = ++_threadsCount;
+        WriteDictionary("T " + std::to_string(id) + " "
+                        + (Poco::Thread::current() ? Poco::Thread::current()->getName() : "__undefined__"));
+    }
+
+    return id;
+}
+
+
+void
+BinaryLog::WriteDictionary(const std::string& line)
+{
+    _dictionaryLines.push_back(line);
+    if(_dictionary.is_open())
+    {
+        _dictionary << line << '\n';
+        _dictionary.flush();
+    }
+}
+
+
+void
+BinaryLog::DropOldest()
+{
+    auto head = _header->Head;
+
+    uint16_t size;
+    std::memcpy(&size, _ring + head, sizeof(size));
+
+    _header->Head = (size == 0) ? 0 : head + size;
+}
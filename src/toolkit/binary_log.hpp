@@ -0,0 +1,243 @@
+//
+//  binary_log.hpp
+//  labyrinth_server
+//
+
+#ifndef binary_log_hpp
+#define binary_log_hpp
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+/*
+ * Binary log file layout.
+ *
+ * <name> is a memory-mapped ring: FileHeader followed by Capacity bytes of records.
+ * Every record is RecordHeader + arguments, size is 4-byte aligned. Record with Size == 0 is a padding
+ * marker, reader continues from the beginning of the ring. When the ring is full oldest records are dropped.
+ *
+ * <name>.dict is a text dictionary, written once per format/logger/thread:
+ *   F <id> <level> <file>:<line> <format>
+ *   L <id> <logger name>
+ *   T <id> <thread name>
+ */
+namespace BinaryLogFormat
+{
+    static const uint32_t MAGIC = 0x474c424c; // "LBLG"
+    static const uint32_t VERSION = 2;
+
+    struct FileHeader
+    {
+        uint32_t    Magic;
+        uint32_t    Version;
+        uint64_t    Capacity;
+        int64_t     BaseWallNs;     // system_clock at Open()
+        int64_t     BaseSteadyNs;   // steady_clock at Open(), record ticks are relative to it
+        uint64_t    Head;           // offset of the oldest record
+        uint64_t    Tail;           // offset of the next record
+    };
+
+    struct RecordHeader
+    {
+        uint16_t    Size;
+        uint16_t    FormatId;
+        uint16_t    LoggerId;
+        uint16_t    ThreadId;
+        uint32_t    Instance;       // appended to logger name, 0xFFFFFFFF if none
+        uint32_t    Reserved;
+        uint64_t    Ticks;          // steady_clock nanoseconds since BaseSteadyNs
+    };
+
+    enum ArgType : uint8_t
+    {
+        ARG_INT     = 1,    // int64_t
+        ARG_UINT    = 2,    // uint64_t
+        ARG_DOUBLE  = 3,    // double
+        ARG_STRING  = 4     // uint16_t length + bytes
+    };
+
+    static const size_t MAX_RECORD_SIZE = 512;
+}
+
+
+/*
+ * Encoder of typed call-site arguments into a record buffer.
+ * Types without a native encoding are stored as their operator<< text.
+ */
+class BinaryArgs
+{
+public:
+    BinaryArgs(uint8_t* data, size_t capacity)
+    : _data(data),
+      _capacity(capacity),
+      _size(0)
+    { }
+
+    size_t Size() const
+    { return _size; }
+
+    void Add()
+    { }
+
+    template<typename T, typename... Rest>
+    void Add(const T& value, const Rest&... rest)
+    {
+        Encode(value);
+        Add(rest...);
+    }
+
+private:
+    template<typename T>
+    typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+    Encode(const T& value)
+    { Put(BinaryLogFormat::ARG_INT, static_cast<int64_t>(value)); }
+
+    template<typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type
+    Encode(const T& value)
+    { Put(BinaryLogFormat::ARG_UINT, static_cast<uint64_t>(value)); }
+
+    template<typename T>
+    typename std::enable_if<std::is_floating_point<T>::value>::type
+    Encode(const T& value)
+    { Put(BinaryLogFormat::ARG_DOUBLE, static_cast<double>(value)); }
+
+    template<typename T>
+    typename std::enable_if<std::is_enum<T>::value>::type
+    Encode(const T& value)
+    { Put(BinaryLogFormat::ARG_INT, static_cast<int64_t>(value)); }
+
+    template<typename T>
+    typename std::enable_if<std::is_class<T>::value>::type
+    Encode(const T& value)
+    {
+        std::ostringstream oss;
+        oss << value;
+
+        auto str = oss.str();
+        EncodeString(str.data(), str.size());
+    }
+
+    void Encode(const std::string& value)
+    { EncodeString(value.data(), value.size()); }
+
+    void Encode(const char* value)
+    { EncodeString(value, std::strlen(value)); }
+
+    template<typename T>
+    void Put(uint8_t type, const T& value)
+    {
+        if(_size + 1 + sizeof(T) > _capacity)
+            return;
+
+        _data[_size++] = type;
+        std::memcpy(_data + _size, &value, sizeof(T));
+        _size += sizeof(T);
+    }
+
+    void EncodeString(const char* str, size_t length)
+    {
+        if(_size + 1 + sizeof(uint16_t) > _capacity)
+            return;
+
+            // truncate to what is left in the record
+        uint16_t len = static_cast<uint16_t>(std::min(length, _capacity - _size - 1 - sizeof(uint16_t)));
+        _data[_size++] = BinaryLogFormat::ARG_STRING;
+        std::memcpy(_data + _size, &len, sizeof(len));
+        _size += sizeof(len);
+        std::memcpy(_data + _size, str, len);
+        _size += len;
+    }
+
+private:
+    uint8_t*    _data;
+    size_t      _capacity;
+    size_t      _size;
+};
+
+
+/*
+ * Process-wide binary log sink.
+ * Call sites register their format string once (see BLOG_* macros in named_logger.hpp) and then
+ * write only ids, steady ticks and raw argument bytes. Text is restored offline by log_decoder.
+ */
+class BinaryLog
+{
+public:
+    static BinaryLog& Instance();
+
+    ~BinaryLog();
+
+    /*
+     * Maps ring file of given capacity, returns false on failure.
+     */
+    bool Open(const std::string& path, size_t capacity = 64 * 1024 * 1024);
+    void Close();
+
+    bool IsOpen() const
+    { return _open.load(std::memory_order_acquire); }
+
+    uint16_t RegisterFormat(uint8_t level, const char* file, int line, const char* format);
+    uint16_t RegisterLogger(const std::string& name);
+
+    void Append(uint16_t formatId, uint16_t loggerId, uint32_t instance, const uint8_t* args, size_t argsSize);
+
+    /*
+     * Replaces every {} in format with the next argument, used when binary log is closed.
+     */
+    static void FormatText(std::ostream& os, const char* format)
+    { os << format; }
+
+    template<typename T, typename... Rest>
+    static void FormatText(std::ostream& os, const char* format, const T& value, const Rest&... rest)
+    {
+        auto placeholder = std::strstr(format, "{}");
+        if(!placeholder)
+        {
+            os << format;
+            return;
+        }
+
+        os.write(format, placeholder - format);
+        os << value;
+        FormatText(os, placeholder + 2, rest...);
+    }
+
+    /*
+     * Same for arguments encoded by BinaryArgs. Every read is checked against size, decoding stops at
+     * the first argument that is cut or unknown (zero padding) and the rest of format is written as is.
+     */
+    static void FormatArgs(std::ostream& os, const char* format, const uint8_t* args, size_t size);
+
+private:
+    BinaryLog();
+
+    uint16_t LocalThreadId();
+    void WriteDictionary(const std::string& line);
+    void DropOldest();
+
+private:
+    std::mutex                      _mutex;
+    std::atomic<bool>               _open;
+
+    BinaryLogFormat::FileHeader *   _header;
+    uint8_t *                       _ring;
+    size_t                          _mappedSize;
+
+    std::ofstream                   _dictionary;
+    std::vector<std::string>        _dictionaryLines; // replayed on Open
+    uint16_t                        _formatsCount;
+    uint16_t                        _loggersCount;
+    uint16_t                        _threadsCount;
+};
+
+#endif /* binary_log_hpp */
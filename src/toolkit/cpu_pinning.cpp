@@ -0,0 +1,203 @@
+//
+//  cpu_pinning.cpp
+//  labyrinth_server
+//
+
+#include "cpu_pinning.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+namespace
+{
+    const int MAX_NODES = 64;
+
+    std::string ReadLine(const std::string& path)
+    {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        return line;
+    }
+}
+
+
+CpuPinning::Configuration CpuPinning::_config = { false, 1 };
+
+
+CpuPinning&
+CpuPinning::Instance()
+{
+    static CpuPinning pinning;
+    return pinning;
+}
+
+
+CpuPinning::CpuPinning()
+: _logger("CpuPinning", NamedLogger::Mode::STDIO),
+  _enabled(false)
+{
+    if(!_config.Enabled)
+        return;
+
+#if defined(__linux__)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if(::sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+    {
+        _logger.Warning() << "Process affinity mask is unavailable, pinning is off";
+        return;
+    }
+
+    auto usable = [&](std::vector<int> cpus)
+    {
+        cpus.erase(std::remove_if(cpus.begin(),
+                                  cpus.end(),
+                                  [&](int cpu)
+                                  {
+                                      return cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &allowed);
+                                  }),
+                   cpus.end());
+        return cpus;
+    };
+
+    for(int node = 0; node < MAX_NODES; ++node)
+    {
+        auto path = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+        auto cpus = usable(ParseCpuList(ReadLine(path)));
+        if(!cpus.empty())
+            _nodes.push_back(cpus);
+    }
+
+        // kernel without NUMA support, all cpus are one node
+    if(_nodes.empty())
+    {
+        auto cpus = ParseCpuList(ReadLine("/sys/devices/system/cpu/online"));
+        if(cpus.empty())
+            for(unsigned cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu)
+                cpus.push_back(cpu);
+
+        cpus = usable(cpus);
+        if(!cpus.empty())
+            _nodes.push_back(cpus);
+    }
+#else
+    _logger.Warning() << "Pinning is supported on Linux only, it is off";
+    return;
+#endif
+
+    size_t total = 0;
+    for(auto& node : _nodes)
+        total += node.size();
+    if(total <= _config.ServiceCores)
+    {
+        _logger.Warning() << "Only " << total << " usable cpus, no cores are left for game workers, pinning is off";
+        return;
+    }
+
+    auto serviceCount = std::min(_config.ServiceCores, _nodes.front().size());
+    _serviceCpus.assign(_nodes.front().begin(), _nodes.front().begin() + serviceCount);
+
+        // node 0 cpu 1, node 1 cpu 0, node 0 cpu 2... neighbouring workers land on different nodes
+    for(size_t idx = 0; _gameCpus.size() + _serviceCpus.size() < total; ++idx)
+    {
+        for(size_t node = 0; node < _nodes.size(); ++node)
+        {
+            auto offset = idx + (node == 0 ? serviceCount : 0);
+            if(offset < _nodes[node].size())
+                _gameCpus.push_back(_nodes[node][offset]);
+        }
+    }
+
+    _enabled = true;
+
+    LOG_INFO(_logger) << "Threads are pinned, " << _nodes.size() << " NUMA node(s)";
+    for(size_t node = 0; node < _nodes.size(); ++node)
+        LOG_INFO(_logger) << "Node " << node << ": cpus " << FormatCpuList(_nodes[node]);
+    LOG_INFO(_logger) << "Service threads: cpus " << FormatCpuList(_serviceCpus);
+    LOG_INFO(_logger) << "Game workers, in order: cpus " << FormatCpuList(_gameCpus);
+}
+
+
+bool
+CpuPinning::PinService()
+{
+        // no service cores - service threads float over every core
+    if(!_enabled || _serviceCpus.empty())
+        return false;
+
+    return Pin(_serviceCpus);
+}
+
+
+bool
+CpuPinning::PinGameWorker(size_t worker)
+{
+    if(!_enabled)
+        return false;
+
+    return Pin({ _gameCpus[GameCore(worker)] });
+}
+
+
+std::vector<int>
+CpuPinning::ParseCpuList(const std::string& list)
+{
+        // "0-3,8,10-11"
+    std::vector<int> cpus;
+    std::istringstream iss(list);
+    std::string range;
+    while(std::getline(iss, range, ','))
+    {
+        if(range.empty())
+            continue;
+
+        auto dash = range.find('-');
+        int first = std::atoi(range.c_str());
+        int last = (dash == std::string::npos) ? first : std::atoi(range.c_str() + dash + 1);
+        for(int cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
+    }
+
+    return cpus;
+}
+
+
+std::string
+CpuPinning::FormatCpuList(const std::vector<int>& cpus)
+{
+    std::ostringstream oss;
+    for(size_t idx = 0; idx < cpus.size(); ++idx)
+        oss << (idx ? "," : "") << cpus[idx];
+
+    return oss.str();
+}
+
+
+bool
+CpuPinning::Pin(const std::vector<int>& cpus)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for(auto cpu : cpus)
+        CPU_SET(cpu, &set);
+
+    auto error = ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+    if(error == 0)
+        return true;
+
+    _logger.Warning() << "Failed to pin thread to cpus " << FormatCpuList(cpus) << ", error " << error;
+#endif
+
+    return false;
+}
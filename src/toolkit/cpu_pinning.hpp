@@ -0,0 +1,79 @@
+//
+//  cpu_pinning.hpp
+//  labyrinth_server
+//
+
+#ifndef cpu_pinning_hpp
+#define cpu_pinning_hpp
+
+#include "named_logger.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+/*
+ * Optional pinning of threads to cores, meant for dedicated hosts. Linux only, elsewhere it stays off.
+ * Cores are read per NUMA node from /sys and limited to the process affinity mask. The first ServiceCores
+ * cores of the first node are left to service threads (receive loops, log, database, match history),
+ * game workers get one core each from the rest, interleaved over nodes. A game server keeps its worker
+ * index for life, so it never migrates and memory it touches first (world, arena) stays on its node.
+ * New threads inherit the mask of their creator: the main thread is pinned to service cores before
+ * anything else starts, so every service thread keeps off game cores without pinning itself.
+ */
+class CpuPinning
+{
+public:
+    struct Configuration
+    {
+        bool    Enabled;
+        size_t  ServiceCores;
+    };
+
+public:
+    /*
+     * Has to be called before the first Instance() call.
+     */
+    static void Configure(const Configuration& config)
+    { _config = config; }
+
+        // layout is detected and logged on the first call
+    static CpuPinning& Instance();
+
+    bool Enabled() const
+    { return _enabled; }
+
+    /*
+     * Pin the calling thread, false if pinning is off or failed.
+     */
+    bool PinService();
+    bool PinGameWorker(size_t worker);
+
+    /*
+     * Core of a game worker, workers with the same one compete for a core.
+     * With pinning off every worker floats and counts as a core of its own.
+     */
+    size_t GameCore(size_t worker) const
+    { return _enabled ? worker % _gameCpus.size() : worker; }
+
+private:
+    CpuPinning();
+
+    static std::vector<int> ParseCpuList(const std::string& list);
+    static std::string FormatCpuList(const std::vector<int>& cpus);
+
+    bool Pin(const std::vector<int>& cpus);
+
+private:
+    static Configuration            _config;
+
+    NamedLogger                     _logger;
+    bool                            _enabled;
+
+    std::vector<std::vector<int>>   _nodes;         // usable cpus of every NUMA node
+    std::vector<int>                _serviceCpus;
+    std::vector<int>                _gameCpus;      // in the order workers take them
+};
+
+#endif /* cpu_pinning_hpp */
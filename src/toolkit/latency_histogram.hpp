@@ -0,0 +1,103 @@
+//
+//  latency_histogram.hpp
+//  labyrinth_server
+//
+
+#ifndef latency_histogram_hpp
+#define latency_histogram_hpp
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+
+/*
+ * Lock-free histogram of durations, microsecond resolution.
+ * Every power of two is split into 4 linear buckets (values are within 25% of their bucket bound),
+ * up to ~2^40us. Recording is a single relaxed increment, so it can be fed from game loops
+ * and database workers and read by the stats endpoint at any time.
+ */
+class LatencyHistogram
+{
+public:
+    LatencyHistogram()
+    { Reset(); }
+
+    void Record(std::chrono::microseconds duration)
+    {
+        auto value = duration.count() > 0 ? static_cast<uint64_t>(duration.count()) : 0;
+        _counts[BucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t Count() const
+    {
+        uint64_t total = 0;
+        for(auto& count : _counts)
+            total += count.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    /*
+     * Upper bound of the bucket holding given fraction (0.5, 0.99...) of recorded values, 0 if empty.
+     */
+    std::chrono::microseconds Percentile(double fraction) const
+    {
+        std::array<uint64_t, BUCKETS> counts;
+        uint64_t total = 0;
+        for(size_t idx = 0; idx < BUCKETS; ++idx)
+            total += counts[idx] = _counts[idx].load(std::memory_order_relaxed);
+
+        if(total == 0)
+            return std::chrono::microseconds(0);
+
+        auto target = static_cast<uint64_t>(std::ceil(fraction * total));
+        uint64_t seen = 0;
+        for(size_t idx = 0; idx < BUCKETS; ++idx)
+        {
+            seen += counts[idx];
+            if(seen >= target && counts[idx])
+                return std::chrono::microseconds(UpperBound(idx));
+        }
+
+        return std::chrono::microseconds(UpperBound(BUCKETS - 1));
+    }
+
+    void Reset()
+    {
+        for(auto& count : _counts)
+            count.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static const size_t SUB_BUCKETS = 4;
+    static const size_t MAGNITUDES = 40;
+    static const size_t BUCKETS = SUB_BUCKETS * MAGNITUDES;
+
+        // values below 4 have buckets of their own, then 4 buckets per power of two
+    static size_t BucketOf(uint64_t value)
+    {
+        if(value < SUB_BUCKETS)
+            return static_cast<size_t>(value);
+
+        size_t magnitude = 63 - __builtin_clzll(value);
+        size_t bucket = (magnitude - 1) * SUB_BUCKETS + ((value >> (magnitude - 2)) & (SUB_BUCKETS - 1));
+        return bucket < BUCKETS ? bucket : BUCKETS - 1;
+    }
+
+    static uint64_t UpperBound(size_t bucket)
+    {
+        if(bucket < SUB_BUCKETS)
+            return bucket;
+
+        size_t magnitude = bucket / SUB_BUCKETS + 1;
+        uint64_t lower = (SUB_BUCKETS + bucket % SUB_BUCKETS) << (magnitude - 2);
+        return lower + (uint64_t(1) << (magnitude - 2)) - 1;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS> _counts;
+};
+
+#endif /* latency_histogram_hpp */
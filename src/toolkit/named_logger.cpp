@@ -8,6 +8,7 @@
 
 #include "named_logger.hpp"
 
+#include "async_log_backend.hpp"
 #include "date.h"
 
 #include <Poco/Thread.h>
@@ -16,37 +17,26 @@
 #include <iostream>
 
 
-NamedLogger::LoggerStream::LoggerStream(const NamedLogger& parent,
-                                        Level level)
-: _logger(parent)
-{
-    switch(level)
-    {
-        case Level::DBG:
-            _prefix += Color::RESET;
-            _prefix += "[ Debug ] ";
-            break;
-        case Level::INFO:
-            _prefix += Color::WHITE;
-            _prefix += "[ Info ] ";
-            break;
-        case Level::WARNING:
-            _prefix += Color::YELLOW;
-            _prefix += "[ Warning ] ";
-            break;
-        case Level::ERROR:
-            _prefix += Color::RED;
-            _prefix += "[ Error ] ";
-            break;
-    }
+std::atomic<int> NamedLogger::_runtimeLevel(NAMED_LOGGER_MIN_LEVEL);
+std::mutex NamedLogger::_channelsMutex;
+std::map<std::string, std::unique_ptr<NamedLogger>> NamedLogger::_channels;
 
-    _stream << _prefix;
-}
+
+NamedLogger::LoggerStream::LoggerStream(const NamedLogger& parent,
+                                        Level level,
+                                        uint32_t instance)
+: _logger(parent),
+  _level(level),
+  _instance(instance),
+  _enabled(NamedLogger::IsEnabled(level))
+{ }
 
 
 NamedLogger::NamedLogger(const std::string& name, Mode mode)
 : _name(name),
-  _mode(mode)
+  _mode(mode),
+  _binaryId(0),
+  _asyncId(0)
 {
     if(_mode & Mode::FILE)
     {
@@ -63,18 +53,142 @@ NamedLogger::NamedLogger(const std::string& name, Mode mode)
     }
 }
 
+NamedLogger&
+NamedLogger::Channel(const std::string& name)
+{
+    std::lock_guard<std::mutex> l(_channelsMutex);
+
+    auto& channel = _channels[name];
+    if(!channel)
+        channel = std::make_unique<NamedLogger>(name, Mode::STDIO);
+
+    return *channel;
+}
+
+
 void
-NamedLogger::Write(const std::string& str) const
+NamedLogger::EnableAsync(size_t ringCapacity)
+{ AsyncLogBackend::Instance().Start(ringCapacity); }
+
+
+void
+NamedLogger::DisableAsync()
+{ AsyncLogBackend::Instance().Stop(); }
+
+
+const std::string&
+NamedLogger::LevelPrefix(Level level)
+{
+    static const std::string prefixes[] =
+    {
+        Color::RESET + "[ Debug ] ",
+        Color::WHITE + "[ Info ] ",
+        Color::YELLOW + "[ Warning ] ",
+        Color::RED + "[ Error ] "
+    };
+
+    return prefixes[static_cast<int>(level)];
+}
+
+
+std::string
+NamedLogger::ThreadName()
+{ return Poco::Thread::current() ? Poco::Thread::current()->getName() : "__undefined__"; }
+
+
+void
+NamedLogger::FormatHeader(std::ostream& os,
+                          std::chrono::system_clock::time_point time,
+                          Level level,
+                          const std::string& thread,
+                          const std::string& name,
+                          uint32_t instance)
 {
     using namespace date;
+
+    os << Color::CYAN << "[ " << time << " ]";
+    os << Color::GREEN << "{ " << thread << " }";
+    os << Color::MAGENTA << "[ " << name;
+    if(instance != NO_INSTANCE)
+        os << instance;
+    os << " ]";
+    os << LevelPrefix(level);
+}
+
+
+void
+NamedLogger::Format(std::ostream& os,
+                    std::chrono::system_clock::time_point time,
+                    Level level,
+                    const std::string& thread,
+                    const std::string& name,
+                    uint32_t instance,
+                    const std::string& str)
+{
+    FormatHeader(os, time, level, thread, name, instance);
+    os << str << Color::RESET << std::endl;
+}
+
+
+void
+NamedLogger::Write(Level level, const std::string& str, uint32_t instance) const
+{
+    auto time = std::chrono::system_clock::now();
+    bool stdio = (_mode & Mode::STDIO) && !PushAsync(time, level, instance, nullptr, str.data(), str.size());
+
+    WriteSync(time, level, instance, str, stdio);
+}
+
+
+void
+NamedLogger::WriteArgs(Level level, uint32_t instance, const char* format, const uint8_t* args, size_t size) const
+{
+    if(!IsEnabled(level))
+        return;
+
+    auto time = std::chrono::system_clock::now();
+    bool stdio = (_mode & Mode::STDIO) && !PushAsync(time, level, instance, format, args, size);
+    if(!stdio && !(_mode & Mode::FILE))
+        return;
+
     std::ostringstream oss;
+    BinaryLog::FormatArgs(oss, format, args, size);
+    WriteSync(time, level, instance, oss.str(), stdio);
+}
+
+
+bool
+NamedLogger::PushAsync(std::chrono::system_clock::time_point time,
+                       Level level,
+                       uint32_t instance,
+                       const char* format,
+                       const void* data,
+                       size_t size) const
+{
+    auto& backend = AsyncLogBackend::Instance();
+    if(!backend.IsRunning())
+        return false;
+
+        // dropped records are counted by backend
+    backend.Push(time, static_cast<uint8_t>(level), AsyncId(), instance, format, data, size);
+    return true;
+}
 
-    oss << Color::CYAN << "[ " << std::chrono::system_clock::now() << " ]";
-    oss << Color::GREEN << "{ " << (Poco::Thread::current() ? Poco::Thread::current()->getName() : "__undefined__") << " }";
-    oss << Color::MAGENTA << "[ " << _name << " ]";
-    oss << str << std::endl;
 
-    if(_mode & Mode::STDIO)
+void
+NamedLogger::WriteSync(std::chrono::system_clock::time_point time,
+                       Level level,
+                       uint32_t instance,
+                       const std::string& str,
+                       bool stdio) const
+{
+    if(!stdio && !(_mode & Mode::FILE))
+        return;
+
+    std::ostringstream oss;
+    Format(oss, time, level, ThreadName(), _name, instance, str);
+
+    if(stdio)
     {
         std::cout << oss.str();
     }
@@ -85,3 +199,35 @@ NamedLogger::Write(const std::string& str) const
         _fileStream.flush();
     }
 }
+
+
+uint16_t
+NamedLogger::BinaryId() const
+{
+    auto id = _binaryId.load(std::memory_order_relaxed);
+    if(id != 0)
+        return id;
+
+        // concurrent first writes may register the name twice, only one id is kept
+    auto registered = BinaryLog::Instance().RegisterLogger(_name);
+    if(_binaryId.compare_exchange_strong(id, registered))
+        return registered;
+
+    return id;
+}
+
+
+uint16_t
+NamedLogger::AsyncId() const
+{
+    auto id = _asyncId.load(std::memory_order_relaxed);
+    if(id != 0)
+        return id;
+
+        // same as BinaryId, a name registered twice costs one string
+    auto registered = AsyncLogBackend::Instance().RegisterLogger(_name);
+    if(_asyncId.compare_exchange_strong(id, registered))
+        return registered;
+
+    return id;
+}
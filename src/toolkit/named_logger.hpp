@@ -9,9 +9,15 @@
 #ifndef named_logger_hpp
 #define named_logger_hpp
 
+#include "binary_log.hpp"
+
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <sstream>
 
+#include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 
@@ -28,51 +34,100 @@ namespace Color
     static const std::string RESET      = "\033[0m";
 }
 
+    // Compile-time floor: 0 - debug, 1 - info, 2 - warning, 3 - error.
+    // Statements below it are removed by the optimizer when written with LOG_* macros.
+#ifndef NAMED_LOGGER_MIN_LEVEL
+#define NAMED_LOGGER_MIN_LEVEL 0
+#endif
+
+    // Arguments of a disabled statement are not evaluated
+    // A single expression, so it can't take over an 'else' of the caller. Voidify binds looser
+    // than <<, the whole stream expression is skipped when the level is off.
+#define NAMED_LOGGER_STATEMENT(logger, level, method) \
+    !NamedLogger::IsEnabled(NamedLogger::Level::level) ? (void)0 : NamedLogger::Voidify() & (logger).method()
+
+#define LOG_DEBUG(logger)   NAMED_LOGGER_STATEMENT(logger, DBG, Debug)
+#define LOG_INFO(logger)    NAMED_LOGGER_STATEMENT(logger, INFO, Info)
+#define LOG_WARNING(logger) NAMED_LOGGER_STATEMENT(logger, WARNING, Warning)
+#define LOG_ERROR(logger)   NAMED_LOGGER_STATEMENT(logger, ERROR, Error)
+
+    // Format string with {} placeholders is registered once per call site, binary log stores
+    // only its id and raw arguments. Falls back to text output when binary log is closed.
+#define NAMED_LOGGER_BINARY(logger, level, format, ...) \
+    do \
+    { \
+        if(NamedLogger::IsEnabled(NamedLogger::Level::level)) \
+        { \
+            static const uint16_t namedLoggerFormatId = BinaryLog::Instance().RegisterFormat( \
+                static_cast<uint8_t>(NamedLogger::Level::level), __FILE__, __LINE__, format); \
+            (logger).Log(NamedLogger::Level::level, namedLoggerFormatId, format, ##__VA_ARGS__); \
+        } \
+    } while(false)
+
+#define BLOG_DEBUG(logger, format, ...)     NAMED_LOGGER_BINARY(logger, DBG, format, ##__VA_ARGS__)
+#define BLOG_INFO(logger, format, ...)      NAMED_LOGGER_BINARY(logger, INFO, format, ##__VA_ARGS__)
+#define BLOG_WARNING(logger, format, ...)   NAMED_LOGGER_BINARY(logger, WARNING, format, ##__VA_ARGS__)
+#define BLOG_ERROR(logger, format, ...)     NAMED_LOGGER_BINARY(logger, ERROR, format, ##__VA_ARGS__)
+
+class LogHandle;
+
 class NamedLogger
 {
+public:
+    static const uint32_t NO_INSTANCE = 0xFFFFFFFF;
+
+    enum class Level
+    {
+        DBG,
+        INFO,
+        WARNING,
+        ERROR
+    };
+
 private:
     class LoggerStream
     {
         friend NamedLogger;
-
-    public:
-        enum class Level
-        {
-            DBG,
-            INFO,
-            WARNING,
-            ERROR
-        };
+        friend LogHandle;
 
     private:
         LoggerStream(const NamedLogger& parent,
-                     Level level);
+                     Level level,
+                     uint32_t instance = NO_INSTANCE);
         LoggerStream(const LoggerStream& other)
         : _logger(other._logger),
-          _prefix(other._prefix)
+          _level(other._level),
+          _instance(other._instance),
+          _enabled(other._enabled)
         { }
 
     public:
         template<typename T>
         LoggerStream& operator<<(T value)
         {
-            _stream << value;
+            if(_enabled)
+                _stream << value;
 
             return *this;
         }
 
         ~LoggerStream()
         {
-            _stream << Color::RESET;
-            _logger.Write(_stream.str());
+            if(!_enabled)
+                return;
+
+            _logger.Write(_level, _stream.str(), _instance);
         }
 
     private:
         const NamedLogger&  _logger;
-        std::string         _prefix;
+        const Level         _level;
+        const uint32_t      _instance;
+        const bool          _enabled;
         std::ostringstream  _stream;
     };
     friend LoggerStream;
+    friend LogHandle;
 
 public:
     enum Mode
@@ -86,19 +141,109 @@ public:
     NamedLogger(const std::string& name, Mode mode = STDIO);
 
     LoggerStream Debug()
-    { return LoggerStream(*this, LoggerStream::Level::DBG); }
+    { return LoggerStream(*this, Level::DBG); }
 
     LoggerStream Info()
-    { return LoggerStream(*this, LoggerStream::Level::INFO); }
+    { return LoggerStream(*this, Level::INFO); }
 
     LoggerStream Warning()
-    { return LoggerStream(*this, LoggerStream::Level::WARNING); }
+    { return LoggerStream(*this, Level::WARNING); }
 
     LoggerStream Error()
-    { return LoggerStream(*this, LoggerStream::Level::ERROR); }
+    { return LoggerStream(*this, Level::ERROR); }
+
+    template<typename... Args>
+    void Log(Level level, uint16_t formatId, const char* format, const Args&... args) const
+    { LogInstance(level, formatId, NO_INSTANCE, format, args...); }
+
+    /*
+     * Registry-owned logger, lives until the end of the program.
+     * Objects keep a LogHandle to it instead of owning a NamedLogger.
+     */
+    static NamedLogger& Channel(const std::string& name);
+
+    static bool IsEnabled(Level level)
+    {
+        return static_cast<int>(level) >= NAMED_LOGGER_MIN_LEVEL
+            && static_cast<int>(level) >= _runtimeLevel.load(std::memory_order_relaxed);
+    }
+
+        // see NAMED_LOGGER_STATEMENT
+    struct Voidify
+    {
+        void operator&(const LoggerStream&) const
+        { }
+    };
+
+    /*
+     * Runtime threshold for all loggers, can't go below NAMED_LOGGER_MIN_LEVEL.
+     */
+    static void SetLevel(Level level)
+    { _runtimeLevel.store(static_cast<int>(level), std::memory_order_relaxed); }
+
+    /*
+     * Moves stdout writes of every logger to AsyncLogBackend thread, lines are formatted there.
+     * File output stays synchronous.
+     */
+    static void EnableAsync(size_t ringCapacity = 512);
+    static void DisableAsync();
+
+    static const std::string& LevelPrefix(Level level);
+
+        // current name of the calling thread, pool threads are renamed per task
+    static std::string ThreadName();
+
+    /*
+     * Line is "[ time ]{ thread }[ name<instance> ]<level prefix><text><reset>".
+     */
+    static void FormatHeader(std::ostream& os,
+                             std::chrono::system_clock::time_point time,
+                             Level level,
+                             const std::string& thread,
+                             const std::string& name,
+                             uint32_t instance);
+
+    static void Format(std::ostream& os,
+                       std::chrono::system_clock::time_point time,
+                       Level level,
+                       const std::string& thread,
+                       const std::string& name,
+                       uint32_t instance,
+                       const std::string& str);
 
 private:
-    void Write(const std::string& str) const;
+        // format has to be a string literal, async backend formats the line later
+    template<typename... Args>
+    void LogInstance(Level level, uint16_t formatId, uint32_t instance, const char* format, const Args&... args) const
+    {
+        uint8_t buffer[BinaryLogFormat::MAX_RECORD_SIZE - sizeof(BinaryLogFormat::RecordHeader)];
+        BinaryArgs encoded(buffer, sizeof(buffer));
+        encoded.Add(args...);
+
+        if(BinaryLog::Instance().IsOpen())
+        {
+            BinaryLog::Instance().Append(formatId, BinaryId(), instance, buffer, encoded.Size());
+            return;
+        }
+
+        WriteArgs(level, instance, format, buffer, encoded.Size());
+    }
+
+    void Write(Level level, const std::string& str, uint32_t instance) const;
+    void WriteArgs(Level level, uint32_t instance, const char* format, const uint8_t* args, size_t size) const;
+    bool PushAsync(std::chrono::system_clock::time_point time,
+                   Level level,
+                   uint32_t instance,
+                   const char* format,
+                   const void* data,
+                   size_t size) const;
+    void WriteSync(std::chrono::system_clock::time_point time,
+                   Level level,
+                   uint32_t instance,
+                   const std::string& str,
+                   bool stdio) const;
+    uint16_t BinaryId() const;
+    uint16_t AsyncId() const;
 
 private:
     const Mode              _mode;
@@ -106,6 +251,48 @@ private:
 
     mutable std::mutex      _fileMutex;
     mutable std::ofstream   _fileStream;
+
+    mutable std::atomic<uint16_t> _binaryId; // 0 until first binary record
+    mutable std::atomic<uint16_t> _asyncId;  // 0 until first async record
+
+    static std::atomic<int> _runtimeLevel;
+
+    static std::mutex                                           _channelsMutex;
+    static std::map<std::string, std::unique_ptr<NamedLogger>>  _channels;
+};
+
+
+/*
+ * Pointer-sized reference to a NamedLogger channel with the same interface.
+ * Instance (e.g. unit uid) is appended to the channel name when a line is formatted: "Unit" + 42 -> "Unit42".
+ */
+class LogHandle
+{
+public:
+    LogHandle(NamedLogger& channel, uint32_t instance = NamedLogger::NO_INSTANCE)
+    : _channel(&channel),
+      _instance(instance)
+    { }
+
+    NamedLogger::LoggerStream Debug() const
+    { return NamedLogger::LoggerStream(*_channel, NamedLogger::Level::DBG, _instance); }
+
+    NamedLogger::LoggerStream Info() const
+    { return NamedLogger::LoggerStream(*_channel, NamedLogger::Level::INFO, _instance); }
+
+    NamedLogger::LoggerStream Warning() const
+    { return NamedLogger::LoggerStream(*_channel, NamedLogger::Level::WARNING, _instance); }
+
+    NamedLogger::LoggerStream Error() const
+    { return NamedLogger::LoggerStream(*_channel, NamedLogger::Level::ERROR, _instance); }
+
+    template<typename... Args>
+    void Log(NamedLogger::Level level, uint16_t formatId, const char* format, const Args&... args) const
+    { _channel->LogInstance(level, formatId, _instance, format, args...); }
+
+private:
+    NamedLogger *   _channel;
+    uint32_t        _instance;
 };
 
 #endif /* named_logger_hpp */
@@ -0,0 +1,97 @@
+//
+//  rate_limited_log.cpp
+//  labyrinth_server
+//
+
+#include "rate_limited_log.hpp"
+
+#include <algorithm>
+
+
+RateLimitedLog::RateLimitedLog(LogHandle logger,
+                               std::vector<std::string> reasons,
+                               std::chrono::milliseconds interval,
+                               size_t maxSenders)
+: _logger(logger),
+  _reasons(std::move(reasons)),
+  _interval(interval),
+  _maxSenders(maxSenders),
+  _intervalStart(std::chrono::steady_clock::now()),
+  _totalCounts(_reasons.size(), 0),
+  _othersCounts(_reasons.size(), 0)
+{
+    _senders.reserve(_maxSenders);
+}
+
+
+RateLimitedLog::~RateLimitedLog()
+{ Flush(true); }
+
+
+void
+RateLimitedLog::Report(size_t reason, const Poco::Net::SocketAddress& sender)
+{
+    ++_totalCounts[reason];
+
+    auto host = sender.host();
+    auto stats = std::find_if(_senders.begin(),
+                              _senders.end(),
+                              [&host](const SenderStats& s)
+                              {
+                                  return s.Host == host;
+                              });
+
+    if(stats != _senders.end())
+        ++stats->Counts[reason];
+    else if(_senders.size() < _maxSenders)
+    {
+        _senders.push_back({ host, std::vector<uint32_t>(_reasons.size(), 0) });
+        ++_senders.back().Counts[reason];
+    }
+    else
+        ++_othersCounts[reason];
+
+    Flush();
+}
+
+
+void
+RateLimitedLog::Flush(bool force)
+{
+    auto now = std::chrono::steady_clock::now();
+    if(!force && now - _intervalStart < _interval)
+        return;
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - _intervalStart);
+    _intervalStart = now;
+
+    for(size_t reason = 0; reason < _reasons.size(); ++reason)
+    {
+        if(_totalCounts[reason] == 0)
+            continue;
+
+            // heaviest senders first
+        std::sort(_senders.begin(),
+                  _senders.end(),
+                  [reason](const SenderStats& a, const SenderStats& b)
+                  {
+                      return a.Counts[reason] > b.Counts[reason];
+                  });
+
+        std::ostringstream senders;
+        for(auto& stats : _senders)
+        {
+            if(stats.Counts[reason] != 0)
+                senders << " " << stats.Host.toString() << " x" << stats.Counts[reason];
+        }
+        if(_othersCounts[reason] != 0)
+            senders << " others x" << _othersCounts[reason];
+
+        _logger.Warning() << _reasons[reason] << ": " << _totalCounts[reason]
+                          << " in last " << elapsed.count() << "ms, senders:" << senders.str();
+    }
+
+    _senders.clear();
+    std::fill(_totalCounts.begin(), _totalCounts.end(), 0);
+    std::fill(_othersCounts.begin(), _othersCounts.end(), 0);
+}
@@ -0,0 +1,59 @@
+//
+//  rate_limited_log.hpp
+//  labyrinth_server
+//
+
+#ifndef rate_limited_log_hpp
+#define rate_limited_log_hpp
+
+#include "named_logger.hpp"
+
+#include <Poco/Net/SocketAddress.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+
+/*
+ * Warning site for events that come in floods (oversized datagrams, garbage, unknown senders).
+ * Report() only bumps a counter per reason and sender host, once per interval a single summary
+ * line per reason is written. Not thread-safe, every receive loop owns its own instance.
+ */
+class RateLimitedLog
+{
+public:
+    RateLimitedLog(LogHandle logger,
+                   std::vector<std::string> reasons,
+                   std::chrono::milliseconds interval = std::chrono::milliseconds(5000),
+                   size_t maxSenders = 16);
+    ~RateLimitedLog();
+
+    void Report(size_t reason, const Poco::Net::SocketAddress& sender);
+
+    /*
+     * Writes collected counts if interval has passed (or always, if forced).
+     * Call it from the loop as well, so the last burst is not left unreported.
+     */
+    void Flush(bool force = false);
+
+private:
+    struct SenderStats
+    {
+        Poco::Net::IPAddress    Host;
+        std::vector<uint32_t>   Counts;
+    };
+
+private:
+    LogHandle                               _logger;
+    std::vector<std::string>                _reasons;
+    std::chrono::milliseconds               _interval;
+    size_t                                  _maxSenders;
+
+    std::chrono::steady_clock::time_point   _intervalStart;
+    std::vector<SenderStats>                _senders;
+    std::vector<uint32_t>                   _totalCounts;
+    std::vector<uint32_t>                   _othersCounts; // senders that didn't fit in _maxSenders
+};
+
+#endif /* rate_limited_log_hpp */
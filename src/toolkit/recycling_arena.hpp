@@ -0,0 +1,102 @@
+//
+//  recycling_arena.hpp
+//  labyrinth_server
+//
+
+#ifndef recycling_arena_hpp
+#define recycling_arena_hpp
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+
+/*
+ * Free lists of released blocks, one per block size.
+ * Nothing is given back to the heap until the arena dies, so a world that creates and destroys
+ * the same kinds of objects every match stops allocating after the first one.
+ * Not thread-safe, it belongs to a single game server thread.
+ */
+class RecyclingArena
+{
+public:
+    RecyclingArena() = default;
+    RecyclingArena(const RecyclingArena&) = delete;
+    RecyclingArena& operator=(const RecyclingArena&) = delete;
+
+    ~RecyclingArena()
+    {
+        for(auto& list : _free)
+            for(auto block : list.second)
+                ::operator delete(block);
+    }
+
+    void * Allocate(size_t size)
+    {
+        auto& list = _free[size];
+        if(list.empty())
+        {
+            ++_allocated;
+            return ::operator new(size);
+        }
+
+        auto block = list.back();
+        list.pop_back();
+        return block;
+    }
+
+    void Deallocate(void * block, size_t size)
+    { _free[size].push_back(block); }
+
+        // blocks ever taken from the heap
+    size_t Allocated() const
+    { return _allocated; }
+
+private:
+    std::unordered_map<size_t, std::vector<void*>>  _free;
+    size_t                                          _allocated = 0;
+};
+
+
+/*
+ * Standard allocator over a shared RecyclingArena, arena lives as long as anything allocated from it.
+ */
+template<typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    ArenaAllocator(std::shared_ptr<RecyclingArena> arena)
+    : _arena(std::move(arena))
+    { }
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other)
+    : _arena(other._arena)
+    { }
+
+    T * allocate(size_t n)
+    { return static_cast<T*>(_arena->Allocate(n * sizeof(T))); }
+
+    void deallocate(T * block, size_t n)
+    { _arena->Deallocate(block, n * sizeof(T)); }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const
+    { return _arena == other._arena; }
+
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const
+    { return _arena != other._arena; }
+
+private:
+    std::shared_ptr<RecyclingArena> _arena;
+
+    template<typename U>
+    friend class ArenaAllocator;
+};
+
+#endif /* recycling_arena_hpp */
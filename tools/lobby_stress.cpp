@@ -0,0 +1,161 @@
+//
+//  lobby_stress.cpp
+//  labyrinth_server
+//
+
+/*
+ * Stress check of LobbyRegistry (see lobby_registry.hpp). Every round starts with every slot forming
+ * and some seats free, then taker threads call TakeSeat while one publisher calls Publish and one
+ * server thread returns seats, closes and releases slots. Each slot keeps one generation per round,
+ * so after the round joins it is checked that no slot handed out more seats than were returned,
+ * and that every seat of a still forming lobby was either taken or can still be taken.
+ * Usage: lobby_stress [slots] [takers] [rounds]
+ */
+
+#include "lobby_registry.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    const size_t SERVER_OPERATIONS = 200;
+    const uint16_t MAX_RETURNED = 3;
+
+    struct SlotCounters
+    {
+        std::atomic<uint64_t>   Returned;
+        std::atomic<uint64_t>   Taken;
+    };
+}
+
+
+int main(int argc, const char * argv[])
+{
+    size_t slots = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+    size_t takers = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4;
+    size_t rounds = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 500;
+    slots = std::max<size_t>(slots, 1);
+    takers = std::max<size_t>(takers, 1);
+
+    LobbyRegistry registry(slots);
+    std::unique_ptr<SlotCounters[]> counters(new SlotCounters[slots]);
+    std::mt19937 random(42);
+
+    uint64_t totalTaken = 0;
+    uint64_t doubleHanded = 0;
+    uint64_t lost = 0;
+
+    for(size_t round = 0; round < rounds; ++round)
+    {
+            // every slot is a forming lobby again, with a few seats to take
+        while(registry.Reserve())
+        { }
+        for(size_t slot = 0; slot < slots; ++slot)
+        {
+            if(registry.GetState(slot) == LobbyRegistry::State::CLOSED)
+                registry.Reopen(slot);
+
+            auto seats = static_cast<uint16_t>(random() % (MAX_RETURNED + 1));
+            counters[slot].Returned = seats;
+            counters[slot].Taken = 0;
+            registry.ReturnSeats(slot, seats);
+        }
+        registry.Publish();
+
+        std::atomic<bool> stop(false);
+        std::vector<std::thread> threads;
+        for(size_t taker = 0; taker < takers; ++taker)
+        {
+            threads.emplace_back([&]
+                                 {
+                                     while(!stop.load(std::memory_order_acquire))
+                                         if(auto slot = registry.TakeSeat())
+                                             ++counters[*slot].Taken;
+                                 });
+        }
+
+            // the only publisher, calls have to be serialized
+        threads.emplace_back([&]
+                             {
+                                 while(!stop.load(std::memory_order_acquire))
+                                     registry.Publish();
+                             });
+
+            // owns slot states during the round, only forming slots get seats back
+        auto seed = static_cast<uint32_t>(random());
+        std::thread server([&, seed]
+                           {
+                               std::mt19937 local(seed);
+                               for(size_t op = 0; op < SERVER_OPERATIONS; ++op)
+                               {
+                                   auto slot = local() % slots;
+                                   if(registry.GetState(slot) != LobbyRegistry::State::FORMING)
+                                       continue;
+
+                                   auto action = local() % 16;
+                                   if(action == 0)
+                                   {
+                                       registry.Close(slot);
+                                   }
+                                   else if(action == 1)
+                                   {
+                                       registry.Release(slot);
+                                   }
+                                   else
+                                   {
+                                       auto seats = static_cast<uint16_t>(1 + local() % MAX_RETURNED);
+                                       counters[slot].Returned += seats;
+                                       registry.ReturnSeats(slot, seats);
+                                   }
+                               }
+                           });
+
+        server.join();
+        stop.store(true, std::memory_order_release);
+        for(auto& thread : threads)
+            thread.join();
+
+            // seats left in forming lobbies have to be reachable through Publish and TakeSeat
+        while(registry.Publish())
+        {
+            auto slot = registry.TakeSeat();
+            if(!slot)
+                break;
+            ++counters[*slot].Taken;
+        }
+
+        for(size_t slot = 0; slot < slots; ++slot)
+        {
+            auto returned = counters[slot].Returned.load();
+            auto taken = counters[slot].Taken.load();
+            totalTaken += taken;
+
+            if(taken > returned)
+            {
+                ++doubleHanded;
+                std::cerr << "Round " << round << ", slot " << slot << ": " << taken << " seats taken, only "
+                          << returned << " returned" << std::endl;
+            }
+            else if(registry.GetState(slot) == LobbyRegistry::State::FORMING && taken != returned)
+            {
+                ++lost;
+                std::cerr << "Round " << round << ", slot " << slot << ": " << returned - taken
+                          << " returned seats can not be taken" << std::endl;
+            }
+        }
+    }
+
+    std::cout << rounds << " rounds, " << slots << " slots, " << takers << " takers: " << totalTaken
+              << " seats taken, " << doubleHanded << " slots handed out seats twice, "
+              << lost << " slots lost seats" << std::endl;
+
+    return doubleHanded == 0 && lost == 0 ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+//
+//  log_decoder.cpp
+//  labyrinth_server
+//
+
+/*
+ * Turns binary log ring (see toolkit/binary_log.hpp) back into NamedLogger text lines.
+ * Usage: log_decoder <ring file> [dictionary file]
+ */
+
+#include "toolkit/binary_log.hpp"
+#include "toolkit/named_logger.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <map>
+
+using namespace BinaryLogFormat;
+
+
+namespace
+{
+    struct FormatInfo
+    {
+        NamedLogger::Level  Level;
+        std::string         Format;
+    };
+
+    struct Dictionary
+    {
+        std::map<uint16_t, FormatInfo>  Formats;
+        std::map<uint16_t, std::string> Loggers;
+        std::map<uint16_t, std::string> Threads;
+    };
+
+    bool LoadDictionary(const std::string& path, Dictionary& dict)
+    {
+        std::ifstream file(path);
+        if(!file)
+            return false;
+
+        std::string line;
+        while(std::getline(file, line))
+        {
+            std::istringstream iss(line);
+
+            char kind;
+            unsigned id;
+            iss >> kind >> id;
+            iss.get(); // separator
+
+            if(kind == 'F')
+            {
+                int level;
+                std::string location;
+                iss >> level >> location;
+                iss.get();
+
+                FormatInfo info;
+                info.Level = static_cast<NamedLogger::Level>(level);
+                std::getline(iss, info.Format);
+                dict.Formats[id] = info;
+            }
+            else
+            {
+                std::string name;
+                std::getline(iss, name);
+                (kind == 'L' ? dict.Loggers : dict.Threads)[id] = name;
+            }
+        }
+
+        return true;
+    }
+
+        // substitutes {} placeholders with decoded arguments, the ring file may be cut or corrupted,
+        // so every read is bounds checked by FormatArgs
+    std::string DecodeText(const std::string& format, const uint8_t* args, size_t size)
+    {
+        std::ostringstream oss;
+        BinaryLog::FormatArgs(oss, format.c_str(), args, size);
+        return oss.str();
+    }
+}
+
+
+int main(int argc, const char * argv[])
+{
+    if(argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <ring file> [dictionary file]" << std::endl;
+        return 1;
+    }
+
+    std::string ringPath = argv[1];
+    std::string dictPath = argc > 2 ? argv[2] : ringPath + ".dict";
+
+    Dictionary dict;
+    if(!LoadDictionary(dictPath, dict))
+    {
+        std::cerr << "Failed to read dictionary " << dictPath << std::endl;
+        return 1;
+    }
+
+    std::ifstream ringFile(ringPath, std::ios::binary);
+    FileHeader header;
+    if(!ringFile.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+       header.Magic != MAGIC ||
+       header.Version != VERSION)
+    {
+        std::cerr << "Not a binary log: " << ringPath << std::endl;
+        return 1;
+    }
+
+    std::vector<uint8_t> ring(header.Capacity);
+    ringFile.read(reinterpret_cast<char*>(ring.data()), ring.size());
+
+    auto pos = header.Head;
+    while(pos != header.Tail)
+    {
+        RecordHeader record;
+        if(pos + sizeof(uint16_t) > ring.size())
+            break;
+
+        std::memcpy(&record.Size, &ring[pos], sizeof(record.Size));
+        if(record.Size == 0 && pos != 0)
+        {
+            pos = 0;
+            continue;
+        }
+
+        if(record.Size < sizeof(RecordHeader) || pos + record.Size > ring.size())
+        {
+            std::cerr << "Corrupted record at offset " << pos << std::endl;
+            return 1;
+        }
+
+        std::memcpy(&record, &ring[pos], sizeof(RecordHeader));
+
+        auto& format = dict.Formats[record.FormatId];
+        auto time = std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::nanoseconds(header.BaseWallNs + static_cast<int64_t>(record.Ticks))));
+
+        NamedLogger::Format(std::cout,
+                            time,
+                            format.Level,
+                            dict.Threads[record.ThreadId],
+                            dict.Loggers[record.LoggerId],
+                            record.Instance,
+                            DecodeText(format.Format,
+                                       &ring[pos + sizeof(RecordHeader)],
+                                       record.Size - sizeof(RecordHeader)));
+
+        pos += record.Size;
+    }
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+//
+//  login_bench.cpp
+//  labyrinth_server
+//
+
+/*
+ * Login storm against a storage backend (see services/storage_backend.hpp): registers accounts,
+ * then hammers Login from several client threads and reports per-call p50/p99.
+ * Usage: login_bench [storage] [accounts] [logins] [threads] [batch]
+ * storage is a StorageBackend::Create spec: memory (default) or sqlite:<fresh file>.
+ */
+
+#include "services/storage_backend.hpp"
+#include "toolkit/latency_histogram.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    struct Counters
+    {
+        std::atomic<uint64_t>   Success;
+        std::atomic<uint64_t>   Registered;
+    };
+
+        // body(client, call) issues one storage call, calls are spread evenly over clients
+    template<typename Body>
+    void Storm(const char* name, size_t calls, size_t clients, size_t batch, Body body)
+    {
+        LatencyHistogram latency;
+
+        auto started = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for(size_t client = 0; client < clients; ++client)
+        {
+            threads.emplace_back([&, client]
+                                 {
+                                     for(size_t call = client; call < calls; call += clients)
+                                     {
+                                         auto sent = std::chrono::steady_clock::now();
+                                         body(client, call);
+                                         latency.Record(std::chrono::duration_cast<std::chrono::microseconds>(
+                                             std::chrono::steady_clock::now() - sent));
+                                     }
+                                 });
+        }
+        for(auto& thread : threads)
+            thread.join();
+        auto elapsed = std::chrono::steady_clock::now() - started;
+
+        auto seconds = std::chrono::duration_cast<std::chrono::duration<double>>(elapsed).count();
+        std::cout << name << ": " << calls << " calls of " << batch << ", p50 " << latency.Percentile(0.5).count()
+                  << " us, p99 " << latency.Percentile(0.99).count() << " us, "
+                  << static_cast<uint64_t>(calls * batch / seconds) << " queries/s" << std::endl;
+    }
+}
+
+
+int main(int argc, const char * argv[])
+{
+    std::string storage = argc > 1 ? argv[1] : "memory";
+    size_t accounts = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10000;
+    size_t logins = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 200000;
+    size_t clients = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 8;
+    size_t batch = argc > 5 ? std::strtoul(argv[5], nullptr, 10) : 1;
+    clients = std::max<size_t>(clients, 1);
+    batch = std::max<size_t>(batch, 1);
+
+    std::unique_ptr<StorageBackend> backend;
+    try
+    {
+        backend = StorageBackend::Create(storage);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "Failed to open " << storage << ": " << e.what() << std::endl;
+        return 1;
+    }
+
+    auto email = [](size_t account)
+    { return "player" + std::to_string(account) + "@bench"; };
+    auto password = [](size_t account)
+    { return "secret" + std::to_string(account); };
+
+    Counters registered {};
+    Storm("register", (accounts + batch - 1) / batch, clients, batch, [&](size_t, size_t call)
+          {
+              std::vector<DBQuery::RegisterQuery> queries;
+              for(size_t account = call * batch; account < std::min(accounts, (call + 1) * batch); ++account)
+                  queries.push_back({ email(account), password(account) });
+
+              for(auto& result : backend->Register(queries))
+                  registered.Success += result.Success;
+          });
+
+        // every email is taken now, the unique email guarantee must hold under concurrency
+    Counters taken {};
+    Storm("register taken", (accounts + batch - 1) / batch, clients, batch, [&](size_t, size_t call)
+          {
+              std::vector<DBQuery::RegisterQuery> queries;
+              for(size_t account = call * batch; account < std::min(accounts, (call + 1) * batch); ++account)
+                  queries.push_back({ email(account), "other" });
+
+              for(auto& result : backend->Register(queries))
+                  taken.Success += result.Success;
+          });
+
+        // mostly valid logins, some wrong passwords and unknown emails, as a real storm after a restart
+    std::vector<std::mt19937> randoms;
+    for(size_t client = 0; client < clients; ++client)
+        randoms.emplace_back(static_cast<uint32_t>(42 + client));
+
+    Counters logged {};
+    Storm("login", logins, clients, batch, [&](size_t client, size_t)
+          {
+              auto& random = randoms[client];
+
+              std::vector<DBQuery::LoginQuery> queries;
+              for(size_t idx = 0; idx < batch; ++idx)
+              {
+                  auto account = random() % (accounts + accounts / 20 + 1);
+                  queries.push_back({ email(account), random() % 10 ? password(account) : "wrong" });
+              }
+
+              for(auto& result : backend->Login(queries))
+              {
+                  logged.Success += result.Success;
+                  logged.Registered += result.Registered;
+              }
+          });
+
+    std::cout << "storage: " << backend->Name() << ", registered " << registered.Success.load() << " of " << accounts
+              << ", taken emails registered again: " << taken.Success.load()
+              << ", logins: " << logged.Success.load() << " successful, "
+              << logged.Registered.load() << " found registered" << std::endl;
+
+    return taken.Success.load() == 0 ? 0 : 1;
+}
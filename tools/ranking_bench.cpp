@@ -0,0 +1,77 @@
+//
+//  ranking_bench.cpp
+//  labyrinth_server
+//
+
+/*
+ * Measures Ranking (see services/ranking.hpp) updates and lookups.
+ * Usage: ranking_bench [players] [operations]
+ */
+
+#include "services/ranking.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    template<typename Body>
+    void Measure(const char* name, size_t operations, Body body)
+    {
+        auto started = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < operations; ++i)
+            body(i);
+        auto elapsed = std::chrono::steady_clock::now() - started;
+
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        std::cout << name << ": " << operations << " ops, " << (ns / static_cast<double>(operations)) << " ns/op" << std::endl;
+    }
+}
+
+
+int main(int argc, const char * argv[])
+{
+    size_t players = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    size_t operations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000000;
+
+    std::vector<std::string> names;
+    for(size_t i = 0; i < players; ++i)
+        names.push_back("player" + std::to_string(i));
+
+    std::mt19937 random(42);
+    std::vector<size_t> picks(operations);
+    for(auto& pick : picks)
+        pick = random() % players;
+
+    Ranking ranking;
+    uint64_t checksum = 0;
+
+    Measure("initial add", players, [&](size_t i)
+            {
+                checksum += ranking.Add(names[i], false, i % 3, 1).Points;
+            });
+    Measure("add match result", operations, [&](size_t i)
+            {
+                checksum += ranking.Add(names[picks[i]], picks[i] % 4 == 0, picks[i] % 5, 1).Points;
+            });
+    Measure("rank lookup", operations, [&](size_t i)
+            {
+                checksum += ranking.Rank(names[picks[i]]);
+            });
+        // a different entry each time, a constant read would be hoisted out of the loop
+    Measure("top read", operations, [&](size_t i)
+            {
+                auto& top = ranking.Top();
+                checksum += top[i % top.size()].Points;
+            });
+
+    std::cout << "players: " << ranking.Size() << ", best: " << ranking.Top().front().Name
+              << " (" << ranking.Top().front().Points << "), checksum: " << checksum << std::endl;
+
+    return 0;
+}
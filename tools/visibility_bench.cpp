@@ -0,0 +1,104 @@
+//
+//  visibility_bench.cpp
+//  labyrinth_server
+//
+
+/*
+ * Measures VisibilityMap (see gameserver/gamelogic/visibility.hpp) on generated labyrinths:
+ * recalculation of a viewer that changed tile, an update on the same tile and an IsVisible query.
+ * Usage: visibility_bench [map size] [room size] [radius] [operations]
+ * Without map size both the current (3) and a large (10) labyrinth are measured.
+ */
+
+#include "gameserver/gamelogic/gamemap.hpp"
+#include "gameserver/gamelogic/visibility.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+namespace
+{
+    template<typename Body>
+    void Measure(const char* name, size_t operations, Body body)
+    {
+        auto started = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < operations; ++i)
+            body(i);
+        auto elapsed = std::chrono::steady_clock::now() - started;
+
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        std::cout << "  " << name << ": " << operations << " ops, " << (ns / static_cast<double>(operations)) << " ns/op" << std::endl;
+    }
+
+    void Run(uint16_t mapSize, uint16_t roomSize, uint16_t radius, size_t operations)
+    {
+        GameMapGenerator::Configuration conf;
+        conf.MapSize = mapSize;
+        conf.RoomSize = roomSize;
+        conf.Seed = 42;
+        auto map = GameMapGenerator::GenerateMap(conf);
+
+        auto size = static_cast<uint16_t>(map.size());
+        VisibilityMap visibility(size, size);
+        std::vector<Point<>> open;
+        for(uint16_t x = 0; x < size; ++x)
+        {
+            for(uint16_t y = 0; y < size; ++y)
+            {
+                auto wall = map[x][y] != GameMapGenerator::MapBlockType::NOBLOCK;
+                visibility.SetWall(x, y, wall);
+                if(!wall)
+                    open.emplace_back(x, y);
+            }
+        }
+
+        std::mt19937 random(42);
+        std::vector<Point<>> positions(operations);
+        std::vector<Point<>> targets(operations);
+        for(size_t i = 0; i < operations; ++i)
+        {
+            positions[i] = open[random() % open.size()];
+            targets[i] = open[random() % open.size()];
+        }
+
+        std::cout << size << "x" << size << " tiles, " << open.size() << " open, radius " << radius << std::endl;
+
+        size_t visible = 0;
+
+            // consecutive positions differ, so every update is a full recalculation
+        Measure("viewer moved", operations, [&](size_t i)
+                {
+                    visibility.UpdateViewer(1, positions[i], radius);
+                });
+        Measure("viewer stayed", operations, [&](size_t)
+                {
+                    visibility.UpdateViewer(1, positions.back(), radius);
+                });
+        Measure("is visible", operations, [&](size_t i)
+                {
+                    visible += visibility.IsVisible(1, targets[i]);
+                });
+
+        std::cout << "  visible targets: " << visible << std::endl;
+    }
+}
+
+
+int main(int argc, const char * argv[])
+{
+    std::vector<uint16_t> mapSizes { 3, 10 };
+    if(argc > 1)
+        mapSizes = { static_cast<uint16_t>(std::strtoul(argv[1], nullptr, 10)) };
+    auto roomSize = static_cast<uint16_t>(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10);
+    auto radius = static_cast<uint16_t>(argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 10);
+    size_t operations = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 200000;
+
+    for(auto mapSize : mapSizes)
+        Run(mapSize, roomSize, radius, operations);
+
+    return 0;
+}